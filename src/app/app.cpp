@@ -3,6 +3,8 @@
 #include "engine/graphics/renderer.h"
 #include "engine/graphics/renderer2d.h"
 #include "engine/graphics/camera.h"
+#include "engine/graphics/frame_graph.h"
+#include "engine/graphics/dynamic_resolution.h"
 #include "editor/editor.h"
 
 #include <glm/glm.hpp>
@@ -25,11 +27,69 @@
 struct App {
   Camera camera;
   Camera* current_cam;
+
+  // A copy of the current camera as of the last latch. 
+  // The render thread only ever looks through this one.
+  Camera render_cam;
+
+  FrameGraph frame_graph;
+  u32 scene_pass, scene_color;
 };
 
 static App s_app;
 /////////////////////////////////////////////////////////////////////////////////
 
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void scene_pass(FrameGraph* graph, void* user_data) {
+  renderer_begin(&s_app.render_cam);
+  renderer_end();
+}
+
+static void upscale_pass(FrameGraph* graph, void* user_data) {
+  dynamic_resolution_upscale(frame_graph_get_texture(graph, s_app.scene_color), frame_graph_get_texture_size(graph, s_app.scene_color));
+}
+
+static void ui_pass(FrameGraph* graph, void* user_data) {
+  renderer2d_begin();
+  renderer2d_end();
+}
+
+static void editor_pass(FrameGraph* graph, void* user_data) {
+  editor_begin();
+  editor_end();
+}
+
+static void build_frame_graph() {
+  FrameGraph* graph = &s_app.frame_graph;
+  frame_graph_create(graph);
+
+  // The scene gets drawn into a part of its own target (see 'dynamic_resolution.h') and then 
+  // scaled up to the window. Everything after that is drawn at the native resolution.
+  FrameGraphTextureDesc color_desc = {};
+  FrameGraphTextureDesc depth_desc = {.format = FRAME_GRAPH_FORMAT_DEPTH24_STENCIL8};
+
+  s_app.scene_color = frame_graph_add_texture(graph, "scene_color", color_desc);
+  u32 scene_depth   = frame_graph_add_texture(graph, "scene_depth", depth_desc);
+
+  s_app.scene_pass = frame_graph_add_pass(graph, "scene", scene_pass);
+  frame_graph_pass_write(graph, s_app.scene_pass, s_app.scene_color);
+  frame_graph_pass_write(graph, s_app.scene_pass, scene_depth);
+  frame_graph_pass_clear(graph, s_app.scene_pass, glm::vec4(0.1f, 0.1f, 0.1f, 1.0f));
+
+  u32 upscale = frame_graph_add_pass(graph, "upscale", upscale_pass);
+  frame_graph_pass_read(graph, upscale, s_app.scene_color);
+  frame_graph_pass_write(graph, upscale, FRAME_GRAPH_BACKBUFFER);
+  frame_graph_pass_clear(graph, upscale, glm::vec4(0.0f));
+
+  u32 ui = frame_graph_add_pass(graph, "ui", ui_pass);
+  frame_graph_pass_write(graph, ui, FRAME_GRAPH_BACKBUFFER);
+
+  u32 editor = frame_graph_add_pass(graph, "editor", editor_pass);
+  frame_graph_pass_write(graph, editor, FRAME_GRAPH_BACKBUFFER);
+}
+/////////////////////////////////////////////////////////////////////////////////
+
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
 bool app_init(void* user_data) {
@@ -44,11 +104,18 @@ bool app_init(void* user_data) {
 
   // This can be switched between the game camera and editor camera
   s_app.current_cam = &s_app.camera;
+  s_app.render_cam  = s_app.camera;
+
+  // Frame graph init
+  build_frame_graph();
+  dynamic_resolution_init(DynamicResolutionDesc{});
 
   return true;
 }
 
 void app_shutdown(void* user_data) {
+  dynamic_resolution_shutdown();
+  frame_graph_destroy(&s_app.frame_graph);
   editor_shutdown();
 }
 
@@ -57,17 +124,17 @@ void app_update(void* user_data) {
   camera_move(s_app.current_cam);
 }
 
+void app_latch(void* user_data) {
+  s_app.render_cam = *s_app.current_cam;
+}
+
 void app_render(void* user_data) {
-  renderer_clear(glm::vec4(0.1f, 0.1f, 0.1f, 1.0f));
-  editor_begin();
+  dynamic_resolution_begin();
 
-  renderer_begin(s_app.current_cam);
-  renderer_end();
-  
-  renderer2d_begin();
-  renderer2d_end();
- 
-  editor_end();
+  frame_graph_pass_set_viewport_scale(&s_app.frame_graph, s_app.scene_pass, dynamic_resolution_get_scale());
+  frame_graph_execute(&s_app.frame_graph);
+
+  dynamic_resolution_end();
   renderer_present();
 }
 /////////////////////////////////////////////////////////////////////////////////
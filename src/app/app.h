@@ -6,4 +6,5 @@ bool app_init(void* user_data);
 void app_shutdown(void* user_data);
 void app_update(void* user_data);
 void app_render(void* user_data);
+void app_latch(void* user_data);
 /////////////////////////////////////////////////////////////////////////////////
@@ -4,7 +4,7 @@
 #include "physics/physics_body.h"
 #include "physics/collider.h"
 #include "physics/physics_world.h"
-#include "resources/mesh.h"
+#include "resources/primitives.h"
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
@@ -14,7 +14,7 @@ Object* object_create(const glm::vec3& scale, const PhysicsBodyDesc desc, const
   obj->collider = BoxCollider{.half_size = scale / 2.0f};
   physics_body_add_collider(obj->body, COLLIDER_BOX, &obj->collider);
 
-  obj->mesh = mesh_create();
+  obj->primitive = PRIMITIVE_CUBE;
   obj->is_active = active;
 
   return obj;
@@ -26,7 +26,6 @@ void object_destroy(Object* obj) {
     return;
   }
 
-  mesh_destroy(obj->mesh);
   delete obj;
 }
 
@@ -37,6 +36,6 @@ void object_render(Object* obj) {
     return;
   }
 
-  render_mesh(obj->body->transform, obj->mesh, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
+  render_primitive(obj->body->transform, obj->primitive, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
 }
 /////////////////////////////////////////////////////////////////////////////////
@@ -3,7 +3,7 @@
 #include "physics/physics_world.h"
 #include "physics/physics_body.h"
 #include "physics/collider.h"
-#include "resources/mesh.h"
+#include "resources/primitives.h"
 
 #include <glm/vec3.hpp>
 
@@ -23,7 +23,7 @@ Player* player_create(const glm::vec3& start_pos) {
   });
   physics_body_add_collider(player->body, COLLIDER_BOX, &player->collider); 
 
-  player->mesh = mesh_create();
+  player->primitive = PRIMITIVE_CUBE;
   player->is_active = true;
 
   return player;
@@ -34,7 +34,6 @@ void player_destroy(Player* player) {
     return;
   }
 
-  mesh_destroy(player->mesh);
   delete player;
 }
 
@@ -49,6 +48,6 @@ void player_render(Player* player) {
     return;
   }
 
-  render_mesh(player->body->transform, player->mesh, glm::vec4(1.0f));
+  render_primitive(player->body->transform, player->primitive, glm::vec4(1.0f));
 }
 /////////////////////////////////////////////////////////////////////////////////
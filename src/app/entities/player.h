@@ -2,7 +2,7 @@
 
 #include "physics/physics_body.h"
 #include "physics/collider.h"
-#include "resources/mesh.h"
+#include "resources/primitives.h"
 
 #include <glm/vec3.hpp>
 
@@ -18,7 +18,7 @@
 struct Player {
   PhysicsBody* body;
   BoxCollider collider; 
-  Mesh* mesh;
+  PrimitiveType primitive; // Shared with every other entity using the same primitive
 
   bool is_active;
 };
@@ -12,9 +12,11 @@ int main() {
     .shutdown_func = app_shutdown,
     .update_func = app_update, 
     .render_func = app_render, 
+    .latch_func = app_latch,
 
     .user_data = nullptr, 
     .has_editor = false,
+    .has_render_thread = true,
   };
 
   engine_init(desc);
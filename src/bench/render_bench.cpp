@@ -0,0 +1,365 @@
+#include "engine/core/window.h"
+#include "engine/core/job_system.h"
+#include "engine/graphics/camera.h"
+#include "engine/graphics/gl_state.h"
+#include "engine/graphics/renderer.h"
+#include "engine/graphics/renderer2d.h"
+#include "engine/graphics/occlusion.h"
+#include "engine/graphics/lighting.h"
+#include "engine/resources/primitives.h"
+#include "engine/resources/resource_manager.h"
+#include "engine/math/transform.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define BENCH_WIDTH          1280
+#define BENCH_HEIGHT         720
+#define BENCH_DEFAULT_COUNT  1000
+#define BENCH_DEFAULT_FRAMES 300
+#define BENCH_WARMUP_FRAMES  10 // Not measured, so shader compiles and buffer growth do not skew the results
+#define BENCH_LIGHTS_COUNT   1000
+/////////////////////////////////////////////////////////////////////////////////
+
+// Callbacks
+/////////////////////////////////////////////////////////////////////////////////
+typedef void (*BenchRenderFunc)(const u32 count);
+/////////////////////////////////////////////////////////////////////////////////
+
+// BenchScene
+/////////////////////////////////////////////////////////////////////////////////
+struct BenchScene {
+  const char* name;
+  BenchRenderFunc render_func;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// BenchResult
+/////////////////////////////////////////////////////////////////////////////////
+struct BenchResult {
+  f64 avg_submit, min_submit, max_submit; // In milliseconds
+
+  u32 draw_calls, draws;
+  u32 state_issued, state_skipped;
+
+  f64 avg_assign; // The time it took to assign the lights to the clusters, in milliseconds
+  u32 lights_count, light_indices_count;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Bench
+/////////////////////////////////////////////////////////////////////////////////
+struct Bench {
+  Camera camera;
+  Font* font = nullptr;
+
+  std::vector<Transform> transforms;
+  std::vector<glm::vec4> colors;
+  std::vector<PointLight> lights;
+};
+
+static Bench s_bench;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void setup_scene(const u32 count) {
+  // The meshes fill up a grid in front of the camera
+  u32 side = (u32)glm::ceil(glm::sqrt((f32)count));
+
+  s_bench.transforms.resize(count);
+  s_bench.colors.resize(count);
+
+  for(u32 i = 0; i < count; i++) {
+    glm::vec3 position = glm::vec3((i % side) - (side * 0.5f), (i / side) - (side * 0.5f), -(f32)side);
+    transform_create(&s_bench.transforms[i], position * 1.5f, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.5f));
+
+    s_bench.colors[i] = glm::vec4((i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f, 1.0f);
+  }
+
+  // The lights are scattered through the same volume as the meshes, so they land in different clusters
+  s_bench.lights.resize(BENCH_LIGHTS_COUNT);
+  for(u32 i = 0; i < BENCH_LIGHTS_COUNT; i++) {
+    glm::vec3 position = glm::vec3(((i * 37) % 1000) / 1000.0f - 0.5f, ((i * 53) % 1000) / 1000.0f - 0.5f, -(f32)((i * 71) % 1000) / 1000.0f);
+
+    s_bench.lights[i].position  = position * (side * 1.5f);
+    s_bench.lights[i].radius    = 2.0f + (i % 4);
+    s_bench.lights[i].color     = glm::vec3(s_bench.colors[i % count]);
+    s_bench.lights[i].intensity = 1.0f;
+  }
+
+  s_bench.camera          = camera_create(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+  s_bench.camera.can_move = false;
+  camera_update(&s_bench.camera);
+}
+
+static void render_meshes(const u32 count) {
+  Mesh* meshes[2] = {primitives_get(PRIMITIVE_CUBE), primitives_get(PRIMITIVE_UV_SPHERE)};
+
+  renderer_begin(&s_bench.camera);
+  for(u32 i = 0; i < count; i++) {
+    render_mesh(s_bench.transforms[i], meshes[i % 2], s_bench.colors[i]);
+  }
+  renderer_end();
+}
+
+static void render_lit_meshes(const u32 count) {
+  Mesh* meshes[2] = {primitives_get(PRIMITIVE_CUBE), primitives_get(PRIMITIVE_UV_SPHERE)};
+
+  renderer_begin(&s_bench.camera);
+  for(auto& light : s_bench.lights) {
+    render_point_light(light);
+  }
+
+  for(u32 i = 0; i < count; i++) {
+    render_mesh(s_bench.transforms[i], meshes[i % 2], s_bench.colors[i]);
+  }
+  renderer_end();
+}
+
+static void record_occluded_mesh(const u32 index, void* user_data) {
+  Mesh* meshes[2] = {primitives_get(PRIMITIVE_CUBE), primitives_get(PRIMITIVE_UV_SPHERE)};
+  render_mesh(s_bench.transforms[index], meshes[index % 2], s_bench.colors[index]);
+}
+
+static void render_occluded_meshes(const u32 count) {
+  // A wall right in front of the camera that hides the middle of the grid
+  Transform wall;
+  transform_create(&wall, glm::vec3(0.0f, 0.0f, -3.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 2.0f, 0.5f));
+
+  renderer_begin(&s_bench.camera);
+  render_occluder(wall, primitives_get(PRIMITIVE_CUBE));
+
+  // Before the jobs, so they do not all wait on the first one to rasterize the occluders
+  renderer_rasterize_occluders();
+  job_system_dispatch(count, record_occluded_mesh, nullptr);
+
+  renderer_end();
+}
+
+static void render_sprites(const u32 count) {
+  renderer2d_begin();
+  for(u32 i = 0; i < count; i++) {
+    glm::vec2 position = glm::vec2((i * 37) % BENCH_WIDTH, (i * 53) % BENCH_HEIGHT);
+    render_quad(position, glm::vec2(16.0f), s_bench.colors[i]);
+  }
+  renderer2d_end();
+}
+
+static void render_instanced_sprites(const u32 count) {
+  renderer2d_begin();
+  for(u32 i = 0; i < count; i++) {
+    glm::vec2 position = glm::vec2((i * 37) % BENCH_WIDTH, (i * 53) % BENCH_HEIGHT);
+    render_sprite(position, glm::vec2(16.0f), 0.0f, s_bench.colors[i]);
+  }
+  renderer2d_end();
+}
+
+static void render_texts(const u32 count) {
+  renderer2d_begin();
+  for(u32 i = 0; i < count; i++) {
+    glm::vec2 position = glm::vec2((i * 37) % BENCH_WIDTH, (i * 53) % BENCH_HEIGHT);
+    render_text(s_bench.font, 16.0f, "Gravel " + std::to_string(i), position, s_bench.colors[i]);
+  }
+  renderer2d_end();
+}
+
+static bool check_occlusion() {
+  Mesh* cube = primitives_get(PRIMITIVE_CUBE);
+
+  // A wall 5 units in front of the camera
+  Transform wall;
+  transform_create(&wall, glm::vec3(0.0f, 0.0f, -5.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 2.0f, 1.0f));
+
+  occlusion_begin(s_bench.camera.view_projection);
+  occlusion_add_occluder(wall.transform, cube);
+  occlusion_rasterize();
+
+  struct OcclusionCase {
+    const char* name;
+    glm::vec3 position;
+    bool is_visible;
+  };
+
+  OcclusionCase cases[] = {
+    {"behind the wall", glm::vec3(0.0f, 0.0f, -20.0f), false},
+    {"beside the wall", glm::vec3(8.0f, 0.0f, -20.0f), true},
+    {"in front of the wall", glm::vec3(0.0f, 0.0f, -3.0f), true},
+    {"partly behind the wall", glm::vec3(2.2f, 0.0f, -10.0f), true},
+  };
+
+  bool has_passed = true;
+  for(auto& test : cases) {
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), test.position);
+
+    if(occlusion_is_visible(cube->min, cube->max, model) != test.is_visible) {
+      fprintf(stderr, "[ERROR]: Occlusion check failed for the box %s\n", test.name);
+      has_passed = false;
+    }
+  }
+
+  // The middle of the depth buffer is the wall, and the corners are empty
+  u32 width, height;
+  const f32* depth = occlusion_get_depth(0, false, &width, &height);
+  if(depth[((height / 2) * width) + (width / 2)] >= 1.0f || depth[0] < 1.0f) {
+    fprintf(stderr, "[ERROR]: Occlusion check failed for the depth buffer\n");
+    has_passed = false;
+  }
+
+  // The coarsest level still keeps the farthest depth of everything under it
+  u32 level = 0;
+  while(occlusion_get_depth(level + 1, true, &width, &height)) {
+    level++;
+  }
+
+  depth = occlusion_get_depth(level, true, &width, &height);
+  if(depth[0] < 1.0f) {
+    fprintf(stderr, "[ERROR]: Occlusion check failed for the depth pyramid\n");
+    has_passed = false;
+  }
+
+  occlusion_begin(s_bench.camera.view_projection);
+  return has_passed;
+}
+
+static BenchResult run_scene(const BenchScene& scene, const u32 count, const u32 frames) {
+  BenchResult result = {};
+  result.min_submit  = 1e9;
+
+  for(u32 i = 0; i < (frames + BENCH_WARMUP_FRAMES); i++) {
+    renderer_clear(glm::vec4(0.1f, 0.1f, 0.1f, 1.0f));
+
+    auto start = std::chrono::steady_clock::now();
+    scene.render_func(count);
+    f64 submit = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    renderer_present();
+
+    // Wait for the GPU so its work does not spill into the next frame's submit time
+    glFinish();
+
+    if(i < BENCH_WARMUP_FRAMES) {
+      continue;
+    }
+
+    result.avg_submit += submit;
+    result.min_submit  = std::min(result.min_submit, submit);
+    result.max_submit  = std::max(result.max_submit, submit);
+
+    // Every frame submits the same scene, so the counters of the last one are enough
+    const GLStateStats& stats = gl_state_get_stats();
+    result.draw_calls    = stats.draw_calls;
+    result.draws         = stats.draws;
+    result.state_issued  = stats.total_issued;
+    result.state_skipped = stats.total_skipped;
+
+    // Only means anything for the scenes that go through 'renderer_end'
+    LightingStats lighting     = lighting_get_stats();
+    result.avg_assign         += lighting.assign_time;
+    result.lights_count        = lighting.lights_count;
+    result.light_indices_count = lighting.indices_count;
+  }
+
+  result.avg_submit /= frames;
+  result.avg_assign /= frames;
+  return result;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Main
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Renders scripted scenes offscreen for a fixed number of frames and reports the CPU
+ * time it took to submit each frame, along with the draw calls and state changes.
+ * The lights scene also reports how long the lights took to get assigned to the clusters.
+ *
+ * Usage: render_bench [count] [frames] [font path] [model path]
+ * The text scene is skipped if no font is given (or an empty one). A model only gets loaded to 
+ * report how much the vertex cache optimization helped each of its meshes.
+ */
+int main(int argc, char** argv) {
+  u32 count  = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  u32 frames = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_FRAMES;
+  frames     = std::max(frames, 1u);
+
+  if(!window_create(BENCH_WIDTH, BENCH_HEIGHT, "render_bench", true)) {
+    fprintf(stderr, "[ERROR]: Failed to create a headless window\n");
+    return -1;
+  }
+
+  job_system_init();
+  resources_init("");
+
+  if(!renderer_create() || !renderer2d_create()) {
+    fprintf(stderr, "[ERROR]: Failed to create the renderers\n");
+    return -1;
+  }
+
+  if(argc > 3 && argv[3][0] != '\0') {
+    s_bench.font = resources_add_font(argv[3], "bench_font");
+  }
+
+  if(argc > 4) {
+    Model* model = resources_add_model("bench_model", argv[4]);
+    for(u32 i = 0; model && i < model->meshes.size(); i++) {
+      printf("model mesh %u: %zu triangles, ACMR %.3f -> %.3f\n", i, model->meshes[i]->indices.size() / 3, model->acmrs_before[i], model->acmrs_after[i]);
+    }
+  }
+
+  setup_scene(count);
+
+  // The occlusion culler has to actually hide things for its scene to mean anything
+  if(!check_occlusion()) {
+    return -1;
+  }
+  printf("occlusion check: passed\n");
+
+  BenchScene scenes[] = {
+    {"meshes", render_meshes},
+    {"occluded", render_occluded_meshes},
+    {"lights", render_lit_meshes},
+    {"sprites", render_sprites},
+    {"instanced", render_instanced_sprites},
+    {"text", render_texts},
+  };
+
+  printf("render_bench: %u of each, %u frames, %d threads, %s\n", count, frames, job_system_get_threads_count(), glGetString(GL_RENDERER));
+  printf("%-9s %10s %10s %10s %8s %8s %10s %10s\n", "scene", "avg ms", "min ms", "max ms", "calls", "draws", "states", "skipped");
+
+  for(auto& scene : scenes) {
+    if(scene.render_func == render_texts && !s_bench.font) {
+      printf("%-9s (skipped, no font given)\n", scene.name);
+      continue;
+    }
+
+    BenchResult result = run_scene(scene, count, frames);
+    printf("%-9s %10.3f %10.3f %10.3f %8u %8u %10u %10u\n",
+           scene.name,
+           result.avg_submit, result.min_submit, result.max_submit,
+           result.draw_calls, result.draws,
+           result.state_issued, result.state_skipped);
+
+    if(scene.render_func == render_lit_meshes) {
+      printf("%-9s %u lights, %u light indices, assign avg %.3f ms\n", "", result.lights_count, result.light_indices_count, result.avg_assign);
+    }
+  }
+
+  renderer2d_destroy();
+  renderer_destroy();
+
+  resources_shutdown();
+  job_system_shutdown();
+  window_destroy();
+
+  return 0;
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,7 @@ typedef bool (*app_init_func)(void* user_data);
 typedef void (*app_shutdown_func)(void* user_data);
 typedef void (*app_update_func)(void* user_data);
 typedef void (*app_render_func)(void* user_data);
+typedef void (*app_latch_func)(void* user_data);
 /////////////////////////////////////////////////////////////////////////////////
 
 // AppDesc
@@ -23,7 +24,21 @@ struct AppDesc {
   app_update_func update_func;
   app_render_func render_func;
 
+  // Only used with 'has_render_thread'. Gets called on the main thread while the render 
+  // thread is idle, to copy whatever the next frame needs out of the simulation.
+  app_latch_func latch_func = nullptr;
+
   void* user_data = nullptr;
   bool has_editor = false;
+
+  // Store the vertices of both renderers in their compressed layouts. 
+  // Flip this to compare the visual output against the full layouts.
+  bool packed_vertices = false;
+
+  // Render on a thread of its own, one frame behind the main thread. The render function 
+  // then runs on the render thread, so it must only read the data copied by 'latch_func'.
+  // NOTE: Once 'init_func' returns, only the render function can touch OpenGL (which includes 
+  // creating any resources). Not supported together with the editor.
+  bool has_render_thread = false;
 };
 /////////////////////////////////////////////////////////////////////////////////
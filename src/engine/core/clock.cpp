@@ -2,12 +2,19 @@
 #include "defines.h"
 #include "core/window.h"
 
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define FRAME_TIME_SMOOTHING 0.1  // How much of the newest delta time goes into the smoothed frame time
+#define FRAME_TIME_HITCH     0.25 // Slower frames (loading, a dragged window) say nothing about the usual frame time
+/////////////////////////////////////////////////////////////////////////////////
+
 // GClock
 /////////////////////////////////////////////////////////////////////////////////
 struct GClock {
   i32 frame_count = 0;
 
   f64 last_frame, delta_time; 
+  f64 frame_time = 0.0;
   f64 fps, prev_time, current_time; 
 };
 
@@ -23,6 +30,14 @@ void gclock_update() {
   clock.last_frame = window_get_time();
   //////////////////////////////////////////////////
   
+  // Calculate the smoothed frame time
+  //////////////////////////////////////////////////
+  if(clock.delta_time < FRAME_TIME_HITCH) {
+    clock.frame_time = (clock.frame_time <= 0.0) ? clock.delta_time : 
+                       clock.frame_time + (clock.delta_time - clock.frame_time) * FRAME_TIME_SMOOTHING;
+  }
+  //////////////////////////////////////////////////
+  
   // Calculate FPS
   //////////////////////////////////////////////////
   clock.frame_count++;
@@ -44,4 +59,8 @@ f64 gclock_delta_time() {
 f64 gclock_fps() {
   return clock.fps;
 }
+
+f64 gclock_frame_time() {
+  return clock.frame_time;
+}
 /////////////////////////////////////////////////////////////////////////////////
@@ -7,4 +7,7 @@
 void gclock_update();
 f64 gclock_delta_time();
 f64 gclock_fps();
+
+// The delta time smoothed over the last few frames, so a single slow frame does not throw it off
+f64 gclock_frame_time();
 /////////////////////////////////////////////////////////////////////////////////
@@ -5,6 +5,8 @@
 #include "core/window.h"
 #include "core/input.h"
 #include "core/event.h"
+#include "core/job_system.h"
+#include "core/render_thread.h"
 
 #include "graphics/renderer.h"
 #include "graphics/renderer2d.h"
@@ -40,17 +42,20 @@ void engine_init(const AppDesc& desc) {
   // Input init
   input_init();
 
+  // Job system init
+  job_system_init();
+
   // Resource manager init 
   resources_init("assets/");
 
   // Renderer 3D init
-  if(!renderer_create()) {
+  if(!renderer_create(desc.packed_vertices)) {
     printf("[ERROR]: Renderer failed to be created\n");
     return;
   }
 
   // Renderer 2D init
-  if(!renderer2d_create()) {
+  if(!renderer2d_create(desc.packed_vertices)) {
     printf("[ERROR]: Renderer2D failed to be created\n");
     return;
   }
@@ -72,9 +77,18 @@ void engine_init(const AppDesc& desc) {
     fprintf(stderr, "[ERROR]: Could not initialize app\n");
     return;
   }
+
+  // Render thread init
+  // NOTE: The editor draws with ImGui, which reads the input from the main thread
+  if(desc.has_render_thread && !desc.has_editor) {
+    render_thread_start(desc.render_func, desc.user_data);
+  }
 }
 
 void engine_shutdown(AppDesc& desc) {
+  // The context has to come back to the main thread before anything gets destroyed
+  render_thread_stop();
+
   desc.shutdown_func(desc.user_data); 
 
   physics_world_destroy();
@@ -85,6 +99,7 @@ void engine_shutdown(AppDesc& desc) {
   renderer_destroy();
   
   resources_shutdown();
+  job_system_shutdown();
   window_destroy();
 }
 
@@ -101,7 +116,19 @@ void engine_run(AppDesc& desc) {
     
     input_update();
    
-    desc.render_func(desc.user_data);
+    if(render_thread_is_running()) {
+      // Only latch once the render thread is done with the last frame. 
+      // The next frame then gets rendered while the main thread moves on.
+      render_thread_wait();
+      
+      if(desc.latch_func) {
+        desc.latch_func(desc.user_data);
+      }
+      render_thread_kick();
+    }
+    else {
+      desc.render_func(desc.user_data);
+    }
 
     window_poll_events();
   }
@@ -0,0 +1,195 @@
+#include "job_system.h"
+#include "defines.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// JobBatch
+/////////////////////////////////////////////////////////////////////////////////
+// One dispatch. Every thread works off its own copy, taken under the lock.
+struct JobBatch {
+  JobFunc func    = nullptr;
+  void* user_data = nullptr;
+  u32 count       = 0;
+  u32 generation  = 0; 
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// JobSystem
+/////////////////////////////////////////////////////////////////////////////////
+struct JobSystem {
+  std::vector<std::thread> workers;
+  
+  std::mutex mutex;
+  std::condition_variable wake_cond, done_cond;
+
+  // Only one thread (the main or the render thread) can dispatch at a time
+  std::mutex dispatch_mutex;
+
+  // The current dispatch. The generation gets bumped on every dispatch so sleeping workers know there is new work.
+  JobBatch batch;
+  u32 busy_workers = 0;
+
+  // The generation of the current dispatch in the high 32 bits and its next index in the low ones. 
+  // A worker that is late for a dispatch can then never take an index of the one after it.
+  std::atomic<u64> cursor;
+
+  bool is_running = false;
+};
+
+static JobSystem s_jobs;
+static thread_local bool s_is_worker = false;
+static thread_local u32 s_thread_index = 0;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static bool claim_index(const JobBatch& batch, u32* out_index) {
+  u64 cursor = s_jobs.cursor.load();
+
+  while(true) {
+    u32 index = (u32)cursor;
+    if((u32)(cursor >> 32) != batch.generation || index >= batch.count) {
+      return false;
+    }
+
+    if(s_jobs.cursor.compare_exchange_weak(cursor, cursor + 1)) {
+      *out_index = index;
+      return true;
+    }
+  }
+}
+
+static void run_jobs(const JobBatch& batch) {
+  u32 index;
+  while(claim_index(batch, &index)) {
+    batch.func(index, batch.user_data);
+  }
+}
+
+static void worker_loop(const u32 thread_index) {
+  s_is_worker    = true;
+  s_thread_index = thread_index;
+  u32 last_generation = 0;
+
+  while(true) {
+    JobBatch batch;
+    {
+      std::unique_lock<std::mutex> lock(s_jobs.mutex);
+      s_jobs.wake_cond.wait(lock, [&]() {
+        return !s_jobs.is_running || s_jobs.batch.generation != last_generation;
+      });
+
+      if(!s_jobs.is_running) {
+        return;
+      }
+
+      batch           = s_jobs.batch;
+      last_generation = batch.generation;
+      s_jobs.busy_workers++;
+    }
+
+    run_jobs(batch);
+
+    {
+      std::lock_guard<std::mutex> lock(s_jobs.mutex);
+      s_jobs.busy_workers--;
+    }
+    s_jobs.done_cond.notify_one();
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool job_system_init(const u32 threads_count) {
+  if(s_jobs.is_running) {
+    return true;
+  }
+
+  u32 count = threads_count;
+  if(count == 0) {
+    u32 cores = std::thread::hardware_concurrency();
+    count     = (cores > 1) ? (cores - 1) : 0;
+  }
+
+  s_jobs.is_running = true;
+  s_jobs.cursor     = 0;
+
+  for(u32 i = 0; i < count; i++) {
+    s_jobs.workers.emplace_back(worker_loop, i + 1);
+  }
+
+  return true;
+}
+
+void job_system_shutdown() {
+  if(!s_jobs.is_running) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(s_jobs.mutex);
+    s_jobs.is_running = false;
+  }
+  s_jobs.wake_cond.notify_all();
+
+  for(auto& worker : s_jobs.workers) {
+    worker.join();
+  }
+  s_jobs.workers.clear();
+}
+
+void job_system_dispatch(const u32 count, JobFunc func, void* user_data) {
+  if(count == 0) {
+    return;
+  }
+
+  // Not worth waking anyone up for
+  if(s_jobs.workers.empty() || s_is_worker || count == 1) {
+    for(u32 i = 0; i < count; i++) {
+      func(i, user_data);
+    }
+
+    return;
+  }
+
+  std::lock_guard<std::mutex> dispatch_lock(s_jobs.dispatch_mutex);
+
+  JobBatch batch;
+  {
+    std::lock_guard<std::mutex> lock(s_jobs.mutex);
+    
+    s_jobs.batch.func      = func;
+    s_jobs.batch.user_data = user_data;
+    s_jobs.batch.count     = count;
+    s_jobs.batch.generation++;
+    s_jobs.cursor = (u64)s_jobs.batch.generation << 32;
+
+    batch = s_jobs.batch;
+  }
+  s_jobs.wake_cond.notify_all();
+
+  // The calling thread helps out instead of just waiting around
+  s_is_worker = true;
+  run_jobs(batch);
+  s_is_worker = false;
+
+  // Wait for the workers that are still finishing up their last job
+  std::unique_lock<std::mutex> lock(s_jobs.mutex);
+  s_jobs.done_cond.wait(lock, []() {
+    return s_jobs.busy_workers == 0;
+  });
+}
+
+const u32 job_system_get_threads_count() {
+  return s_jobs.workers.size() + 1;
+}
+
+const u32 job_system_get_thread_index() {
+  return s_thread_index;
+}
+/////////////////////////////////////////////////////////////////////////////////
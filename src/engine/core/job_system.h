@@ -0,0 +1,30 @@
+#pragma once
+
+#include "defines.h"
+
+// Callback
+/////////////////////////////////////////////////////////////////////////////////
+// Gets called once for every index of a dispatch, on any of the threads
+typedef void (*JobFunc)(const u32 index, void* user_data);
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Spin up the worker threads. Passing 0 uses one thread per core (minus the main thread).
+const bool job_system_init(const u32 threads_count = 0);
+void job_system_shutdown();
+
+// Run 'func' for every index in [0, count) across the worker threads (and the calling thread) 
+// and only return once all of them are done. 
+// NOTE: If the job system was never initialized (or this is called from within a job), 
+// everything just runs on the calling thread.
+// NOTE: Dispatches from different threads (the main and the render thread, for example) take turns.
+void job_system_dispatch(const u32 count, JobFunc func, void* user_data);
+
+// The number of threads a dispatch gets spread over, including the calling thread
+const u32 job_system_get_threads_count();
+
+// The index of the calling thread, in [0, threads count). The workers start at 1, 
+// while any thread that is not a worker (the main thread) is 0.
+const u32 job_system_get_thread_index();
+/////////////////////////////////////////////////////////////////////////////////
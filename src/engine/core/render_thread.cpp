@@ -0,0 +1,163 @@
+#include "render_thread.h"
+#include "defines.h"
+#include "core/window.h"
+#include "core/clock.h"
+
+#include <glad/gl.h>
+#include <glm/vec2.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// RenderFrame
+/////////////////////////////////////////////////////////////////////////////////
+// What the main thread knew when it kicked off the frame. The main thread keeps 
+// writing the window's size and the clock while the frame renders, so the 
+// render thread only ever reads these.
+struct RenderFrame {
+  glm::vec2 viewport_size;
+  f64 frame_time;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// RenderThread
+/////////////////////////////////////////////////////////////////////////////////
+struct RenderThread {
+  std::thread thread;
+
+  std::mutex mutex;
+  std::condition_variable kick_cond, done_cond;
+
+  RenderThreadFunc func = nullptr;
+  void* user_data       = nullptr;
+
+  RenderFrame latched; // Written on kick, under the lock
+  RenderFrame current; // The render thread's own copy of the frame it is rendering
+
+  bool has_frame  = false; // A frame was kicked off and is not done yet
+  bool is_running = false;
+};
+
+static RenderThread s_render;
+static thread_local bool s_is_render_thread = false;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static RenderFrame latch_frame() {
+  return RenderFrame{window_get_size(), gclock_frame_time()};
+}
+
+static void render_loop() {
+  window_set_current_context();
+  s_is_render_thread = true;
+
+  glm::vec2 current_size = s_render.current.viewport_size;
+
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(s_render.mutex);
+      s_render.kick_cond.wait(lock, []() {
+        return s_render.has_frame || !s_render.is_running;
+      });
+
+      if(!s_render.has_frame) {
+        break;
+      }
+
+      s_render.current = s_render.latched;
+    }
+
+    // The window got resized since the last frame
+    glm::vec2 viewport_size = s_render.current.viewport_size;
+    if(viewport_size != current_size) {
+      glViewport(0, 0, viewport_size.x, viewport_size.y);
+      current_size = viewport_size;
+    }
+
+    s_render.func(s_render.user_data);
+
+    {
+      std::lock_guard<std::mutex> lock(s_render.mutex);
+      s_render.has_frame = false;
+    }
+    s_render.done_cond.notify_one();
+  }
+
+  // Let go of the context so the main thread can take it back
+  window_clear_current_context();
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool render_thread_start(RenderThreadFunc func, void* user_data) {
+  if(s_render.is_running) {
+    return true;
+  }
+
+  s_render.func       = func;
+  s_render.user_data  = user_data;
+  s_render.has_frame  = false;
+  s_render.is_running = true;
+  s_render.latched    = latch_frame();
+  s_render.current    = s_render.latched; // What the viewport is at before the first frame
+
+  // A context can only be current on one thread at a time
+  window_clear_current_context();
+  s_render.thread = std::thread(render_loop);
+
+  return true;
+}
+
+void render_thread_stop() {
+  if(!s_render.is_running) {
+    return;
+  }
+
+  render_thread_wait();
+
+  {
+    std::lock_guard<std::mutex> lock(s_render.mutex);
+    s_render.is_running = false;
+  }
+  s_render.kick_cond.notify_one();
+
+  s_render.thread.join();
+  window_set_current_context();
+
+  // The window might have been resized after the last kick
+  glm::vec2 size = window_get_size();
+  glViewport(0, 0, size.x, size.y);
+}
+
+void render_thread_kick() {
+  {
+    std::lock_guard<std::mutex> lock(s_render.mutex);
+    s_render.has_frame = true;
+    s_render.latched   = latch_frame();
+  }
+
+  s_render.kick_cond.notify_one();
+}
+
+void render_thread_wait() {
+  std::unique_lock<std::mutex> lock(s_render.mutex);
+  s_render.done_cond.wait(lock, []() {
+    return !s_render.has_frame;
+  });
+}
+
+const bool render_thread_is_running() {
+  return s_render.is_running;
+}
+
+const glm::vec2 render_thread_get_viewport_size() {
+  return s_is_render_thread ? s_render.current.viewport_size : window_get_size();
+}
+
+const f64 render_thread_get_frame_time() {
+  return s_is_render_thread ? s_render.current.frame_time : gclock_frame_time();
+}
+/////////////////////////////////////////////////////////////////////////////////
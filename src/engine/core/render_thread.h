@@ -0,0 +1,48 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/vec2.hpp>
+
+// Callback
+/////////////////////////////////////////////////////////////////////////////////
+// Renders one frame on the render thread
+typedef void (*RenderThreadFunc)(void* user_data);
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A thread that owns the OpenGL context and renders one frame behind the main thread. 
+ *
+ * Every frame, the main thread waits for the last frame to finish ('render_thread_wait'), 
+ * latches whatever the next frame needs into data only the render thread reads, and then 
+ * kicks the frame off ('render_thread_kick'). The main thread is then free to simulate 
+ * the next frame while this one gets rendered (and swapped). Resizing the window only 
+ * changes the viewport once the next frame is kicked off.
+ *
+ * NOTE: The context is taken away from the calling thread, so nothing else can touch OpenGL 
+ * (creating textures or meshes included) until the thread is stopped again.
+ */
+const bool render_thread_start(RenderThreadFunc func, void* user_data);
+
+// Wait for the last frame and give the context back to the calling thread
+void render_thread_stop();
+
+// Start rendering a frame. 
+// NOTE: Must only be called once the last frame is done (see 'render_thread_wait').
+void render_thread_kick();
+
+// Block until the last frame that was kicked off is done
+void render_thread_wait();
+
+const bool render_thread_is_running();
+
+// The window size the current frame gets rendered at. On the render thread, that is the size 
+// as of the last kick. Anywhere else, it is the window's own size. 
+// NOTE: Anything that renders should use this rather than 'window_get_size'.
+const glm::vec2 render_thread_get_viewport_size();
+
+// Same as 'render_thread_get_viewport_size', but for 'gclock_frame_time'
+const f64 render_thread_get_frame_time();
+/////////////////////////////////////////////////////////////////////////////////
@@ -2,11 +2,18 @@
 #include "defines.h"
 #include "core/event.h"
 #include "core/input.h"
+#include "core/render_thread.h"
 
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <glm/vec2.hpp>
 
+#if defined(HEADLESS_ACTIVE)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <chrono>
 #include <cstdio>
 
 // Window
@@ -20,6 +27,17 @@ struct Window {
 
   bool is_focused;
   KeyCode exit_key;
+
+  // Headless state
+  bool is_headless   = false;
+  bool should_close  = false;
+  std::chrono::steady_clock::time_point start_time;
+
+#if defined(HEADLESS_ACTIVE)
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLContext context = EGL_NO_CONTEXT;
+  EGLSurface surface = EGL_NO_SURFACE;
+#endif
 }; 
 
 static Window window;
@@ -52,7 +70,11 @@ void mouse_callback(GLFWwindow* win, f64 x_pos, f64 y_pos) {
 
 void frame_buffer_resize_callback(GLFWwindow* win, i32 width, i32 height) {
   window.size = glm::vec2(width, height);
-  glViewport(0, 0, width, height);
+
+  // The render thread owns the context then, so it picks the new size up at the next kick instead
+  if(!render_thread_is_running()) {
+    glViewport(0, 0, width, height);
+  }
 }
 
 void key_callback(GLFWwindow* win, i32 key, i32 scancode, i32 action, i32 mods) {
@@ -146,6 +168,92 @@ static bool create_handle(i32 width, i32 height, const char* title) {
   return true;
 }
 
+#if defined(HEADLESS_ACTIVE)
+static EGLDisplay get_egl_display() {
+  // Surfaceless Mesa (llvmpipe included) does not need any display server
+  auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if(get_platform_display) {
+    EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+      return display;
+    }
+  }
+
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+    return display;
+  }
+
+  return EGL_NO_DISPLAY;
+}
+
+static bool create_headless_context() {
+  window.display = get_egl_display();
+  if(window.display == EGL_NO_DISPLAY) {
+    printf("[ERROR]: Failed to initialize an EGL display\n");
+    return false;
+  }
+
+  if(!eglBindAPI(EGL_OPENGL_API)) {
+    printf("[ERROR]: EGL does not support desktop OpenGL\n");
+    return false;
+  }
+
+  // A tiny pbuffer is only needed if the display cannot go without a surface. 
+  // The renderer draws into its own framebuffer anyway.
+  EGLConfig config = nullptr;
+  EGLint configs_count = 0;
+  EGLint config_attribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, 
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, 
+    EGL_NONE,
+  };
+  eglChooseConfig(window.display, config_attribs, &config, 1, &configs_count);
+
+  // Try for 4.6 first, since that is what the shaders are written against
+  for(EGLint minor = 6; minor >= 5 && window.context == EGL_NO_CONTEXT; minor--) {
+    EGLint context_attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 4, 
+      EGL_CONTEXT_MINOR_VERSION, minor, 
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE,
+    };
+
+    window.context = eglCreateContext(window.display, configs_count > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+  }
+
+  if(window.context == EGL_NO_CONTEXT) {
+    printf("[ERROR]: Failed to create a headless OpenGL 4.5+ context\n");
+    return false;
+  }
+
+  if(eglMakeCurrent(window.display, EGL_NO_SURFACE, EGL_NO_SURFACE, window.context)) {
+    return true;
+  }
+
+  if(configs_count > 0) {
+    EGLint surface_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    window.surface = eglCreatePbufferSurface(window.display, config, surface_attribs);
+  }
+
+  if(window.surface == EGL_NO_SURFACE || !eglMakeCurrent(window.display, window.surface, window.surface, window.context)) {
+    printf("[ERROR]: Failed to make the headless OpenGL context current\n");
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+static bool create_headless() {
+#if defined(HEADLESS_ACTIVE)
+  return create_headless_context();
+#else
+  printf("[ERROR]: Headless windows are not supported in this build (missing 'HEADLESS_ACTIVE')\n");
+  return false;
+#endif
+}
+
 static void set_callbacks() {
   glfwSetCursorPosCallback(window.handle, mouse_callback);
   glfwSetFramebufferSizeCallback(window.handle, frame_buffer_resize_callback);
@@ -155,14 +263,25 @@ static void set_callbacks() {
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool window_create(const i32 width, const i32 height, const char* title) {
-  // GLFW init 
+const bool window_create(const i32 width, const i32 height, const char* title, const bool headless) {
+  window.is_headless  = headless;
+  window.should_close = false;
+  window.start_time   = std::chrono::steady_clock::now();
+
+  // Context init 
   ////////////////////////////////////////// 
-  glfw_init();
-  if(!create_handle(width, height, title)) {
-    return false;
+  if(headless) {
+    if(!create_headless()) {
+      return false;
+    }
+  }
+  else {
+    glfw_init();
+    if(!create_handle(width, height, title)) {
+      return false;
+    }
+    set_callbacks();
   }
-  set_callbacks();
   ////////////////////////////////////////// 
 
   // Window init
@@ -174,26 +293,58 @@ const bool window_create(const i32 width, const i32 height, const char* title) {
   window.is_focused = false;
   window.exit_key = KEY_ESCAPE;
 
-  event_listen(EVENT_CURSOR_CHANGED, cursor_mode_change_callback);
+  // There is no cursor to change without a display
+  if(!headless) {
+    event_listen(EVENT_CURSOR_CHANGED, cursor_mode_change_callback);
+  }
   ////////////////////////////////////////// 
 
   return true;
 }
 
 void window_destroy() {
-  glfwDestroyWindow(window.handle);
-  glfwTerminate();
+  if(!window.is_headless) {
+    glfwDestroyWindow(window.handle);
+    glfwTerminate();
+
+    return;
+  }
+
+#if defined(HEADLESS_ACTIVE)
+  eglMakeCurrent(window.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if(window.surface != EGL_NO_SURFACE) {
+    eglDestroySurface(window.display, window.surface);
+  }
+  eglDestroyContext(window.display, window.context);
+  eglTerminate(window.display);
+
+  window.display = EGL_NO_DISPLAY;
+  window.context = EGL_NO_CONTEXT;
+  window.surface = EGL_NO_SURFACE;
+#endif
 }
 
 void window_poll_events() {
-  glfwPollEvents();
+  if(!window.is_headless) {
+    glfwPollEvents();
+  }
 }
 
 void window_swap_buffers() {
+  // Nothing to present without a display, but the frame should still get submitted
+  if(window.is_headless) {
+    glFlush();
+    return;
+  }
+
   glfwSwapBuffers(window.handle);
 }
 
 const bool window_should_close() {
+  if(window.is_headless) {
+    return window.should_close;
+  }
+
   return glfwWindowShouldClose(window.handle);
 }
 
@@ -202,6 +353,10 @@ const glm::vec2 window_get_size() {
 }
 
 const f64 window_get_time() {
+  if(window.is_headless) {
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - window.start_time).count();
+  }
+
   return glfwGetTime();
 }
 
@@ -213,19 +368,58 @@ GLFWwindow* window_get_handle() {
   return window.handle;
 }
 
+const bool window_is_headless() {
+  return window.is_headless;
+}
+
+WindowProc window_get_proc_address(const char* name) {
+#if defined(HEADLESS_ACTIVE)
+  if(window.is_headless) {
+    return (WindowProc)eglGetProcAddress(name);
+  }
+#endif
+
+  return (WindowProc)glfwGetProcAddress(name);
+}
+
 const KeyCode window_get_exit_key() {
   return window.exit_key;
 }
 
 void window_set_current_context() {
-  glfwMakeContextCurrent(window.handle);
+  if(!window.is_headless) {
+    glfwMakeContextCurrent(window.handle);
+    return;
+  }
+
+#if defined(HEADLESS_ACTIVE)
+  eglMakeCurrent(window.display, window.surface, window.surface, window.context);
+#endif
+}
+
+void window_clear_current_context() {
+  if(!window.is_headless) {
+    glfwMakeContextCurrent(nullptr);
+    return;
+  }
+
+#if defined(HEADLESS_ACTIVE)
+  eglMakeCurrent(window.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
 }
 
 void window_set_vsync(const bool vsync) {
-  glfwSwapInterval(vsync);
+  if(!window.is_headless) {
+    glfwSwapInterval(vsync);
+  }
 }
 
 void window_set_close(const bool close) {
+  if(window.is_headless) {
+    window.should_close = close;
+    return;
+  }
+
   glfwSetWindowShouldClose(window.handle, close);
 }
 
@@ -7,21 +7,38 @@
 
 struct GLFWwindow;
 
+// Callbacks
+/////////////////////////////////////////////////////////////////////////////////
+typedef void (*WindowProc)(void);
+/////////////////////////////////////////////////////////////////////////////////
+
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool window_create(const i32 width, const i32 height, const char* title); 
+// NOTE: A 'headless' window has no display at all. The OpenGL context is created through 
+// EGL (surfaceless Mesa if available, a pbuffer otherwise) and the renderer draws into an 
+// offscreen framebuffer of the given size instead. Useful for benchmarks on build machines.
+// Headless windows are only available if the engine was built with 'HEADLESS_ACTIVE'.
+const bool window_create(const i32 width, const i32 height, const char* title, const bool headless = false); 
 void window_destroy();
 void window_poll_events();
 void window_swap_buffers();
 
 const bool window_should_close();
+// NOTE: Only safe to read on the main thread. Anything that renders should use 'render_thread_get_viewport_size'.
 const glm::vec2 window_get_size();
 const f64 window_get_time();
 const f32 window_get_aspect_ratio();
 GLFWwindow* window_get_handle(); 
+const bool window_is_headless();
+
+// Returns the address of the given OpenGL function of the current context
+WindowProc window_get_proc_address(const char* name);
 const KeyCode window_get_exit_key();
 
 void window_set_current_context();
+
+// Make sure the context is not current on the calling thread, so another thread can take it
+void window_clear_current_context();
 void window_set_vsync(const bool vsync);
 void window_set_close(const bool close);
 void window_set_exit_key(KeyCode key);
@@ -0,0 +1,233 @@
+#include "dynamic_resolution.h"
+#include "defines.h"
+#include "core/render_thread.h"
+#include "graphics/gl_state.h"
+#include "graphics/shader.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstdio>
+#include <string>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define TIMER_QUERIES_MAX 4     // Frames in flight, so reading the results never has to wait on the GPU
+#define SCALE_HEADROOM    0.9   // Aim a bit under the target so small spikes do not go over it
+#define SCALE_SMOOTHING   0.25f // How much of the way to the wanted scale is taken every frame
+#define SCALE_DEADZONE    0.02f // Smaller changes are not worth the shimmering
+/////////////////////////////////////////////////////////////////////////////////
+
+// DynamicResolution
+/////////////////////////////////////////////////////////////////////////////////
+struct DynamicResolution {
+  DynamicResolutionDesc desc;
+
+  f32 scale;
+  f64 frame_time;
+
+  u32 queries[TIMER_QUERIES_MAX];
+  u32 query_index, pending_count;
+  bool has_gpu_time, is_timing;
+
+  Shader* upscale_shader;
+  u32 vao; // Empty, since the vertices of the fullscreen triangle come from 'gl_VertexID'
+
+  bool is_active = false;
+};
+
+static DynamicResolution s_dynres;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void load_shader() {
+  std::string upscale_code =
+    "@type vertex\n"
+    "#version 460 core\n"
+    "\n"
+    "// Outputs\n"
+    "out vec2 tex_coords;\n"
+    "\n"
+    "void main() {\n"
+    "  // A single triangle that covers the whole screen\n"
+    "  vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "  tex_coords = pos;\n"
+    "\n"
+    "  gl_Position = vec4((pos * 2.0f) - 1.0f, 0.0f, 1.0f);\n"
+    "}\n"
+    "\n"
+    "@type fragment\n"
+    "#version 460 core\n"
+    "\n"
+    "// Outputs\n"
+    "out vec4 frag_color;\n"
+    "\n"
+    "// Inputs\n"
+    "in vec2 tex_coords;\n"
+    "\n"
+    "// Uniforms\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform vec4 u_rect; // The scale of the drawn part and the furthest coords that do not filter in anything outside of it\n"
+    "\n"
+    "void main() {\n"
+    "  vec2 coords = min(tex_coords * u_rect.xy, u_rect.zw);\n"
+    "  frag_color  = vec4(texture(u_texture, coords).rgb, 1.0f);\n"
+    "}";
+
+  s_dynres.upscale_shader = shader_load("upscale.glsl", upscale_code);
+  shader_bind(s_dynres.upscale_shader);
+  shader_upload_int(s_dynres.upscale_shader, "u_texture", 0);
+}
+
+static bool read_gpu_time(f64* out_time) {
+  bool has_result = false;
+
+  // Read every query that is done, oldest first
+  while(s_dynres.pending_count > 0) {
+    u32 oldest = (s_dynres.query_index + TIMER_QUERIES_MAX - s_dynres.pending_count) % TIMER_QUERIES_MAX;
+
+    i32 is_available = 0;
+    glGetQueryObjectiv(s_dynres.queries[oldest], GL_QUERY_RESULT_AVAILABLE, &is_available);
+    if(!is_available) {
+      break;
+    }
+
+    u64 nanoseconds = 0;
+    glGetQueryObjectui64v(s_dynres.queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+
+    *out_time  = nanoseconds * 1e-9;
+    has_result = true;
+    s_dynres.pending_count--;
+  }
+
+  return has_result;
+}
+
+static void update_scale(const f64 frame_time) {
+  if(frame_time <= 0.0) {
+    return;
+  }
+  s_dynres.frame_time = frame_time;
+
+  // The cost of a frame goes with the pixels, which goes with the square of the scale
+  f64 budget  = s_dynres.desc.target_frame_time * SCALE_HEADROOM;
+  f32 desired = s_dynres.scale * (f32)glm::sqrt(budget / frame_time);
+  desired     = glm::clamp(desired, s_dynres.desc.min_scale, s_dynres.desc.max_scale);
+
+  if(glm::abs(desired - s_dynres.scale) < SCALE_DEADZONE) {
+    // Close enough, but the bounds should still be reached all the way
+    if(desired == s_dynres.desc.min_scale || desired == s_dynres.desc.max_scale) {
+      s_dynres.scale = desired;
+    }
+
+    return;
+  }
+
+  s_dynres.scale += (desired - s_dynres.scale) * SCALE_SMOOTHING;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool dynamic_resolution_init(const DynamicResolutionDesc& desc) {
+  if(desc.min_scale <= 0.0f || desc.min_scale > desc.max_scale || desc.max_scale > 1.0f) {
+    fprintf(stderr, "[ERROR]: Invalid dynamic resolution scale bounds\n");
+    return false;
+  }
+
+  s_dynres = DynamicResolution{};
+  s_dynres.desc  = desc;
+  s_dynres.scale = desc.max_scale;
+
+  glGenQueries(TIMER_QUERIES_MAX, s_dynres.queries);
+  glGenVertexArrays(1, &s_dynres.vao);
+  load_shader();
+
+  s_dynres.is_active = true;
+  return true;
+}
+
+void dynamic_resolution_shutdown() {
+  if(!s_dynres.is_active) {
+    return;
+  }
+
+  glDeleteQueries(TIMER_QUERIES_MAX, s_dynres.queries);
+  glDeleteVertexArrays(1, &s_dynres.vao);
+  shader_unload(s_dynres.upscale_shader);
+  gl_state_reset();
+
+  s_dynres.is_active = false;
+}
+
+void dynamic_resolution_begin() {
+  if(!s_dynres.is_active) {
+    return;
+  }
+
+  // Only new results say anything about the current scale. Without any
+  // GPU timings so far, the frame time of the CPU will have to do.
+  f64 gpu_time = 0.0;
+  if(read_gpu_time(&gpu_time)) {
+    s_dynres.has_gpu_time = true;
+    update_scale(gpu_time);
+  }
+  else if(!s_dynres.has_gpu_time) {
+    update_scale(render_thread_get_frame_time());
+  }
+
+  // Every query is still in flight. Skip measuring this frame.
+  if(s_dynres.pending_count == TIMER_QUERIES_MAX) {
+    return;
+  }
+
+  glBeginQuery(GL_TIME_ELAPSED, s_dynres.queries[s_dynres.query_index]);
+  s_dynres.is_timing = true;
+}
+
+void dynamic_resolution_end() {
+  if(!s_dynres.is_timing) {
+    return;
+  }
+
+  glEndQuery(GL_TIME_ELAPSED);
+
+  s_dynres.query_index = (s_dynres.query_index + 1) % TIMER_QUERIES_MAX;
+  s_dynres.pending_count++;
+  s_dynres.is_timing = false;
+}
+
+const f32 dynamic_resolution_get_scale() {
+  return s_dynres.is_active ? s_dynres.scale : 1.0f;
+}
+
+const f64 dynamic_resolution_get_frame_time() {
+  return s_dynres.frame_time;
+}
+
+void dynamic_resolution_upscale(const u32 texture, const glm::ivec2& size) {
+  gl_state_bind_vertex_array(s_dynres.vao);
+  gl_state_bind_texture(GL_TEXTURE_2D, 0, texture);
+
+  // The part that got drawn, rounded the same way as the viewport
+  glm::vec2 texel  = 1.0f / glm::vec2(size);
+  glm::vec2 scale  = glm::vec2(glm::max(glm::ivec2(glm::vec2(size) * dynamic_resolution_get_scale()), glm::ivec2(1))) * texel;
+  glm::vec2 coords = scale - (texel * 0.5f);
+
+  shader_bind(s_dynres.upscale_shader);
+  shader_upload_vec4(s_dynres.upscale_shader, "u_rect", glm::vec4(scale, coords));
+
+  bool had_depth_test = gl_state_get_depth_test();
+  bool had_blend      = gl_state_get_blend();
+
+  gl_state_set_depth_test(false);
+  gl_state_set_blend(false);
+
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  gl_state_count_draw();
+
+  gl_state_set_depth_test(had_depth_test);
+  gl_state_set_blend(had_blend);
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/vec2.hpp>
+
+// DynamicResolutionDesc
+/////////////////////////////////////////////////////////////////////////////////
+struct DynamicResolutionDesc {
+  // The frame time (in seconds) the controller tries to stay under
+  f64 target_frame_time = 1.0 / 60.0;
+
+  // The bounds of the resolution scale (per axis) relative to the full size of the scene target
+  f32 min_scale = 0.5f;
+  f32 max_scale = 1.0f;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Dynamic resolution keeps the frame rate up by rendering the 3D scene into a part of
+ * an offscreen target and scaling it up to the window afterwards. The scale of that part
+ * is adjusted every frame by a controller, based on how long the frames take against the target.
+ *
+ * The frame time is measured on the GPU with timer queries (between 'dynamic_resolution_begin'
+ * and 'dynamic_resolution_end'). Until those give any results, the controller goes by the
+ * frame time of 'gclock' instead (see 'render_thread_get_frame_time').
+ *
+ * A frame goes like so:
+ *  - 'dynamic_resolution_begin'
+ *  - Draw the scene with the viewport at 'dynamic_resolution_get_scale' times the size of the target
+ *  - 'dynamic_resolution_upscale' the target into the window
+ *  - Draw the UI at the native resolution
+ *  - 'dynamic_resolution_end'
+ *
+ * NOTE: The frame graph can take care of the viewport (see 'frame_graph_pass_set_viewport_scale').
+ */
+const bool dynamic_resolution_init(const DynamicResolutionDesc& desc);
+void dynamic_resolution_shutdown();
+
+// Run the controller with the latest timings and start measuring the frame.
+void dynamic_resolution_begin();
+void dynamic_resolution_end();
+
+// The current resolution scale (per axis), always within the bounds of the description
+const f32 dynamic_resolution_get_scale();
+
+// The last frame time (in seconds) that the controller went by
+const f64 dynamic_resolution_get_frame_time();
+
+// Draw the scaled part of the given texture over the whole of the bound framebuffer.
+// 'size' is the full size of the texture (see 'frame_graph_get_texture_size').
+// NOTE: This ignores (and does not write) the depth.
+void dynamic_resolution_upscale(const u32 texture, const glm::ivec2& size);
+/////////////////////////////////////////////////////////////////////////////////
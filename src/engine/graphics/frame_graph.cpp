@@ -0,0 +1,612 @@
+#include "frame_graph.h"
+#include "defines.h"
+#include "core/render_thread.h"
+#include "graphics/gl_state.h"
+#include "graphics/renderer.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define NO_PASS 0xffffffff
+/////////////////////////////////////////////////////////////////////////////////
+
+// PassEdges
+/////////////////////////////////////////////////////////////////////////////////
+// The passes that have to run before a pass. Only 'inputs' carry data into the
+// pass. The rest only have to go first (like a read before a later write).
+struct PassEdges {
+  std::vector<u32> inputs;
+  std::vector<u32> after;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static bool is_depth(const FrameGraphFormat format) {
+  return format == FRAME_GRAPH_FORMAT_DEPTH24_STENCIL8;
+}
+
+static u32 get_internal_format(const FrameGraphFormat format) {
+  switch(format) {
+    case FRAME_GRAPH_FORMAT_RGBA8:
+      return GL_RGBA8;
+    case FRAME_GRAPH_FORMAT_RGBA16F:
+      return GL_RGBA16F;
+    case FRAME_GRAPH_FORMAT_DEPTH24_STENCIL8:
+      return GL_DEPTH24_STENCIL8;
+  }
+
+  return GL_RGBA8;
+}
+
+static usizei get_texture_bytes(const FrameGraphFormat format, const glm::ivec2& size) {
+  usizei pixel_size = (format == FRAME_GRAPH_FORMAT_RGBA16F) ? 8 : 4;
+  return pixel_size * size.x * size.y;
+}
+
+static glm::ivec2 resolve_size(const FrameGraphTextureDesc& desc, const glm::vec2& window_size) {
+  if(desc.width > 0 && desc.height > 0) {
+    return glm::ivec2(desc.width, desc.height);
+  }
+
+  return glm::max(glm::ivec2(window_size * desc.scale), glm::ivec2(1));
+}
+
+static void release_resources(FrameGraph* graph) {
+  for(auto& physical : graph->physicals) {
+    glDeleteTextures(1, &physical.id);
+  }
+
+  for(auto& target : graph->targets) {
+    glDeleteFramebuffers(1, &target.fbo);
+  }
+
+  graph->physicals.clear();
+  graph->targets.clear();
+  graph->order.clear();
+  graph->is_compiled = false;
+
+  gl_state_reset(); // The ids might get reused
+}
+
+static const bool validate_pass(const FrameGraph* graph, const FrameGraphPass& pass) {
+  u32 colors = 0, depths = 0;
+  bool has_backbuffer = false;
+
+  for(auto& write : pass.writes) {
+    if(std::find(pass.reads.begin(), pass.reads.end(), write) != pass.reads.end()) {
+      fprintf(stderr, "[ERROR]: Pass \'%s\' reads and writes \'%s\'\n", pass.name.c_str(), graph->textures[write].name.c_str());
+      return false;
+    }
+
+    if(write == FRAME_GRAPH_BACKBUFFER) {
+      has_backbuffer = true;
+    }
+    else if(is_depth(graph->textures[write].desc.format)) {
+      depths++;
+    }
+    else {
+      colors++;
+    }
+  }
+
+  if(has_backbuffer && pass.writes.size() > 1) {
+    fprintf(stderr, "[ERROR]: Pass \'%s\' writes the backbuffer together with other textures\n", pass.name.c_str());
+    return false;
+  }
+
+  if(colors > FRAME_GRAPH_MAX_COLOR_WRITES || depths > 1) {
+    fprintf(stderr, "[ERROR]: Pass \'%s\' writes too many textures\n", pass.name.c_str());
+    return false;
+  }
+
+  for(auto& read : pass.reads) {
+    if(read == FRAME_GRAPH_BACKBUFFER) {
+      fprintf(stderr, "[ERROR]: Pass \'%s\' reads the backbuffer\n", pass.name.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void build_edges(const FrameGraph* graph, std::vector<PassEdges>& edges) {
+  // Walk the passes in the order they were declared, keeping track of who touched every texture last
+  std::vector<u32> last_writer(graph->textures.size(), NO_PASS);
+  std::vector<std::vector<u32>> readers(graph->textures.size());
+
+  edges.assign(graph->passes.size(), PassEdges{});
+
+  for(u32 i = 0; i < graph->passes.size(); i++) {
+    const FrameGraphPass& pass = graph->passes[i];
+
+    for(auto& read : pass.reads) {
+      if(last_writer[read] != NO_PASS) {
+        edges[i].inputs.push_back(last_writer[read]);
+      }
+      readers[read].push_back(i);
+    }
+
+    for(auto& write : pass.writes) {
+      // Without a clear, the pass draws on top of what the last writer left behind
+      if(last_writer[write] != NO_PASS) {
+        if(pass.has_clear) {
+          edges[i].after.push_back(last_writer[write]);
+        }
+        else {
+          edges[i].inputs.push_back(last_writer[write]);
+        }
+      }
+
+      // Anyone who read the older contents has to be done before they get overwritten
+      for(auto& reader : readers[write]) {
+        edges[i].after.push_back(reader);
+      }
+
+      readers[write].clear();
+      last_writer[write] = i;
+    }
+  }
+}
+
+static void cull_passes(FrameGraph* graph, const std::vector<PassEdges>& edges) {
+  // Passes writing to the outputs are the roots. Everything they take their inputs from is needed as well.
+  std::vector<u32> stack;
+
+  for(u32 i = 0; i < graph->passes.size(); i++) {
+    FrameGraphPass& pass = graph->passes[i];
+    pass.is_culled = true;
+
+    for(auto& write : pass.writes) {
+      if(graph->textures[write].is_output) {
+        stack.push_back(i);
+        break;
+      }
+    }
+  }
+
+  while(!stack.empty()) {
+    u32 index = stack.back();
+    stack.pop_back();
+
+    if(!graph->passes[index].is_culled) {
+      continue;
+    }
+
+    graph->passes[index].is_culled = false;
+    stack.insert(stack.end(), edges[index].inputs.begin(), edges[index].inputs.end());
+  }
+}
+
+// Culled passes still stand between the passes around them, so their own dependencies carry over
+static void collect_live_deps(const FrameGraph* graph, const std::vector<PassEdges>& edges, const u32 pass, std::vector<u32>& out_deps) {
+  for(const std::vector<u32>* list : {&edges[pass].inputs, &edges[pass].after}) {
+    for(auto& dep : *list) {
+      if(!graph->passes[dep].is_culled) {
+        out_deps.push_back(dep);
+      }
+      else {
+        collect_live_deps(graph, edges, dep, out_deps);
+      }
+    }
+  }
+}
+
+static const bool order_passes(FrameGraph* graph, const std::vector<PassEdges>& edges) {
+  u32 passes_count = graph->passes.size();
+
+  std::vector<u32> waiting(passes_count, 0);
+  std::vector<std::vector<u32>> dependents(passes_count);
+  u32 live_count = 0;
+
+  for(u32 i = 0; i < passes_count; i++) {
+    if(graph->passes[i].is_culled) {
+      continue;
+    }
+    live_count++;
+
+    std::vector<u32> deps;
+    collect_live_deps(graph, edges, i, deps);
+
+    for(auto& dep : deps) {
+      waiting[i]++;
+      dependents[dep].push_back(i);
+    }
+  }
+
+  std::vector<u32> ready;
+  for(u32 i = 0; i < passes_count; i++) {
+    if(!graph->passes[i].is_culled && waiting[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  graph->order.clear();
+  const std::vector<u32>* last_writes = nullptr;
+
+  while(!ready.empty()) {
+    // Prefer a pass with the same targets as the last one, and the declaration order after that
+    u32 best = 0;
+    for(u32 i = 0; i < ready.size(); i++) {
+      bool same_target      = last_writes && graph->passes[ready[i]].writes == *last_writes;
+      bool best_same_target = last_writes && graph->passes[ready[best]].writes == *last_writes;
+
+      if((same_target && !best_same_target) || (same_target == best_same_target && ready[i] < ready[best])) {
+        best = i;
+      }
+    }
+
+    u32 index = ready[best];
+    ready.erase(ready.begin() + best);
+
+    graph->order.push_back(index);
+    last_writes = &graph->passes[index].writes;
+
+    for(auto& dependent : dependents[index]) {
+      if(--waiting[dependent] == 0) {
+        ready.push_back(dependent);
+      }
+    }
+  }
+
+  if(graph->order.size() != live_count) {
+    fprintf(stderr, "[ERROR]: The frame graph has a cycle\n");
+    return false;
+  }
+
+  return true;
+}
+
+static void allocate_textures(FrameGraph* graph) {
+  std::vector<u32> used;
+
+  for(auto& texture : graph->textures) {
+    texture.physical  = -1;
+    texture.first_use = NO_PASS;
+    texture.last_use  = 0;
+    texture.size      = resolve_size(texture.desc, graph->window_size);
+  }
+
+  // The lifetime of every texture within the execution order
+  for(u32 i = 0; i < graph->order.size(); i++) {
+    const FrameGraphPass& pass = graph->passes[graph->order[i]];
+
+    for(const std::vector<u32>* list : {&pass.reads, &pass.writes}) {
+      for(auto& handle : *list) {
+        FrameGraphTexture& texture = graph->textures[handle];
+        if(texture.first_use == NO_PASS) {
+          used.push_back(handle);
+        }
+
+        texture.first_use = std::min(texture.first_use, i);
+        texture.last_use  = std::max(texture.last_use, i);
+      }
+    }
+  }
+
+  std::sort(used.begin(), used.end(), [&](const u32 a, const u32 b) {
+    return graph->textures[a].first_use < graph->textures[b].first_use;
+  });
+
+  for(auto& handle : used) {
+    if(handle == FRAME_GRAPH_BACKBUFFER) {
+      continue;
+    }
+
+    FrameGraphTexture& texture = graph->textures[handle];
+    if(texture.is_output) {
+      texture.last_use = graph->order.size();
+    }
+
+    // Take over any texture of the same kind that is not used anymore by the time this one is needed
+    for(u32 i = 0; i < graph->physicals.size(); i++) {
+      FrameGraphPhysical& physical = graph->physicals[i];
+
+      if(physical.format == texture.desc.format && physical.size == texture.size && physical.free_after < texture.first_use) {
+        texture.physical    = i;
+        physical.free_after = texture.last_use;
+        break;
+      }
+    }
+
+    if(texture.physical != -1) {
+      continue;
+    }
+
+    FrameGraphPhysical physical = {};
+    physical.format     = texture.desc.format;
+    physical.size       = texture.size;
+    physical.free_after = texture.last_use;
+
+    glGenTextures(1, &physical.id);
+    gl_state_bind_texture_for_edit(GL_TEXTURE_2D, physical.id);
+    glTexStorage2D(GL_TEXTURE_2D, 1, get_internal_format(physical.format), physical.size.x, physical.size.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    texture.physical = graph->physicals.size();
+    graph->physicals.push_back(physical);
+  }
+}
+
+static const bool create_target(FrameGraph* graph, FrameGraphPass& pass) {
+  if(pass.writes[0] == FRAME_GRAPH_BACKBUFFER) {
+    pass.fbo  = renderer_get_framebuffer();
+    pass.size = glm::ivec2(graph->window_size);
+
+    return true;
+  }
+
+  std::vector<i32> attachments;
+  for(auto& write : pass.writes) {
+    attachments.push_back(graph->textures[write].physical);
+  }
+
+  pass.size = graph->textures[pass.writes[0]].size;
+  for(auto& write : pass.writes) {
+    if(graph->textures[write].size != pass.size) {
+      fprintf(stderr, "[ERROR]: The textures pass \'%s\' writes are not the same size\n", pass.name.c_str());
+      return false;
+    }
+  }
+
+  // Passes with the same attachments share a framebuffer
+  for(auto& target : graph->targets) {
+    if(target.attachments == attachments) {
+      pass.fbo = target.fbo;
+      return true;
+    }
+  }
+
+  FrameGraphTarget target = {};
+  target.attachments      = attachments;
+
+  glGenFramebuffers(1, &target.fbo);
+  gl_state_bind_framebuffer(target.fbo);
+
+  u32 draw_buffers[FRAME_GRAPH_MAX_COLOR_WRITES];
+  u32 colors_count = 0;
+
+  for(auto& write : pass.writes) {
+    const FrameGraphTexture& texture = graph->textures[write];
+    u32 id = graph->physicals[texture.physical].id;
+
+    if(is_depth(texture.desc.format)) {
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, id, 0);
+      continue;
+    }
+
+    draw_buffers[colors_count] = GL_COLOR_ATTACHMENT0 + colors_count;
+    glFramebufferTexture2D(GL_FRAMEBUFFER, draw_buffers[colors_count], GL_TEXTURE_2D, id, 0);
+    colors_count++;
+  }
+
+  if(colors_count > 0) {
+    glDrawBuffers(colors_count, draw_buffers);
+  }
+  else {
+    glDrawBuffer(GL_NONE);
+  }
+
+  if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf(stderr, "[ERROR]: The framebuffer of pass \'%s\' is incomplete\n", pass.name.c_str());
+    glDeleteFramebuffers(1, &target.fbo);
+    gl_state_reset(); // The cache still thinks it is bound, and the id might get reused
+
+    return false;
+  }
+
+  pass.fbo = target.fbo;
+  graph->targets.push_back(target);
+
+  return true;
+}
+
+static void clear_pass(const FrameGraph* graph, const FrameGraphPass& pass) {
+  u32 mask = 0;
+
+  for(auto& write : pass.writes) {
+    if(write == FRAME_GRAPH_BACKBUFFER) {
+      mask |= GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+    }
+    else if(is_depth(graph->textures[write].desc.format)) {
+      mask |= GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+    }
+    else {
+      mask |= GL_COLOR_BUFFER_BIT;
+    }
+  }
+
+  // Depth writes have to be on for the depth to be cleared
+  gl_state_set_depth_mask(true);
+
+  glClearColor(pass.clear_color.r, pass.clear_color.g, pass.clear_color.b, pass.clear_color.a);
+  glClear(mask);
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void frame_graph_create(FrameGraph* graph) {
+  *graph = FrameGraph{};
+
+  // The backbuffer always ends up on the screen
+  FrameGraphTexture backbuffer = {};
+  backbuffer.name      = "backbuffer";
+  backbuffer.is_output = true;
+
+  graph->textures.push_back(backbuffer);
+}
+
+void frame_graph_destroy(FrameGraph* graph) {
+  release_resources(graph);
+
+  graph->textures.clear();
+  graph->passes.clear();
+}
+
+const u32 frame_graph_add_texture(FrameGraph* graph, const std::string& name, const FrameGraphTextureDesc& desc) {
+  FrameGraphTexture texture = {};
+  texture.name = name;
+  texture.desc = desc;
+
+  graph->textures.push_back(texture);
+  graph->is_compiled = false;
+
+  return graph->textures.size() - 1;
+}
+
+void frame_graph_set_output(FrameGraph* graph, const u32 texture) {
+  graph->textures[texture].is_output = true;
+  graph->is_compiled = false;
+}
+
+const u32 frame_graph_add_pass(FrameGraph* graph, const std::string& name, FrameGraphPassFunc func, void* user_data) {
+  FrameGraphPass pass = {};
+  pass.name      = name;
+  pass.func      = func;
+  pass.user_data = user_data;
+
+  graph->passes.push_back(pass);
+  graph->is_compiled = false;
+
+  return graph->passes.size() - 1;
+}
+
+void frame_graph_pass_read(FrameGraph* graph, const u32 pass, const u32 texture) {
+  graph->passes[pass].reads.push_back(texture);
+  graph->is_compiled = false;
+}
+
+void frame_graph_pass_write(FrameGraph* graph, const u32 pass, const u32 texture) {
+  graph->passes[pass].writes.push_back(texture);
+  graph->is_compiled = false;
+}
+
+void frame_graph_pass_clear(FrameGraph* graph, const u32 pass, const glm::vec4& color) {
+  graph->passes[pass].has_clear   = true;
+  graph->passes[pass].clear_color = color;
+  graph->is_compiled = false;
+}
+
+void frame_graph_pass_set_viewport_scale(FrameGraph* graph, const u32 pass, const f32 scale) {
+  graph->passes[pass].viewport_scale = scale;
+}
+
+const bool frame_graph_compile(FrameGraph* graph) {
+  release_resources(graph);
+  graph->window_size = render_thread_get_viewport_size();
+
+  for(auto& pass : graph->passes) {
+    if(!validate_pass(graph, pass)) {
+      return false;
+    }
+  }
+
+  std::vector<PassEdges> edges;
+  build_edges(graph, edges);
+  cull_passes(graph, edges);
+
+  if(!order_passes(graph, edges)) {
+    return false;
+  }
+
+  allocate_textures(graph);
+
+  for(auto& index : graph->order) {
+    if(!create_target(graph, graph->passes[index])) {
+      release_resources(graph);
+      return false;
+    }
+  }
+  gl_state_bind_framebuffer(renderer_get_framebuffer());
+
+  // Stats
+  graph->stats = FrameGraphStats{};
+  graph->stats.passes_count    = graph->passes.size();
+  graph->stats.culled_count    = graph->passes.size() - graph->order.size();
+  graph->stats.textures_count  = graph->textures.size() - 1; // Without the backbuffer
+  graph->stats.physicals_count = graph->physicals.size();
+
+  for(u32 i = 1; i < graph->textures.size(); i++) {
+    const FrameGraphTexture& texture = graph->textures[i];
+    graph->stats.declared_bytes += get_texture_bytes(texture.desc.format, texture.size);
+  }
+
+  for(auto& physical : graph->physicals) {
+    graph->stats.allocated_bytes += get_texture_bytes(physical.format, physical.size);
+  }
+
+  graph->is_compiled = true;
+  return true;
+}
+
+void frame_graph_execute(FrameGraph* graph) {
+  if(!graph->is_compiled || graph->window_size != render_thread_get_viewport_size()) {
+    if(!frame_graph_compile(graph)) {
+      return;
+    }
+  }
+
+  u32 bound_fbo = NO_PASS; // Whatever was bound before is not known here
+  glm::ivec2 viewport = glm::ivec2(graph->window_size);
+  graph->stats.binds_count = 0;
+
+  for(auto& index : graph->order) {
+    FrameGraphPass& pass = graph->passes[index];
+
+    if(pass.fbo != bound_fbo) {
+      gl_state_bind_framebuffer(pass.fbo);
+
+      bound_fbo = pass.fbo;
+      graph->stats.binds_count++;
+    }
+
+    glm::ivec2 pass_viewport = glm::max(glm::ivec2(glm::vec2(pass.size) * pass.viewport_scale), glm::ivec2(1));
+    if(pass_viewport != viewport) {
+      glViewport(0, 0, pass_viewport.x, pass_viewport.y);
+      viewport = pass_viewport;
+    }
+
+    if(pass.has_clear) {
+      clear_pass(graph, pass);
+    }
+
+    if(pass.func) {
+      pass.func(graph, pass.user_data);
+    }
+  }
+
+  // Leave things the way they were for anything drawn after the graph
+  if(bound_fbo != renderer_get_framebuffer()) {
+    gl_state_bind_framebuffer(renderer_get_framebuffer());
+    graph->stats.binds_count++;
+  }
+
+  if(viewport != glm::ivec2(graph->window_size)) {
+    glViewport(0, 0, graph->window_size.x, graph->window_size.y);
+  }
+}
+
+const u32 frame_graph_get_texture(const FrameGraph* graph, const u32 texture) {
+  i32 physical = graph->textures[texture].physical;
+  return (physical == -1) ? 0 : graph->physicals[physical].id;
+}
+
+const glm::ivec2 frame_graph_get_texture_size(const FrameGraph* graph, const u32 texture) {
+  return graph->textures[texture].size;
+}
+
+const FrameGraphStats& frame_graph_get_stats(const FrameGraph* graph) {
+  return graph->stats;
+}
+/////////////////////////////////////////////////////////////////////////////////
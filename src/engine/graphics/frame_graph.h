@@ -0,0 +1,198 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <string>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define FRAME_GRAPH_BACKBUFFER        0 // The texture handle of the window's framebuffer. Every graph starts out with it.
+#define FRAME_GRAPH_MAX_COLOR_WRITES  4 // The most color textures a single pass can write to
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphFormat
+/////////////////////////////////////////////////////////////////////////////////
+enum FrameGraphFormat {
+  FRAME_GRAPH_FORMAT_RGBA8,
+  FRAME_GRAPH_FORMAT_RGBA16F,
+  FRAME_GRAPH_FORMAT_DEPTH24_STENCIL8,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphTextureDesc
+/////////////////////////////////////////////////////////////////////////////////
+struct FrameGraphTextureDesc {
+  FrameGraphFormat format = FRAME_GRAPH_FORMAT_RGBA8;
+
+  // The size relative to the window. Ignored if 'width' and 'height' are given.
+  f32 scale  = 1.0f;
+  u32 width  = 0;
+  u32 height = 0;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Callbacks
+/////////////////////////////////////////////////////////////////////////////////
+struct FrameGraph;
+
+// Gets called with the targets of the pass already bound. Use 'frame_graph_get_texture' to sample the inputs.
+typedef void (*FrameGraphPassFunc)(FrameGraph* graph, void* user_data);
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphTexture
+/////////////////////////////////////////////////////////////////////////////////
+// A texture as the passes see it. Many of them can share the same GL texture.
+struct FrameGraphTexture {
+  std::string name;
+  FrameGraphTextureDesc desc;
+  bool is_output = false;
+
+  // Filled in by 'frame_graph_compile'
+  glm::ivec2 size;
+  i32 physical = -1;  // Into 'FrameGraph::physicals'
+  u32 first_use, last_use; // In the execution order
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphPhysical
+/////////////////////////////////////////////////////////////////////////////////
+struct FrameGraphPhysical {
+  u32 id;
+  FrameGraphFormat format;
+  glm::ivec2 size;
+
+  u32 free_after; // The last pass (in the execution order) that uses the texture
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphTarget
+/////////////////////////////////////////////////////////////////////////////////
+// A framebuffer with a set of physical textures attached. Passes with the same attachments share it.
+struct FrameGraphTarget {
+  u32 fbo;
+  std::vector<i32> attachments;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphPass
+/////////////////////////////////////////////////////////////////////////////////
+struct FrameGraphPass {
+  std::string name;
+  FrameGraphPassFunc func;
+  void* user_data;
+
+  std::vector<u32> reads, writes;
+
+  bool has_clear = false;
+  glm::vec4 clear_color;
+
+  f32 viewport_scale = 1.0f;
+
+  // Filled in by 'frame_graph_compile'
+  bool is_culled;
+  u32 fbo;
+  glm::ivec2 size;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraphStats
+/////////////////////////////////////////////////////////////////////////////////
+struct FrameGraphStats {
+  u32 passes_count, culled_count;
+  u32 textures_count, physicals_count;
+
+  // The memory every declared texture would take on its own vs. what actually got allocated
+  usizei declared_bytes, allocated_bytes;
+
+  // Framebuffer binds in the last execute
+  u32 binds_count;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FrameGraph
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A declarative description of the passes of a frame. Passes only say which textures
+ * they read and write and the graph figures out the rest when compiled:
+ *
+ * - Passes that do not contribute to the backbuffer (or any texture marked as an output) are culled.
+ * - Passes are ordered by their dependencies. Between passes that are free to go in any order,
+ *   the ones that write to the same targets are kept together to cut down on framebuffer binds.
+ * - Textures are transient. They only live from the first to the last pass that uses them, and
+ *   textures with the same format and size that do not overlap share the same GL texture.
+ *
+ * The order of declaration is the order of the frame as the user sees it: a pass reads
+ * whatever the passes declared before it wrote into the texture.
+ *
+ * NOTE: Since textures share memory, their contents are undefined before the first pass
+ * that writes to them. That pass should clear them (see 'frame_graph_pass_clear') or cover every pixel.
+ * NOTE: A pass cannot read and write the same texture, which means it never samples a texture
+ * that is attached to the bound framebuffer. OpenGL takes care of the rest of the synchronization.
+ */
+struct FrameGraph {
+  std::vector<FrameGraphTexture> textures;
+  std::vector<FrameGraphPass> passes;
+
+  // Filled in by 'frame_graph_compile'
+  std::vector<u32> order;
+  std::vector<FrameGraphPhysical> physicals;
+  std::vector<FrameGraphTarget> targets;
+
+  glm::vec2 window_size;
+  bool is_compiled = false;
+
+  FrameGraphStats stats;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void frame_graph_create(FrameGraph* graph);
+void frame_graph_destroy(FrameGraph* graph);
+
+// Declare a texture and return its handle.
+const u32 frame_graph_add_texture(FrameGraph* graph, const std::string& name, const FrameGraphTextureDesc& desc);
+
+// Keep the texture alive to the end of the frame, and keep the passes that write into it from being culled.
+void frame_graph_set_output(FrameGraph* graph, const u32 texture);
+
+// Declare a pass and return its handle. Passes that end up writing nothing are always culled.
+const u32 frame_graph_add_pass(FrameGraph* graph, const std::string& name, FrameGraphPassFunc func, void* user_data = nullptr);
+void frame_graph_pass_read(FrameGraph* graph, const u32 pass, const u32 texture);
+
+// NOTE: The backbuffer cannot be written together with other textures.
+// A pass can write at most one depth texture and 'FRAME_GRAPH_MAX_COLOR_WRITES' color textures.
+void frame_graph_pass_write(FrameGraph* graph, const u32 pass, const u32 texture);
+
+// Clear everything the pass writes to before it runs.
+// Everything the passes before wrote to the same textures is dropped, so those passes might get culled.
+void frame_graph_pass_clear(FrameGraph* graph, const u32 pass, const glm::vec4& color);
+
+// Only draw into a part of the targets, scaled (per axis) from the bottom left corner.
+// Changing the scale does not need another compile, so it can change every frame (see 'dynamic_resolution.h').
+// NOTE: The clear still covers the whole of the targets.
+void frame_graph_pass_set_viewport_scale(FrameGraph* graph, const u32 pass, const f32 scale);
+
+// Cull, order, and allocate the textures of the graph.
+// Returns 'false' if any of the passes are invalid or if there is a cycle.
+// NOTE: Any texture or pass added afterwards requires another compile.
+const bool frame_graph_compile(FrameGraph* graph);
+
+// Run the passes of the graph. Compiles the graph first if it is not compiled
+// yet or if the window got resized since.
+// NOTE: The backbuffer is left bound afterwards.
+void frame_graph_execute(FrameGraph* graph);
+
+// Returns the GL texture behind the given handle.
+// NOTE: Only valid while the graph is executing, since another texture might be using the same memory at other times.
+const u32 frame_graph_get_texture(const FrameGraph* graph, const u32 texture);
+
+// Returns the full size of the given texture, as of the last compile
+const glm::ivec2 frame_graph_get_texture_size(const FrameGraph* graph, const u32 texture);
+
+const FrameGraphStats& frame_graph_get_stats(const FrameGraph* graph);
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,298 @@
+#include "geometry_pool.h"
+#include "defines.h"
+#include "graphics/gl_state.h"
+#include "graphics/vertex_layout.h"
+#include "math/vertex.h"
+#include "utils/free_list.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstdio>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define POOL_INITIAL_VERTICES 65536
+#define POOL_INITIAL_INDICES  (POOL_INITIAL_VERTICES * 3)
+#define MAX_SHORT_VERTICES    65536 // The most vertices a mesh can have and still use 16-bit indices
+/////////////////////////////////////////////////////////////////////////////////
+
+// IndexBuffer
+/////////////////////////////////////////////////////////////////////////////////
+// Every index width gets its own vertex array, since the element 
+// buffer binding is part of the vertex array state.
+struct IndexBuffer {
+  u32 vao, ebo;
+  u32 index_size;
+
+  FreeList indices;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// GeometryPool
+/////////////////////////////////////////////////////////////////////////////////
+struct GeometryPool {
+  u32 vbo;
+  FreeList vertices;
+
+  IndexBuffer index_buffers[2]; // 32-bit and 16-bit
+
+  VertexFormat format;
+  u32 stride;
+
+  bool is_active = false;
+};
+
+static GeometryPool s_pool;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static IndexBuffer& get_index_buffer(const bool short_indices) {
+  return s_pool.index_buffers[short_indices ? 1 : 0];
+}
+
+static void setup_vertex_arrays() {
+  for(auto& buffer : s_pool.index_buffers) {
+    gl_state_bind_vertex_array(buffer.vao);
+    gl_state_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, buffer.ebo);
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, s_pool.vbo);
+
+    vertex_layout_apply(vertex_layout_get(s_pool.format));
+  }
+}
+
+static u32 create_buffer(const u32 target, const usizei size) {
+  u32 buffer;
+  glGenBuffers(1, &buffer);
+  gl_state_bind_buffer(target, buffer);
+  glBufferData(target, size, nullptr, GL_STATIC_DRAW);
+
+  return buffer;
+}
+
+// Create a bigger buffer and copy over the old contents into it
+static u32 grow_buffer(const u32 old_buffer, const usizei old_size, const usizei new_size) {
+  u32 buffer = create_buffer(GL_COPY_WRITE_BUFFER, new_size);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, old_buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_size);
+
+  glDeleteBuffers(1, &old_buffer);
+  gl_state_reset(); // The id might get reused by a new buffer
+
+  return buffer;
+}
+
+static u32 get_grown_capacity(const u32 old_capacity, const u32 count) {
+  u32 new_capacity = old_capacity * 2;
+  while(new_capacity - old_capacity < count) {
+    new_capacity *= 2;
+  }
+
+  return new_capacity;
+}
+
+static bool alloc_vertices(const u32 count, u32* out_offset) {
+  if(free_list_alloc(&s_pool.vertices, count, out_offset)) {
+    return true;
+  }
+
+  u32 old_capacity = s_pool.vertices.capacity;
+  u32 new_capacity = get_grown_capacity(old_capacity, count);
+
+  s_pool.vbo = grow_buffer(s_pool.vbo, s_pool.stride * old_capacity, s_pool.stride * new_capacity);
+  free_list_grow(&s_pool.vertices, new_capacity);
+  setup_vertex_arrays();
+
+  return free_list_alloc(&s_pool.vertices, count, out_offset);
+}
+
+static bool alloc_indices(IndexBuffer& buffer, const u32 count, u32* out_offset) {
+  if(free_list_alloc(&buffer.indices, count, out_offset)) {
+    return true;
+  }
+
+  u32 old_capacity = buffer.indices.capacity;
+  u32 new_capacity = get_grown_capacity(old_capacity, count);
+
+  buffer.ebo = grow_buffer(buffer.ebo, buffer.index_size * old_capacity, buffer.index_size * new_capacity);
+  free_list_grow(&buffer.indices, new_capacity);
+  setup_vertex_arrays();
+
+  return free_list_alloc(&buffer.indices, count, out_offset);
+}
+
+static void upload_indices(IndexBuffer& buffer, const u32 offset, const std::vector<u32>& indices) {
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, buffer.ebo);
+
+  if(buffer.index_size == sizeof(u32)) {
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(u32) * offset, sizeof(u32) * indices.size(), indices.data());
+    return;
+  }
+
+  std::vector<u16> short_indices(indices.begin(), indices.end());
+  glBufferSubData(GL_ARRAY_BUFFER, sizeof(u16) * offset, sizeof(u16) * short_indices.size(), short_indices.data());
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool geometry_pool_create(const bool packed_vertices) {
+  s_pool.format = packed_vertices ? VERTEX_FORMAT_3D_PACKED : VERTEX_FORMAT_3D;
+  s_pool.stride = vertex_layout_get(s_pool.format).stride;
+
+  s_pool.vbo = create_buffer(GL_ARRAY_BUFFER, s_pool.stride * POOL_INITIAL_VERTICES);
+  free_list_create(&s_pool.vertices, POOL_INITIAL_VERTICES);
+
+  for(u32 i = 0; i < 2; i++) {
+    IndexBuffer& buffer = s_pool.index_buffers[i];
+    buffer.index_size   = (i == 0) ? sizeof(u32) : sizeof(u16);
+
+    glGenVertexArrays(1, &buffer.vao);
+    buffer.ebo = create_buffer(GL_ARRAY_BUFFER, buffer.index_size * POOL_INITIAL_INDICES);
+    free_list_create(&buffer.indices, POOL_INITIAL_INDICES);
+  }
+
+  setup_vertex_arrays();
+
+  s_pool.is_active = true;
+  return true;
+}
+
+void geometry_pool_destroy() {
+  if(!s_pool.is_active) {
+    return;
+  }
+
+  glDeleteBuffers(1, &s_pool.vbo);
+  for(auto& buffer : s_pool.index_buffers) {
+    glDeleteVertexArrays(1, &buffer.vao);
+    glDeleteBuffers(1, &buffer.ebo);
+
+    buffer.indices.ranges.clear();
+  }
+  gl_state_reset();
+
+  s_pool.vertices.ranges.clear();
+  s_pool.is_active = false;
+}
+
+const GeometryAllocation geometry_pool_alloc(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices) {
+  GeometryAllocation alloc = {};
+  alloc.vertex_count      = vertices.size();
+  alloc.index_count       = indices.empty() ? vertices.size() : indices.size();
+  alloc.has_short_indices = alloc.vertex_count <= MAX_SHORT_VERTICES;
+
+  IndexBuffer& index_buffer = get_index_buffer(alloc.has_short_indices);
+  if(!alloc_vertices(alloc.vertex_count, &alloc.vertex_offset)) {
+    fprintf(stderr, "[ERROR]: Geometry pool failed to allocate %u vertices\n", alloc.vertex_count);
+    return GeometryAllocation{};
+  }
+
+  if(!alloc_indices(index_buffer, alloc.index_count, &alloc.index_offset)) {
+    fprintf(stderr, "[ERROR]: Geometry pool failed to allocate %u indices\n", alloc.index_count);
+
+    // The vertices would never be freed otherwise
+    free_list_free(&s_pool.vertices, alloc.vertex_offset, alloc.vertex_count);
+    return GeometryAllocation{};
+  }
+
+  // Vertices
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, s_pool.vbo);
+  if(s_pool.format == VERTEX_FORMAT_3D) {
+    alloc.position_offset = glm::vec3(0.0f);
+    alloc.position_scale  = glm::vec3(1.0f);
+
+    glBufferSubData(GL_ARRAY_BUFFER, s_pool.stride * alloc.vertex_offset, s_pool.stride * alloc.vertex_count, vertices.data());
+  }
+  else {
+    // Quantize the positions into the bounds of the mesh
+    glm::vec3 min = vertices.empty() ? glm::vec3(0.0f) : vertices[0].position;
+    glm::vec3 max = min;
+    for(auto& vert : vertices) {
+      min = glm::min(min, vert.position);
+      max = glm::max(max, vert.position);
+    }
+
+    // Flat meshes (like a plane) have no extent on one of the axes
+    glm::vec3 extent = glm::max(max - min, glm::vec3(1e-6f));
+    
+    alloc.position_offset = min;
+    alloc.position_scale  = extent;
+
+    std::vector<Vertex3DPacked> packed(vertices.size());
+    for(u32 i = 0; i < vertices.size(); i++) {
+      packed[i] = vertex_pack(vertices[i], min, extent);
+    }
+    
+    glBufferSubData(GL_ARRAY_BUFFER, s_pool.stride * alloc.vertex_offset, s_pool.stride * alloc.vertex_count, packed.data());
+  }
+
+  // Indices
+  // NOTE: The indices stay relative to the mesh. The base vertex of each draw
+  // takes care of offsetting them into the pool.
+  if(!indices.empty()) {
+    upload_indices(index_buffer, alloc.index_offset, indices);
+  }
+  else {
+    std::vector<u32> trivial_indices(alloc.index_count);
+    for(u32 i = 0; i < alloc.index_count; i++) {
+      trivial_indices[i] = i;
+    }
+
+    upload_indices(index_buffer, alloc.index_offset, trivial_indices);
+  }
+
+  return alloc;
+}
+
+void geometry_pool_free(const GeometryAllocation& alloc) {
+  if(!s_pool.is_active) {
+    return;
+  }
+
+  free_list_free(&s_pool.vertices, alloc.vertex_offset, alloc.vertex_count);
+  free_list_free(&get_index_buffer(alloc.has_short_indices).indices, alloc.index_offset, alloc.index_count);
+}
+
+const bool geometry_pool_alloc_indices(const std::vector<u32>& indices, const bool short_indices, u32* out_offset) {
+  IndexBuffer& buffer = get_index_buffer(short_indices);
+
+  if(!alloc_indices(buffer, indices.size(), out_offset)) {
+    fprintf(stderr, "[ERROR]: Geometry pool failed to allocate %zu indices\n", indices.size());
+    return false;
+  }
+
+  upload_indices(buffer, *out_offset, indices);
+  return true;
+}
+
+void geometry_pool_update_indices(const u32 offset, const std::vector<u32>& indices, const bool short_indices) {
+  upload_indices(get_index_buffer(short_indices), offset, indices);
+}
+
+void geometry_pool_free_indices(const u32 offset, const u32 count, const bool short_indices) {
+  if(!s_pool.is_active) {
+    return;
+  }
+
+  free_list_free(&get_index_buffer(short_indices).indices, offset, count);
+}
+
+const glm::mat4 geometry_pool_get_model(const GeometryAllocation& alloc, const glm::mat4& model) {
+  // Same as 'model * translate(offset) * scale(scale)', without the matrix multiplications
+  glm::mat4 result = model;
+  result[0] *= alloc.position_scale.x;
+  result[1] *= alloc.position_scale.y;
+  result[2] *= alloc.position_scale.z;
+  result[3]  = model * glm::vec4(alloc.position_offset, 1.0f);
+
+  return result;
+}
+
+const u32 geometry_pool_get_vao(const bool short_indices) {
+  return get_index_buffer(short_indices).vao;
+}
+/////////////////////////////////////////////////////////////////////////////////
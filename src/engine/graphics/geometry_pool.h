@@ -0,0 +1,72 @@
+#pragma once
+
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+// GeometryAllocation
+/////////////////////////////////////////////////////////////////////////////////
+// Where a mesh lives inside of the pool. Offsets and counts are in
+// vertices and indices, not bytes.
+struct GeometryAllocation {
+  u32 vertex_offset, vertex_count;
+  u32 index_offset, index_count;
+
+  // Meshes that are small enough get 16-bit indices, which live in their own 
+  // index buffer (and vertex array). The index offset is relative to that buffer.
+  bool has_short_indices;
+
+  // Packed positions are quantized into the bounds of the mesh. 
+  // These bring them back (they do nothing if the vertices are not packed).
+  glm::vec3 position_offset, position_scale;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * The geometry pool is one big vertex buffer and two big index buffers (16-bit and 32-bit) 
+ * that every mesh gets sub-allocated from. Since all the meshes share the same buffers (and 
+ * the same vertex array per index width), any number of meshes can be drawn without switching 
+ * vertex arrays and can be batched together into one multi-draw call per index width.
+ *
+ * If 'packed_vertices' is set, the vertices are stored as 'Vertex3DPacked' at half the size. 
+ * Every draw from the pool then has to go through 'geometry_pool_get_model' (or an 
+ * equivalent in the shader) to get the quantized positions back.
+ *
+ * NOTE: The pool will grow (and copy the old data over) if it ever runs out of space.
+ */
+const bool geometry_pool_create(const bool packed_vertices = false);
+void geometry_pool_destroy();
+
+// Upload the given vertices and indices into the pool.
+// NOTE: If 'indices' is empty, a trivial index list (0, 1, 2...) will be generated since
+// everything in the pool gets drawn with indices.
+const GeometryAllocation geometry_pool_alloc(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices);
+
+// Give the space back to the pool.
+// NOTE: This does nothing if the pool is already destroyed.
+void geometry_pool_free(const GeometryAllocation& alloc);
+
+// Upload extra indices that reuse the vertices of an existing allocation (levels of detail, for example).
+// The indices should be just as wide as the ones of the allocation they belong to.
+// Returns 'false' if the indices could not be allocated.
+const bool geometry_pool_alloc_indices(const std::vector<u32>& indices, const bool short_indices, u32* out_offset);
+
+// Overwrite indices that were already allocated (reordering them, for example)
+void geometry_pool_update_indices(const u32 offset, const std::vector<u32>& indices, const bool short_indices);
+
+// Give the indices back to the pool.
+// NOTE: This does nothing if the pool is already destroyed.
+void geometry_pool_free_indices(const u32 offset, const u32 count, const bool short_indices);
+
+// Fold the position dequantization of the allocation into the given model matrix
+const glm::mat4 geometry_pool_get_model(const GeometryAllocation& alloc, const glm::mat4& model);
+
+// The vertex array that everything in the pool with the given index width is drawn with
+const u32 geometry_pool_get_vao(const bool short_indices = false);
+/////////////////////////////////////////////////////////////////////////////////
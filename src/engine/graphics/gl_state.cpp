@@ -0,0 +1,290 @@
+#include "gl_state.h"
+#include "defines.h"
+
+#include <glad/gl.h>
+
+#include <cstring>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define STATE_UNKNOWN     0xffffffff
+#define MAX_TEXTURE_UNITS 32
+/////////////////////////////////////////////////////////////////////////////////
+
+// Tracked targets
+/////////////////////////////////////////////////////////////////////////////////
+static const u32 BUFFER_TARGETS[] = {
+  GL_ARRAY_BUFFER,
+  GL_ELEMENT_ARRAY_BUFFER,
+  GL_UNIFORM_BUFFER,
+  GL_DRAW_INDIRECT_BUFFER,
+  GL_SHADER_STORAGE_BUFFER,
+};
+#define BUFFER_TARGETS_MAX (sizeof(BUFFER_TARGETS) / sizeof(u32))
+
+static const u32 TEXTURE_TARGETS[] = {
+  GL_TEXTURE_2D,
+  GL_TEXTURE_CUBE_MAP,
+  GL_TEXTURE_2D_ARRAY,
+};
+#define TEXTURE_TARGETS_MAX (sizeof(TEXTURE_TARGETS) / sizeof(u32))
+/////////////////////////////////////////////////////////////////////////////////
+
+// GLState
+/////////////////////////////////////////////////////////////////////////////////
+struct GLState {
+  u32 program;
+  u32 vertex_array;
+  u32 buffers[BUFFER_TARGETS_MAX];
+
+  u32 active_unit;
+  u32 textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS_MAX];
+
+  // Flags are 'u32' as well so they can be 'STATE_UNKNOWN'
+  u32 framebuffer;
+
+  u32 blend, depth_test, depth_mask;
+  u32 blend_src, blend_dest, depth_func;
+
+  u32 scissor_test;
+  i32 scissor[4]; // -1 if not known
+
+  GLStateStats frame_stats, last_stats;
+};
+
+static GLState s_state;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static i32 get_target_index(const u32* targets, const usizei count, const u32 target) {
+  for(u32 i = 0; i < count; i++) {
+    if(targets[i] == target) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Returns 'true' if the call needs to reach OpenGL and counts it either way
+static bool should_issue(const GLStateCallType type, u32* cached, const u32 value) {
+  if(*cached == value) {
+    s_state.frame_stats.skipped[type]++;
+    s_state.frame_stats.total_skipped++;
+
+    return false;
+  }
+
+  *cached = value;
+  s_state.frame_stats.issued[type]++;
+  s_state.frame_stats.total_issued++;
+
+  return true;
+}
+
+static void set_capability(const GLStateCallType type, u32* cached, const u32 cap, const bool enable) {
+  if(!should_issue(type, cached, enable)) {
+    return;
+  }
+
+  if(enable) {
+    glEnable(cap);
+  }
+  else {
+    glDisable(cap);
+  }
+}
+
+static bool get_capability(u32* cached, const u32 cap) {
+  if(*cached == STATE_UNKNOWN) {
+    *cached = glIsEnabled(cap);
+  }
+
+  return *cached;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void gl_state_reset() {
+  s_state.program      = STATE_UNKNOWN;
+  s_state.vertex_array = STATE_UNKNOWN;
+  s_state.active_unit  = STATE_UNKNOWN;
+  s_state.framebuffer  = STATE_UNKNOWN;
+
+  memset(s_state.buffers, 0xff, sizeof(s_state.buffers));
+  memset(s_state.textures, 0xff, sizeof(s_state.textures));
+
+  s_state.blend      = STATE_UNKNOWN;
+  s_state.depth_test = STATE_UNKNOWN;
+  s_state.depth_mask = STATE_UNKNOWN;
+  s_state.blend_src  = STATE_UNKNOWN;
+  s_state.blend_dest = STATE_UNKNOWN;
+  s_state.depth_func = STATE_UNKNOWN;
+
+  s_state.scissor_test = STATE_UNKNOWN;
+  memset(s_state.scissor, 0xff, sizeof(s_state.scissor));
+}
+
+void gl_state_new_frame() {
+  s_state.last_stats  = s_state.frame_stats;
+  s_state.frame_stats = GLStateStats{};
+}
+
+const GLStateStats& gl_state_get_stats() {
+  return s_state.last_stats;
+}
+
+void gl_state_count_draw(const u32 draws_count) {
+  s_state.frame_stats.draw_calls++;
+  s_state.frame_stats.draws += draws_count;
+}
+
+void gl_state_use_program(const u32 program) {
+  if(should_issue(GL_STATE_CALL_PROGRAM, &s_state.program, program)) {
+    glUseProgram(program);
+  }
+}
+
+void gl_state_bind_vertex_array(const u32 vao) {
+  if(!should_issue(GL_STATE_CALL_VERTEX_ARRAY, &s_state.vertex_array, vao)) {
+    return;
+  }
+
+  glBindVertexArray(vao);
+
+  // The element buffer binding lives inside the vertex array
+  s_state.buffers[get_target_index(BUFFER_TARGETS, BUFFER_TARGETS_MAX, GL_ELEMENT_ARRAY_BUFFER)] = STATE_UNKNOWN;
+}
+
+void gl_state_bind_buffer(const u32 target, const u32 buffer) {
+  i32 index = get_target_index(BUFFER_TARGETS, BUFFER_TARGETS_MAX, target);
+
+  // Not a target we keep track of. Just let it through
+  if(index == -1) {
+    u32 unknown = STATE_UNKNOWN;
+    should_issue(GL_STATE_CALL_BUFFER, &unknown, buffer);
+    glBindBuffer(target, buffer);
+
+    return;
+  }
+
+  if(should_issue(GL_STATE_CALL_BUFFER, &s_state.buffers[index], buffer)) {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void gl_state_bind_texture(const u32 target, const u32 unit, const u32 texture) {
+  i32 index = get_target_index(TEXTURE_TARGETS, TEXTURE_TARGETS_MAX, target);
+
+  // Untracked targets or units always reach OpenGL
+  if(index == -1 || unit >= MAX_TEXTURE_UNITS) {
+    s_state.active_unit = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+
+    s_state.frame_stats.issued[GL_STATE_CALL_TEXTURE] += 2;
+    s_state.frame_stats.total_issued += 2;
+    return;
+  }
+
+  // Nothing to do here if the texture is already bound to that unit.
+  // We do not even need to switch the active unit.
+  if(s_state.textures[unit][index] == texture) {
+    s_state.frame_stats.skipped[GL_STATE_CALL_TEXTURE]++;
+    s_state.frame_stats.total_skipped++;
+
+    return;
+  }
+
+  if(should_issue(GL_STATE_CALL_TEXTURE, &s_state.active_unit, unit)) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+
+  should_issue(GL_STATE_CALL_TEXTURE, &s_state.textures[unit][index], texture);
+  glBindTexture(target, texture);
+}
+
+void gl_state_bind_texture_for_edit(const u32 target, const u32 texture) {
+  // A cached bind might leave another unit active, which is the one the edit would go to
+  if(should_issue(GL_STATE_CALL_TEXTURE, &s_state.active_unit, 0)) {
+    glActiveTexture(GL_TEXTURE0);
+  }
+
+  gl_state_bind_texture(target, 0, texture);
+}
+
+void gl_state_bind_framebuffer(const u32 fbo) {
+  if(should_issue(GL_STATE_CALL_FRAMEBUFFER, &s_state.framebuffer, fbo)) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  }
+}
+
+void gl_state_set_blend(const bool enable) {
+  set_capability(GL_STATE_CALL_BLEND, &s_state.blend, GL_BLEND, enable);
+}
+
+void gl_state_set_blend_func(const u32 src_factor, const u32 dest_factor) {
+  if(s_state.blend_src == src_factor && s_state.blend_dest == dest_factor) {
+    s_state.frame_stats.skipped[GL_STATE_CALL_BLEND]++;
+    s_state.frame_stats.total_skipped++;
+
+    return;
+  }
+
+  s_state.blend_src  = src_factor;
+  s_state.blend_dest = dest_factor;
+  s_state.frame_stats.issued[GL_STATE_CALL_BLEND]++;
+  s_state.frame_stats.total_issued++;
+
+  glBlendFunc(src_factor, dest_factor);
+}
+
+void gl_state_set_depth_test(const bool enable) {
+  set_capability(GL_STATE_CALL_DEPTH, &s_state.depth_test, GL_DEPTH_TEST, enable);
+}
+
+void gl_state_set_depth_mask(const bool enable) {
+  if(should_issue(GL_STATE_CALL_DEPTH, &s_state.depth_mask, enable)) {
+    glDepthMask(enable);
+  }
+}
+
+void gl_state_set_depth_func(const u32 func) {
+  if(should_issue(GL_STATE_CALL_DEPTH, &s_state.depth_func, func)) {
+    glDepthFunc(func);
+  }
+}
+
+void gl_state_set_scissor_test(const bool enable) {
+  set_capability(GL_STATE_CALL_SCISSOR, &s_state.scissor_test, GL_SCISSOR_TEST, enable);
+}
+
+void gl_state_set_scissor(const i32 x, const i32 y, const i32 width, const i32 height) {
+  i32* scissor = s_state.scissor;
+  if(scissor[0] == x && scissor[1] == y && scissor[2] == width && scissor[3] == height) {
+    s_state.frame_stats.skipped[GL_STATE_CALL_SCISSOR]++;
+    s_state.frame_stats.total_skipped++;
+
+    return;
+  }
+
+  scissor[0] = x;
+  scissor[1] = y;
+  scissor[2] = width;
+  scissor[3] = height;
+  s_state.frame_stats.issued[GL_STATE_CALL_SCISSOR]++;
+  s_state.frame_stats.total_issued++;
+
+  glScissor(x, y, width, height);
+}
+
+const bool gl_state_get_blend() {
+  return get_capability(&s_state.blend, GL_BLEND);
+}
+
+const bool gl_state_get_depth_test() {
+  return get_capability(&s_state.depth_test, GL_DEPTH_TEST);
+}
+/////////////////////////////////////////////////////////////////////////////////
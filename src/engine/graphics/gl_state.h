@@ -0,0 +1,82 @@
+#pragma once
+
+#include "defines.h"
+
+// GLStateCallType
+/////////////////////////////////////////////////////////////////////////////////
+enum GLStateCallType {
+  GL_STATE_CALL_PROGRAM,
+  GL_STATE_CALL_VERTEX_ARRAY,
+  GL_STATE_CALL_BUFFER,
+  GL_STATE_CALL_TEXTURE,
+  GL_STATE_CALL_BLEND,
+  GL_STATE_CALL_DEPTH,
+  GL_STATE_CALL_FRAMEBUFFER,
+  GL_STATE_CALL_SCISSOR,
+
+  GL_STATE_CALLS_MAX = 8,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// GLStateStats
+/////////////////////////////////////////////////////////////////////////////////
+struct GLStateStats {
+  // How many calls actually reached OpenGL and how many were skipped
+  // since the state was already set. Indexed by 'GLStateCallType'.
+  u32 issued[GL_STATE_CALLS_MAX];
+  u32 skipped[GL_STATE_CALLS_MAX];
+
+  u32 total_issued, total_skipped;
+
+  // The draw calls that were made and the draws within them (a multi-draw call has many)
+  u32 draw_calls, draws;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Forget every cached state. The next call to any of the 'gl_state_*' functions
+// will always reach OpenGL. Call this after any code that changes the GL state
+// behind the cache's back (or after deleting any GL objects).
+void gl_state_reset();
+
+// Store the counters of the frame that just ended and start counting again.
+// NOTE: This gets called by 'renderer_present' every frame.
+void gl_state_new_frame();
+
+// Returns the counters of the last completed frame.
+const GLStateStats& gl_state_get_stats();
+
+// Binding functions
+// These functions will only call into OpenGL if the given object is not already bound.
+// NOTE: Binding a vertex array will forget the element buffer binding since
+// that binding is part of the vertex array's state.
+void gl_state_use_program(const u32 program);
+void gl_state_bind_vertex_array(const u32 vao);
+void gl_state_bind_buffer(const u32 target, const u32 buffer);
+void gl_state_bind_texture(const u32 target, const u32 unit, const u32 texture);
+
+// Binds the texture to unit 0 and makes sure unit 0 is the active one, even if the texture 
+// was already bound there. Use this before any call that edits or queries the bound texture.
+void gl_state_bind_texture_for_edit(const u32 target, const u32 texture);
+
+// Binds the framebuffer for both drawing and reading
+void gl_state_bind_framebuffer(const u32 fbo);
+
+// Count a draw call made with 'draws_count' draws for the stats
+void gl_state_count_draw(const u32 draws_count = 1);
+
+// Render state functions
+void gl_state_set_blend(const bool enable);
+void gl_state_set_blend_func(const u32 src_factor, const u32 dest_factor);
+void gl_state_set_depth_test(const bool enable);
+void gl_state_set_depth_mask(const bool enable);
+void gl_state_set_depth_func(const u32 func);
+void gl_state_set_scissor_test(const bool enable);
+void gl_state_set_scissor(const i32 x, const i32 y, const i32 width, const i32 height);
+
+// Render state queries
+// These only ask OpenGL if the state is not cached yet. Useful to put the state back after changing it.
+const bool gl_state_get_blend();
+const bool gl_state_get_depth_test();
+/////////////////////////////////////////////////////////////////////////////////
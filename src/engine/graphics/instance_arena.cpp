@@ -0,0 +1,162 @@
+#include "instance_arena.h"
+#include "defines.h"
+#include "graphics/gl_state.h"
+#include "utils/free_list.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstdio>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define ARENA_INITIAL_INSTANCES 4096
+#define ARENA_MIN_RESERVE       64
+/////////////////////////////////////////////////////////////////////////////////
+
+// InstanceAttributes
+/////////////////////////////////////////////////////////////////////////////////
+struct InstanceAttributes {
+  u32 vao; 
+  u32 first_location;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// InstanceArena
+/////////////////////////////////////////////////////////////////////////////////
+struct InstanceArena {
+  u32 buffer; 
+  FreeList instances;
+
+  std::vector<InstanceAttributes> attributes;
+
+  bool is_active = false;
+};
+
+static InstanceArena s_arena;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void set_attributes(const InstanceAttributes& attr) {
+  gl_state_bind_vertex_array(attr.vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, s_arena.buffer);
+
+  // One attribute per column of the model matrix
+  for(u32 i = 0; i < 4; i++) {
+    u32 location = attr.first_location + i;
+
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, 4, GL_FLOAT, false, sizeof(glm::mat4), (void*)(sizeof(glm::vec4) * i));
+    glVertexAttribDivisor(location, 1);
+  }
+}
+
+static bool grow_arena(const u32 count) {
+  u32 old_capacity = s_arena.instances.capacity;
+  u32 new_capacity = old_capacity * 2;
+  while(new_capacity - old_capacity < count) {
+    new_capacity *= 2;
+  }
+
+  // Create a bigger buffer and copy the old instances into it
+  u32 buffer;
+  glGenBuffers(1, &buffer);
+  gl_state_bind_buffer(GL_COPY_WRITE_BUFFER, buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, sizeof(glm::mat4) * new_capacity, nullptr, GL_DYNAMIC_DRAW);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, s_arena.buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(glm::mat4) * old_capacity);
+
+  glDeleteBuffers(1, &s_arena.buffer);
+  gl_state_reset(); // The id might get reused by a new buffer
+
+  s_arena.buffer = buffer;
+  free_list_grow(&s_arena.instances, new_capacity);
+
+  // Every vertex array still points to the old buffer
+  for(auto& attr : s_arena.attributes) {
+    set_attributes(attr);
+  }
+
+  return true;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool instance_arena_create() {
+  glGenBuffers(1, &s_arena.buffer);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, s_arena.buffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * ARENA_INITIAL_INSTANCES, nullptr, GL_DYNAMIC_DRAW);
+
+  free_list_create(&s_arena.instances, ARENA_INITIAL_INSTANCES);
+
+  s_arena.is_active = true;
+  return true;
+}
+
+void instance_arena_destroy() {
+  if(!s_arena.is_active) {
+    return;
+  }
+
+  glDeleteBuffers(1, &s_arena.buffer);
+  gl_state_reset();
+
+  s_arena.instances.ranges.clear();
+  s_arena.attributes.clear();
+  s_arena.is_active = false;
+}
+
+void instance_arena_setup_attributes(const u32 vao, const u32 first_location) {
+  InstanceAttributes attr = {vao, first_location};
+  
+  s_arena.attributes.push_back(attr);
+  set_attributes(attr);
+}
+
+const bool instance_arena_reserve(InstanceAllocation* alloc, const u32 count) {
+  if(alloc->count >= count) {
+    return true;
+  }
+
+  instance_arena_free(alloc);
+
+  // Reserve more than asked for so the range does not have to move every 
+  // time the number of instances goes up by a little.
+  u32 reserve = ARENA_MIN_RESERVE;
+  while(reserve < count) {
+    reserve *= 2;
+  }
+
+  u32 offset;
+  if(!free_list_alloc(&s_arena.instances, reserve, &offset)) {
+    grow_arena(reserve);
+
+    if(!free_list_alloc(&s_arena.instances, reserve, &offset)) {
+      fprintf(stderr, "[ERROR]: Instance arena failed to allocate %u instances\n", reserve);
+      return false;
+    }
+  }
+
+  alloc->offset = offset;
+  alloc->count  = reserve;
+  return true;
+}
+
+void instance_arena_free(InstanceAllocation* alloc) {
+  if(!s_arena.is_active || alloc->count == 0) {
+    return;
+  }
+
+  free_list_free(&s_arena.instances, alloc->offset, alloc->count);
+  *alloc = InstanceAllocation{};
+}
+
+void instance_arena_upload(const InstanceAllocation& alloc, const glm::mat4* transforms, const u32 count) {
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, s_arena.buffer);
+  glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * alloc.offset, sizeof(glm::mat4) * count, transforms);
+}
+/////////////////////////////////////////////////////////////////////////////////
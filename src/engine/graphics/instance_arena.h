@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/mat4x4.hpp>
+
+// InstanceAllocation
+/////////////////////////////////////////////////////////////////////////////////
+// A range of instances inside of the arena. Both the offset and the 
+// count are in instances (one 'glm::mat4' each), not bytes.
+struct InstanceAllocation {
+  u32 offset, count;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * The instance arena is one shared buffer of model matrices that instanced draws 
+ * read from. Meshes do not get any instance storage until they are actually drawn 
+ * instanced, at which point a range of the arena gets reserved for them. The range 
+ * is then used as the base instance of the draw call.
+ *
+ * NOTE: The arena will grow (and copy the old data over) if it ever runs out of space.
+ */
+const bool instance_arena_create();
+void instance_arena_destroy();
+
+// Point the attributes 'first_location' to 'first_location + 3' of the given vertex array 
+// at the arena. The vertex array will be updated again whenever the arena grows.
+void instance_arena_setup_attributes(const u32 vao, const u32 first_location);
+
+// Make sure 'alloc' can hold at least 'count' instances. 
+// Nothing happens if it is big enough already. Otherwise, the old range is given back and 
+// a new (bigger) range is reserved. Returns 'false' if the arena could not fit the new range.
+const bool instance_arena_reserve(InstanceAllocation* alloc, const u32 count);
+
+// Give the range back to the arena.
+// NOTE: This does nothing if the arena is already destroyed.
+void instance_arena_free(InstanceAllocation* alloc);
+
+// Upload 'count' matrices to the start of the given range
+void instance_arena_upload(const InstanceAllocation& alloc, const glm::mat4* transforms, const u32 count);
+/////////////////////////////////////////////////////////////////////////////////
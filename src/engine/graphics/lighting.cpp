@@ -0,0 +1,298 @@
+#include "lighting.h"
+#include "defines.h"
+#include "core/job_system.h"
+#include "graphics/camera.h"
+#include "graphics/gl_state.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LIGHTING_SSE 1
+#endif
+
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define CLUSTER_TILES (CLUSTER_GRID_X * CLUSTER_GRID_Y) // Froxels per slice
+#define CLUSTERS_MAX  (CLUSTER_TILES * CLUSTER_GRID_Z)
+/////////////////////////////////////////////////////////////////////////////////
+
+// GPULight
+/////////////////////////////////////////////////////////////////////////////////
+// The std430 layout of a light in the shaders
+struct GPULight {
+  glm::vec4 position_radius; 
+  glm::vec4 color_intensity;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// ClusterSlice
+/////////////////////////////////////////////////////////////////////////////////
+// The view space bounds of every froxel in a slice, laid out so four of them can be tested at once
+struct ClusterSlice {
+  alignas(16) f32 min_x[CLUSTER_TILES], min_y[CLUSTER_TILES], min_z[CLUSTER_TILES];
+  alignas(16) f32 max_x[CLUSTER_TILES], max_y[CLUSTER_TILES], max_z[CLUSTER_TILES];
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// ViewLight
+/////////////////////////////////////////////////////////////////////////////////
+struct ViewLight {
+  glm::vec3 center; 
+  f32 radius;
+  u32 first_slice, last_slice;
+  u32 index;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Lighting
+/////////////////////////////////////////////////////////////////////////////////
+struct Lighting {
+  std::vector<PointLight> lights;
+  std::vector<ViewLight> view_lights;
+
+  // The froxel bounds only change with the projection
+  ClusterSlice slices[CLUSTER_GRID_Z];
+  glm::mat4 projection;
+  f32 near, far;
+  f32 slice_scale, slice_bias;
+
+  std::vector<u32> froxel_lights[CLUSTERS_MAX]; // Filled by the jobs
+  std::vector<glm::uvec2> clusters;             // Offset and count of every froxel
+  std::vector<u32> indices;
+
+  u32 lights_buffer, clusters_buffer, indices_buffer;
+  LightingStats stats;
+};
+
+static Lighting s_lighting;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static f32 get_slice_depth(const u32 slice) {
+  return s_lighting.near * glm::pow(s_lighting.far / s_lighting.near, (f32)slice / CLUSTER_GRID_Z);
+}
+
+static void build_slices(const glm::mat4& projection) {
+  s_lighting.projection = projection;
+
+  // Pulling the planes out of the perspective matrix
+  s_lighting.near = projection[3][2] / (projection[2][2] - 1.0f);
+  s_lighting.far  = projection[3][2] / (projection[2][2] + 1.0f);
+
+  f32 log_ratio = glm::log(s_lighting.far / s_lighting.near);
+  s_lighting.slice_scale = CLUSTER_GRID_Z / log_ratio;
+  s_lighting.slice_bias  = -(CLUSTER_GRID_Z * glm::log(s_lighting.near)) / log_ratio;
+
+  for(u32 z = 0; z < CLUSTER_GRID_Z; z++) {
+    ClusterSlice& slice = s_lighting.slices[z];
+    f32 depths[2]       = {get_slice_depth(z), get_slice_depth(z + 1)};
+
+    for(u32 y = 0; y < CLUSTER_GRID_Y; y++) {
+      for(u32 x = 0; x < CLUSTER_GRID_X; x++) {
+        glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+
+        // The 8 corners of the froxel
+        for(u32 i = 0; i < 8; i++) {
+          f32 ndc_x = -1.0f + 2.0f * (x + (i & 1)) / CLUSTER_GRID_X;
+          f32 ndc_y = -1.0f + 2.0f * (y + ((i >> 1) & 1)) / CLUSTER_GRID_Y;
+          f32 depth = depths[i >> 2];
+
+          glm::vec3 corner = glm::vec3(ndc_x * depth / projection[0][0], ndc_y * depth / projection[1][1], -depth);
+          min = glm::min(min, corner);
+          max = glm::max(max, corner);
+        }
+
+        u32 tile = y * CLUSTER_GRID_X + x;
+        slice.min_x[tile] = min.x; slice.min_y[tile] = min.y; slice.min_z[tile] = min.z;
+        slice.max_x[tile] = max.x; slice.max_y[tile] = max.y; slice.max_z[tile] = max.z;
+      }
+    }
+  }
+}
+
+static u32 get_slice(const f32 depth) {
+  f32 slice = glm::log(glm::max(depth, s_lighting.near)) * s_lighting.slice_scale + s_lighting.slice_bias;
+  return (u32)glm::clamp(slice, 0.0f, (f32)(CLUSTER_GRID_Z - 1));
+}
+
+static void assign_slice(const u32 z, void* user_data) {
+  const ClusterSlice& slice = s_lighting.slices[z];
+  std::vector<u32>* froxels = &s_lighting.froxel_lights[z * CLUSTER_TILES];
+
+  for(u32 i = 0; i < CLUSTER_TILES; i++) {
+    froxels[i].clear();
+  }
+
+  for(auto& light : s_lighting.view_lights) {
+    if(z < light.first_slice || z > light.last_slice) {
+      continue;
+    }
+
+#if LIGHTING_SSE
+    // The squared distance from the center of the light to four froxel boxes at a time
+    __m128 center_x = _mm_set1_ps(light.center.x);
+    __m128 center_y = _mm_set1_ps(light.center.y);
+    __m128 center_z = _mm_set1_ps(light.center.z);
+    __m128 radius2  = _mm_set1_ps(light.radius * light.radius);
+    __m128 zero     = _mm_setzero_ps();
+
+    for(u32 tile = 0; tile < CLUSTER_TILES; tile += 4) {
+      __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(slice.min_x + tile), center_x), zero), 
+                             _mm_max_ps(_mm_sub_ps(center_x, _mm_load_ps(slice.max_x + tile)), zero));
+      __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(slice.min_y + tile), center_y), zero), 
+                             _mm_max_ps(_mm_sub_ps(center_y, _mm_load_ps(slice.max_y + tile)), zero));
+      __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(slice.min_z + tile), center_z), zero), 
+                             _mm_max_ps(_mm_sub_ps(center_z, _mm_load_ps(slice.max_z + tile)), zero));
+
+      __m128 dist2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_add_ps(_mm_mul_ps(dy, dy), _mm_mul_ps(dz, dz)));
+      i32 mask     = _mm_movemask_ps(_mm_cmple_ps(dist2, radius2));
+
+      while(mask != 0) {
+        i32 bit = __builtin_ctz(mask);
+        froxels[tile + bit].push_back(light.index);
+        
+        mask &= mask - 1;
+      }
+    }
+#else
+    for(u32 tile = 0; tile < CLUSTER_TILES; tile++) {
+      glm::vec3 min = glm::vec3(slice.min_x[tile], slice.min_y[tile], slice.min_z[tile]);
+      glm::vec3 max = glm::vec3(slice.max_x[tile], slice.max_y[tile], slice.max_z[tile]);
+      glm::vec3 closest = glm::clamp(light.center, min, max);
+
+      glm::vec3 diff = closest - light.center;
+      if(glm::dot(diff, diff) <= (light.radius * light.radius)) {
+        froxels[tile].push_back(light.index);
+      }
+    }
+#endif
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool lighting_create() {
+  glGenBuffers(1, &s_lighting.lights_buffer);
+  glGenBuffers(1, &s_lighting.clusters_buffer);
+  glGenBuffers(1, &s_lighting.indices_buffer);
+
+  s_lighting.lights.reserve(MAX_POINT_LIGHTS);
+  s_lighting.clusters.resize(CLUSTERS_MAX);
+  s_lighting.projection = glm::mat4(0.0f);
+
+  return true;
+}
+
+void lighting_destroy() {
+  glDeleteBuffers(1, &s_lighting.lights_buffer);
+  glDeleteBuffers(1, &s_lighting.clusters_buffer);
+  glDeleteBuffers(1, &s_lighting.indices_buffer);
+  gl_state_reset();
+
+  s_lighting.lights.clear();
+  s_lighting.indices.clear();
+}
+
+void lighting_begin() {
+  s_lighting.lights.clear();
+}
+
+void lighting_add_point_light(const PointLight& light) {
+  if(s_lighting.lights.size() >= MAX_POINT_LIGHTS) {
+    return;
+  }
+
+  s_lighting.lights.push_back(light);
+}
+
+void lighting_assign(const glm::mat4& view, const glm::mat4& projection) {
+  auto start = std::chrono::steady_clock::now();
+
+  if(projection != s_lighting.projection) {
+    build_slices(projection);
+  }
+
+  // Only the lights that reach into the frustum's depth range are worth testing
+  s_lighting.view_lights.clear();
+  for(u32 i = 0; i < s_lighting.lights.size(); i++) {
+    const PointLight& light = s_lighting.lights[i];
+
+    glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+    f32 min_depth    = -center.z - light.radius;
+    f32 max_depth    = -center.z + light.radius;
+    if(max_depth < s_lighting.near || min_depth > s_lighting.far) {
+      continue;
+    }
+
+    s_lighting.view_lights.push_back(ViewLight{center, light.radius, get_slice(min_depth), get_slice(max_depth), i});
+  }
+
+  job_system_dispatch(CLUSTER_GRID_Z, assign_slice, nullptr);
+
+  // Pack the lists of all the froxels together
+  s_lighting.indices.clear();
+  for(u32 i = 0; i < CLUSTERS_MAX; i++) {
+    const std::vector<u32>& froxel = s_lighting.froxel_lights[i];
+
+    s_lighting.clusters[i] = glm::uvec2(s_lighting.indices.size(), froxel.size());
+    s_lighting.indices.insert(s_lighting.indices.end(), froxel.begin(), froxel.end());
+  }
+
+  s_lighting.stats.lights_count  = s_lighting.view_lights.size();
+  s_lighting.stats.indices_count = s_lighting.indices.size();
+  s_lighting.stats.assign_time   = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void lighting_update(const Camera* cam) {
+  lighting_assign(cam->view, cam->projection);
+
+  std::vector<GPULight> gpu_lights(s_lighting.lights.size());
+  for(u32 i = 0; i < s_lighting.lights.size(); i++) {
+    const PointLight& light = s_lighting.lights[i];
+    gpu_lights[i] = GPULight{glm::vec4(light.position, light.radius), glm::vec4(light.color, light.intensity)};
+  }
+
+  // NOTE: Empty buffers cannot be bound, so there is always at least one element
+  gl_state_bind_buffer(GL_SHADER_STORAGE_BUFFER, s_lighting.lights_buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPULight) * glm::max(gpu_lights.size(), (usizei)1), nullptr, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GPULight) * gpu_lights.size(), gpu_lights.data());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, s_lighting.lights_buffer);
+
+  gl_state_bind_buffer(GL_SHADER_STORAGE_BUFFER, s_lighting.clusters_buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::uvec2) * CLUSTERS_MAX, s_lighting.clusters.data(), GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, s_lighting.clusters_buffer);
+
+  gl_state_bind_buffer(GL_SHADER_STORAGE_BUFFER, s_lighting.indices_buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(u32) * glm::max(s_lighting.indices.size(), (usizei)1), nullptr, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(u32) * s_lighting.indices.size(), s_lighting.indices.data());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, s_lighting.indices_buffer);
+}
+
+const u32* lighting_get_cluster(const u32 x, const u32 y, const u32 z, u32* out_count) {
+  const glm::uvec2& cluster = s_lighting.clusters[(z * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x];
+  
+  *out_count = cluster.y;
+  return s_lighting.indices.data() + cluster.x;
+}
+
+const glm::vec4 lighting_get_cluster_params() {
+  return glm::vec4(s_lighting.near, s_lighting.far, s_lighting.slice_scale, s_lighting.slice_bias);
+}
+
+const u32 lighting_get_lights_count() {
+  return s_lighting.lights.size();
+}
+
+const LightingStats lighting_get_stats() {
+  return s_lighting.stats;
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "defines.h"
+#include "graphics/camera.h"
+
+#include <glm/glm.hpp>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define CLUSTER_GRID_X 16 // Needs to be a multiple of 4
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+
+#define MAX_POINT_LIGHTS 4096
+/////////////////////////////////////////////////////////////////////////////////
+
+// PointLight
+/////////////////////////////////////////////////////////////////////////////////
+struct PointLight {
+  glm::vec3 position; 
+  f32 radius; // Nothing past this distance gets lit by the light
+
+  glm::vec3 color; 
+  f32 intensity;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// LightingStats
+/////////////////////////////////////////////////////////////////////////////////
+struct LightingStats {
+  u32 lights_count;  // The lights within the depth range of the frustum
+  u32 indices_count; // The light indices across all the clusters
+  f64 assign_time;   // In milliseconds
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Clustered forward lighting. The view frustum is split into a grid of 'froxels' (tiles on the 
+ * screen, with exponential slices in depth), and every froxel gets a list of the lights that touch it. 
+ * Each fragment then only has to go through the lights of the froxel it falls into. 
+ *
+ * The lights get assigned on the CPU (one depth slice per job) and uploaded as:
+ *   - binding 1: the lights (position and radius, color and intensity)
+ *   - binding 2: the offset and count of every froxel into the light indices 
+ *   - binding 3: the light indices of all the froxels, packed together
+ */
+const bool lighting_create();
+void lighting_destroy();
+
+// Throw away the lights of the last frame
+void lighting_begin();
+
+// NOTE: Any lights past 'MAX_POINT_LIGHTS' in a frame get ignored.
+void lighting_add_point_light(const PointLight& light);
+
+// Assign the lights of this frame to the froxels of the camera and upload everything.
+void lighting_update(const Camera* cam);
+
+// Assign the lights to the froxels without uploading anything. Useful for benchmarks and testing.
+void lighting_assign(const glm::mat4& view, const glm::mat4& projection);
+
+// The lights of the given froxel from the last assignment
+const u32* lighting_get_cluster(const u32 x, const u32 y, const u32 z, u32* out_count);
+
+// The parameters the shaders need to find the froxel of a fragment: 
+// (near, far, slice scale, slice bias), where 'slice = log(depth) * scale + bias'.
+const glm::vec4 lighting_get_cluster_params();
+
+const u32 lighting_get_lights_count();
+const LightingStats lighting_get_stats();
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,486 @@
+#include "occlusion.h"
+#include "defines.h"
+#include "core/job_system.h"
+#include "resources/mesh.h"
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <mutex>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define PYRAMID_LEVELS_MAX 16
+#define BAND_HEIGHT        8 // Every job rasterizes a band of this many rows
+/////////////////////////////////////////////////////////////////////////////////
+
+// ScreenTriangle
+/////////////////////////////////////////////////////////////////////////////////
+// A triangle that is ready to be rasterized, where every edge and the depth 
+// are planes in the form of 'a * x + b * y + c' (in pixels).
+struct ScreenTriangle {
+  glm::vec3 edges[3];
+  glm::vec3 depth; 
+
+  i32 min_x, min_y, max_x, max_y;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Occluder
+/////////////////////////////////////////////////////////////////////////////////
+struct Occluder {
+  glm::mat4 model; 
+  const Mesh* mesh;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// DepthLevel
+/////////////////////////////////////////////////////////////////////////////////
+struct DepthLevel {
+  std::vector<f32> min_depth, max_depth;
+  u32 width, height;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Occlusion
+/////////////////////////////////////////////////////////////////////////////////
+struct Occlusion {
+  glm::mat4 view_projection;
+
+  std::vector<Occluder> occluders;
+  std::vector<std::vector<ScreenTriangle>> triangles; // Per occluder
+  std::vector<glm::ivec2> rows;                       // The first and last row every occluder covers
+  
+  DepthLevel levels[PYRAMID_LEVELS_MAX];
+  u32 levels_count;
+
+  std::mutex mutex;
+  std::atomic<bool> is_dirty; // Rasterization is lazy, so the first visibility test (on any thread) does it
+};
+
+static Occlusion s_occlusion;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+// Into pixels (with the depth going from 0 to 1)
+static glm::vec3 clip_to_screen(const glm::vec4& clip) {
+  glm::vec3 ndc = glm::vec3(clip) / clip.w;
+  return glm::vec3((ndc.x * 0.5f + 0.5f) * OCCLUSION_WIDTH, (ndc.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT, ndc.z * 0.5f + 0.5f);
+}
+
+static void setup_triangle(std::vector<ScreenTriangle>& triangles, const glm::vec3* screen) {
+  glm::vec3 v[3] = {screen[0], screen[1], screen[2]};
+
+  // Both sides of an occluder hide things, so the winding just gets flipped to counter-clockwise
+  f32 area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+  if(area == 0.0f) {
+    return;
+  }
+  else if(area < 0.0f) {
+    std::swap(v[1], v[2]);
+    area = -area;
+  }
+
+  ScreenTriangle tri;
+  tri.min_x = glm::max((i32)glm::floor(glm::min(v[0].x, glm::min(v[1].x, v[2].x))), 0);
+  tri.min_y = glm::max((i32)glm::floor(glm::min(v[0].y, glm::min(v[1].y, v[2].y))), 0);
+  tri.max_x = glm::min((i32)glm::ceil(glm::max(v[0].x, glm::max(v[1].x, v[2].x))), OCCLUSION_WIDTH - 1);
+  tri.max_y = glm::min((i32)glm::ceil(glm::max(v[0].y, glm::max(v[1].y, v[2].y))), OCCLUSION_HEIGHT - 1);
+  if(tri.min_x > tri.max_x || tri.min_y > tri.max_y) {
+    return;
+  }
+
+  // The edge opposite of each vertex, which is positive on the inside
+  for(u32 i = 0; i < 3; i++) {
+    const glm::vec3& a = v[(i + 1) % 3];
+    const glm::vec3& b = v[(i + 2) % 3];
+
+    f32 edge_a = -(b.y - a.y);
+    f32 edge_b = b.x - a.x;
+    tri.edges[i] = glm::vec3(edge_a, edge_b, -(edge_a * a.x + edge_b * a.y));
+  }
+
+  // The depth is a blend of the vertex depths by the (normalized) edge functions
+  tri.depth = glm::vec3(0.0f);
+  for(u32 i = 0; i < 3; i++) {
+    tri.depth += tri.edges[i] * (v[i].z / area);
+  }
+
+  triangles.push_back(tri);
+}
+
+static void clip_triangle(std::vector<ScreenTriangle>& triangles, const glm::vec4* clip) {
+  // Clip against the near plane (z = -w), which can turn the triangle into a quad
+  glm::vec4 polygon[4];
+  u32 count = 0;
+
+  for(u32 i = 0; i < 3; i++) {
+    const glm::vec4& a = clip[i];
+    const glm::vec4& b = clip[(i + 1) % 3];
+
+    f32 dist_a = a.z + a.w;
+    f32 dist_b = b.z + b.w;
+
+    if(dist_a >= 0.0f) {
+      polygon[count++] = a;
+    }
+    if((dist_a >= 0.0f) != (dist_b >= 0.0f)) {
+      polygon[count++] = a + (b - a) * (dist_a / (dist_a - dist_b));
+    }
+  }
+
+  for(u32 i = 2; i < count; i++) {
+    glm::vec3 tri[3] = {clip_to_screen(polygon[0]), clip_to_screen(polygon[i - 1]), clip_to_screen(polygon[i])};
+    setup_triangle(triangles, tri);
+  }
+}
+
+static void transform_occluder(const u32 index, void* user_data) {
+  const Occluder& occluder = s_occlusion.occluders[index];
+  std::vector<ScreenTriangle>& triangles = s_occlusion.triangles[index];
+
+  const Mesh* mesh = occluder.mesh;
+  glm::mat4 mvp    = s_occlusion.view_projection * occluder.model;
+
+  // Every vertex only gets transformed once, even though it is shared by a bunch of triangles
+  static thread_local std::vector<glm::vec4> clip_positions;
+  static thread_local std::vector<glm::vec3> screen_positions;
+  clip_positions.resize(mesh->vertices.size());
+  screen_positions.resize(mesh->vertices.size());
+  
+  for(u32 i = 0; i < mesh->vertices.size(); i++) {
+    clip_positions[i] = mvp * glm::vec4(mesh->vertices[i].position, 1.0f);
+
+    // Vertices behind the near plane only get used by the clipper
+    if((clip_positions[i].z + clip_positions[i].w) >= 0.0f) {
+      screen_positions[i] = clip_to_screen(clip_positions[i]);
+    }
+  }
+
+  // Without any indices, the vertices are just a triangle list
+  u32 index_count = mesh->indices.empty() ? mesh->vertices.size() : mesh->indices.size();
+
+  for(u32 i = 0; (i + 2) < index_count; i += 3) {
+    u32 vertices[3];
+    bool is_clipped = false;
+
+    for(u32 j = 0; j < 3; j++) {
+      vertices[j] = mesh->indices.empty() ? (i + j) : mesh->indices[i + j];
+      
+      const glm::vec4& clip = clip_positions[vertices[j]];
+      is_clipped |= (clip.z + clip.w) < 0.0f;
+    }
+
+    if(is_clipped) {
+      glm::vec4 clip[3] = {clip_positions[vertices[0]], clip_positions[vertices[1]], clip_positions[vertices[2]]};
+      clip_triangle(triangles, clip);
+    }
+    else {
+      glm::vec3 screen[3] = {screen_positions[vertices[0]], screen_positions[vertices[1]], screen_positions[vertices[2]]};
+      setup_triangle(triangles, screen);
+    }
+  }
+
+  // The rows the occluder covers, so the bands can skip it entirely
+  glm::ivec2& rows = s_occlusion.rows[index];
+  rows = glm::ivec2(OCCLUSION_HEIGHT, -1);
+  
+  for(auto& tri : triangles) {
+    rows.x = glm::min(rows.x, tri.min_y);
+    rows.y = glm::max(rows.y, tri.max_y);
+  }
+}
+
+static void rasterize_row(const ScreenTriangle& tri, const u32 y, f32* row) {
+  f32 py = y + 0.5f;
+
+#if OCCLUSION_SSE
+  // Four pixels at a time
+  __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+  __m128 zero    = _mm_setzero_ps();
+
+  __m128 edge_a[3], edge_row[3];
+  for(u32 i = 0; i < 3; i++) {
+    edge_a[i]   = _mm_set1_ps(tri.edges[i].x);
+    edge_row[i] = _mm_set1_ps(tri.edges[i].y * py + tri.edges[i].z);
+  }
+
+  __m128 depth_a   = _mm_set1_ps(tri.depth.x);
+  __m128 depth_row = _mm_set1_ps(tri.depth.y * py + tri.depth.z);
+
+  for(i32 x = tri.min_x & ~3; x <= tri.max_x; x += 4) {
+    __m128 px = _mm_add_ps(_mm_set1_ps((f32)x), offsets);
+    
+    __m128 e0 = _mm_add_ps(_mm_mul_ps(edge_a[0], px), edge_row[0]);
+    __m128 e1 = _mm_add_ps(_mm_mul_ps(edge_a[1], px), edge_row[1]);
+    __m128 e2 = _mm_add_ps(_mm_mul_ps(edge_a[2], px), edge_row[2]);
+
+    __m128 mask = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+    if(_mm_movemask_ps(mask) == 0) {
+      continue;
+    }
+
+    __m128 depth = _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row);
+    __m128 old   = _mm_loadu_ps(row + x);
+    __m128 next  = _mm_min_ps(old, depth);
+
+    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, next), _mm_andnot_ps(mask, old)));
+  }
+#else
+  for(i32 x = tri.min_x; x <= tri.max_x; x++) {
+    f32 px = x + 0.5f;
+
+    f32 e0 = tri.edges[0].x * px + tri.edges[0].y * py + tri.edges[0].z;
+    f32 e1 = tri.edges[1].x * px + tri.edges[1].y * py + tri.edges[1].z;
+    f32 e2 = tri.edges[2].x * px + tri.edges[2].y * py + tri.edges[2].z;
+    if(e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) {
+      continue;
+    }
+
+    row[x] = glm::min(row[x], tri.depth.x * px + tri.depth.y * py + tri.depth.z);
+  }
+#endif
+}
+
+static void rasterize_band(const u32 index, void* user_data) {
+  i32 band_min = index * BAND_HEIGHT;
+  i32 band_max = glm::min(band_min + BAND_HEIGHT, OCCLUSION_HEIGHT) - 1;
+
+  f32* depth = s_occlusion.levels[0].min_depth.data();
+
+  for(u32 i = 0; i < s_occlusion.occluders.size(); i++) {
+    const glm::ivec2& rows = s_occlusion.rows[i];
+    if(rows.y < band_min || rows.x > band_max) {
+      continue;
+    }
+
+    for(auto& tri : s_occlusion.triangles[i]) {
+      if(tri.max_y < band_min || tri.min_y > band_max) {
+        continue;
+      }
+
+      i32 min_y = glm::max(tri.min_y, band_min);
+      i32 max_y = glm::min(tri.max_y, band_max);
+      for(i32 y = min_y; y <= max_y; y++) {
+        rasterize_row(tri, y, depth + (y * OCCLUSION_WIDTH));
+      }
+    }
+  }
+}
+
+static void build_pyramid() {
+  DepthLevel& base = s_occlusion.levels[0];
+  base.max_depth   = base.min_depth;
+
+  for(u32 i = 1; i < s_occlusion.levels_count; i++) {
+    DepthLevel& prev  = s_occlusion.levels[i - 1];
+    DepthLevel& level = s_occlusion.levels[i];
+
+    for(u32 y = 0; y < level.height; y++) {
+      for(u32 x = 0; x < level.width; x++) {
+        f32 min_depth = 1.0f;
+        f32 max_depth = 0.0f;
+
+        // The 2x2 texels below (which might be cut off on odd sizes)
+        for(u32 child_y = y * 2; child_y < glm::min(y * 2 + 2, prev.height); child_y++) {
+          for(u32 child_x = x * 2; child_x < glm::min(x * 2 + 2, prev.width); child_x++) {
+            min_depth = glm::min(min_depth, prev.min_depth[child_y * prev.width + child_x]);
+            max_depth = glm::max(max_depth, prev.max_depth[child_y * prev.width + child_x]);
+          }
+        }
+
+        level.min_depth[y * level.width + x] = min_depth;
+        level.max_depth[y * level.width + x] = max_depth;
+      }
+    }
+  }
+}
+
+static bool test_region(const u32 level_index, const i32 min_x, const i32 min_y, const i32 max_x, const i32 max_y, const f32 depth) {
+  const DepthLevel& level = s_occlusion.levels[level_index];
+  
+  // The region in the texels of this level
+  i32 scale = 1 << level_index;
+  i32 start_x = min_x / scale, end_x = glm::min(max_x / scale, (i32)level.width - 1);
+  i32 start_y = min_y / scale, end_y = glm::min(max_y / scale, (i32)level.height - 1);
+
+  for(i32 y = start_y; y <= end_y; y++) {
+    for(i32 x = start_x; x <= end_x; x++) {
+      u32 texel = y * level.width + x;
+
+      // Everything here is in front of the box
+      if(level.max_depth[texel] < depth) {
+        continue;
+      }
+
+      // Something here is behind the box. Either the whole texel is, or a level down will tell.
+      if(level.min_depth[texel] >= depth || level_index == 0) {
+        return true;
+      }
+
+      i32 texel_min_x = glm::max(min_x, x * scale);
+      i32 texel_min_y = glm::max(min_y, y * scale);
+      i32 texel_max_x = glm::min(max_x, (x + 1) * scale - 1);
+      i32 texel_max_y = glm::min(max_y, (y + 1) * scale - 1);
+      if(test_region(level_index - 1, texel_min_x, texel_min_y, texel_max_x, texel_max_y, depth)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool occlusion_create() {
+  u32 width  = OCCLUSION_WIDTH;
+  u32 height = OCCLUSION_HEIGHT;
+
+  s_occlusion.levels_count = 0;
+  while(s_occlusion.levels_count < PYRAMID_LEVELS_MAX) {
+    DepthLevel& level = s_occlusion.levels[s_occlusion.levels_count++];
+    level.width  = width;
+    level.height = height;
+    level.min_depth.assign(width * height, 1.0f);
+    level.max_depth.assign(width * height, 1.0f);
+
+    if(width == 1 && height == 1) {
+      break;
+    }
+
+    width  = glm::max(width / 2, 1u);
+    height = glm::max(height / 2, 1u);
+  }
+
+  s_occlusion.is_dirty = false;
+  return true;
+}
+
+void occlusion_destroy() {
+  for(auto& level : s_occlusion.levels) {
+    level.min_depth.clear();
+    level.max_depth.clear();
+  }
+
+  s_occlusion.occluders.clear();
+  s_occlusion.triangles.clear();
+  s_occlusion.rows.clear();
+  s_occlusion.levels_count = 0;
+}
+
+void occlusion_begin(const glm::mat4& view_projection) {
+  s_occlusion.view_projection = view_projection;
+  s_occlusion.occluders.clear();
+  s_occlusion.is_dirty = false;
+}
+
+void occlusion_add_occluder(const glm::mat4& model, const Mesh* mesh) {
+  s_occlusion.occluders.push_back(Occluder{model, mesh});
+  s_occlusion.is_dirty = true;
+}
+
+void occlusion_rasterize() {
+  if(s_occlusion.levels_count == 0) {
+    s_occlusion.is_dirty = false;
+    return;
+  }
+
+  // Keep the memory of the triangles around from the frames before
+  if(s_occlusion.triangles.size() < s_occlusion.occluders.size()) {
+    s_occlusion.triangles.resize(s_occlusion.occluders.size());
+  }
+  s_occlusion.rows.resize(s_occlusion.occluders.size());
+  for(auto& triangles : s_occlusion.triangles) {
+    triangles.clear();
+  }
+
+  DepthLevel& base = s_occlusion.levels[0];
+  std::fill(base.min_depth.begin(), base.min_depth.end(), 1.0f);
+
+  // Every occluder gets transformed on its own, and then every band of rows gets rasterized on its own. 
+  // That way, no two jobs ever write to the same memory.
+  job_system_dispatch(s_occlusion.occluders.size(), transform_occluder, nullptr);
+  job_system_dispatch((OCCLUSION_HEIGHT + BAND_HEIGHT - 1) / BAND_HEIGHT, rasterize_band, nullptr);
+
+  build_pyramid();
+
+  // Only now is the pyramid ready to be tested against
+  s_occlusion.is_dirty = false;
+}
+
+const bool occlusion_is_visible(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model) {
+  if(s_occlusion.is_dirty) {
+    std::lock_guard<std::mutex> lock(s_occlusion.mutex);
+    
+    // Another thread might have gotten here first
+    if(s_occlusion.is_dirty) {
+      occlusion_rasterize();
+    }
+  }
+
+  if(s_occlusion.occluders.empty() || s_occlusion.levels_count == 0) {
+    return true;
+  }
+
+  // The screen rect and the closest depth of the box
+  glm::mat4 mvp = s_occlusion.view_projection * model;
+
+  glm::vec2 rect_min(FLT_MAX), rect_max(-FLT_MAX);
+  f32 depth = 1.0f;
+
+  for(u32 i = 0; i < 8; i++) {
+    glm::vec3 corner = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+    glm::vec4 clip   = mvp * glm::vec4(corner, 1.0f);
+    
+    if((clip.z + clip.w) <= 0.0f || clip.w <= 0.0f) {
+      return true;
+    }
+
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    rect_min = glm::min(rect_min, glm::vec2(ndc));
+    rect_max = glm::max(rect_max, glm::vec2(ndc));
+    depth    = glm::min(depth, ndc.z * 0.5f + 0.5f);
+  }
+
+  i32 min_x = glm::max((i32)glm::floor((rect_min.x * 0.5f + 0.5f) * OCCLUSION_WIDTH), 0);
+  i32 min_y = glm::max((i32)glm::floor((rect_min.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT), 0);
+  i32 max_x = glm::min((i32)glm::floor((rect_max.x * 0.5f + 0.5f) * OCCLUSION_WIDTH), OCCLUSION_WIDTH - 1);
+  i32 max_y = glm::min((i32)glm::floor((rect_max.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT), OCCLUSION_HEIGHT - 1);
+  
+  // Completely off the screen
+  if(min_x > max_x || min_y > max_y) {
+    return false;
+  }
+
+  // Start from the level where the rect covers about 2x2 texels and only go down where it is not clear
+  i32 size  = glm::max(max_x - min_x, max_y - min_y) + 1;
+  u32 level = 0;
+  while((level + 1) < s_occlusion.levels_count && (size >> level) > 2) {
+    level++;
+  }
+
+  return test_region(level, min_x, min_y, max_x, max_y, depth);
+}
+
+const f32* occlusion_get_depth(const u32 level, const bool max_depth, u32* out_width, u32* out_height) {
+  if(level >= s_occlusion.levels_count) {
+    return nullptr;
+  }
+
+  *out_width  = s_occlusion.levels[level].width;
+  *out_height = s_occlusion.levels[level].height;
+  
+  return max_depth ? s_occlusion.levels[level].max_depth.data() : s_occlusion.levels[level].min_depth.data();
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/mesh.h"
+
+#include <glm/glm.hpp>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define OCCLUSION_WIDTH  256 // Needs to be a multiple of 4 
+#define OCCLUSION_HEIGHT 128 
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A CPU-only occlusion culler. Every frame, the occluders (usually big meshes like walls and floors) 
+ * get rasterized into a low resolution depth buffer, which then gets turned into a pyramid
+ * of min/max depths. Any bounding box that is entirely behind the depth in the pyramid is hidden.
+ *
+ * The rasterization is spread over the job system (if it was initialized).
+ */
+const bool occlusion_create();
+void occlusion_destroy();
+
+// Throw away the occluders and depths of the last frame 
+void occlusion_begin(const glm::mat4& view_projection);
+
+// Add a mesh that hides whatever is behind it. 
+// NOTE: The mesh has to outlive the frame.
+void occlusion_add_occluder(const glm::mat4& model, const Mesh* mesh);
+
+// Rasterize all of the occluders added so far and build the depth pyramid. 
+// NOTE: This gets called by 'occlusion_is_visible' if any occluders were added since the last time. 
+// Call it before testing from many threads at once, since they would all wait on the first one.
+void occlusion_rasterize();
+
+// Returns 'false' if the box (in the local space of the model) is hidden behind the occluders. 
+// Boxes that cross the near plane are always visible.
+// NOTE: Safe to call from many threads at once, as long as no occluders are being added at the same time.
+const bool occlusion_is_visible(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model);
+
+// The depth buffer (at the given level of the pyramid) with 0 being the near plane and 1 the far plane. 
+// Useful for debugging or for testing.
+const f32* occlusion_get_depth(const u32 level, const bool max_depth, u32* out_width, u32* out_height);
+/////////////////////////////////////////////////////////////////////////////////
@@ -2,26 +2,46 @@
 #include "core/window.h"
 #include "defines.h"
 #include "graphics/camera.h"
+#include "graphics/gl_state.h"
+#include "graphics/geometry_pool.h"
+#include "graphics/instance_arena.h"
+#include "graphics/lighting.h"
+#include "graphics/occlusion.h"
 #include "graphics/shader.h"
 #include "math/vertex.h"
+#include "math/frustum.h"
 #include "resources/cubemap.h"
 #include "resources/material.h"
 #include "resources/mesh.h"
+#include "resources/meshlet.h"
 #include "resources/model.h"
+#include "resources/primitives.h"
 #include "math/transform.h"
 #include "resources/resource_manager.h"
 #include "resources/texture.h"
+#include "core/job_system.h"
+#include "utils/linear_allocator.h"
 
 #include <glad/gl.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
 
+#include <algorithm>
+#include <new>
 #include <string>
 #include <cstdio>
 #include <vector>
+#include <unordered_map>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define LOD_HYSTERESIS   0.15f // How far past a threshold the mesh has to go before switching levels
+#define LOD_PRUNE_FRAMES 256   // Transforms that were not seen for this long forget their level
+
+#define RENDER_LIST_BLOCK_SIZE (256 * 1024) // The size of the blocks of every thread's packet allocator
+/////////////////////////////////////////////////////////////////////////////////
 
 // ShaderType
 /////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +53,119 @@ enum ShaderType {
 };
 /////////////////////////////////////////////////////////////////////////////////
 
+// DrawCommand
+/////////////////////////////////////////////////////////////////////////////////
+// NOTE: This has to match the layout 'glMultiDrawElementsIndirect' expects
+struct DrawCommand {
+  u32 count, instance_count, first_index; 
+  i32 base_vertex; 
+  u32 base_instance;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// DrawData
+/////////////////////////////////////////////////////////////////////////////////
+// Per-draw data that lives in the draw buffer. The shader finds its data 
+// at 'gl_BaseInstance + gl_InstanceID'.
+struct DrawData {
+  glm::mat4 model;
+  glm::vec4 color;
+  glm::vec4 position_scale; // Undoes the scale of packed positions on the normals
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// DrawBatch
+/////////////////////////////////////////////////////////////////////////////////
+// Every draw of the same mesh (and level of detail) within a bucket. 
+// A batch becomes one instanced draw command.
+struct DrawBatch {
+  Mesh* mesh; 
+  u32 lod;
+
+  std::vector<DrawData> data;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// MeshletRun
+/////////////////////////////////////////////////////////////////////////////////
+// Neighbouring meshlets of a draw that survived culling. Since the meshlets 
+// are next to each other in the index buffer, the whole run is one draw command.
+struct MeshletRun {
+  Mesh* mesh;
+  u32 index_offset, index_count; // Relative to the first index of the mesh
+
+  u32 data_index; // Index into the 'meshlet_data' of the bucket
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// DrawBucket
+/////////////////////////////////////////////////////////////////////////////////
+// All the draws that share the same material. Every bucket gets submitted as one multi-draw call.
+struct DrawBucket {
+  Material* material;
+
+  std::vector<DrawBatch> batches;
+  std::unordered_map<const MeshLOD*, u32> batches_lookup; // Level of detail -> index into 'batches'
+
+  std::vector<MeshletRun> meshlet_runs;
+  std::vector<DrawData> meshlet_data;
+
+  u32 commands_count;
+  u32 short_count; // How many of the commands use 16-bit indices
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// LODEntry
+/////////////////////////////////////////////////////////////////////////////////
+// The last level of detail a mesh was drawn with at a specific transform
+struct LODEntry {
+  u32 level; 
+  u32 last_frame;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// RenderPacketType
+/////////////////////////////////////////////////////////////////////////////////
+enum RenderPacketType {
+  RENDER_PACKET_MESH, 
+  RENDER_PACKET_CUBE,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// RenderPacket
+/////////////////////////////////////////////////////////////////////////////////
+// A draw that was already culled and had its level of detail picked, waiting 
+// to be played back. Packets do not touch OpenGL, so they can be recorded on any thread.
+struct RenderPacket {
+  RenderPacketType type;
+
+  Mesh* mesh;
+  Material* material;
+  DrawData data;
+
+  u32 lod; 
+  u64 lod_key; // Where the level of detail gets stored on playback (0 if it is not kept)
+
+  // What the packets get sorted by. These come from the GL objects and the geometry pool rather 
+  // than the pointers, so the draw order does not change from one run to the next.
+  u64 material_key, mesh_key;
+
+  // The meshlets that survived culling. Only set if the mesh was culled meshlet by meshlet.
+  MeshletRun* runs; 
+  u32 runs_count;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// RenderList
+/////////////////////////////////////////////////////////////////////////////////
+// The packets recorded by one thread this frame. Everything lives in the thread's 
+// own allocator, so recording never has to lock anything.
+struct RenderList {
+  LinearAllocator allocator;
+  std::vector<RenderPacket*> packets;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
 // Renderer
 /////////////////////////////////////////////////////////////////////////////////
 struct Renderer {
@@ -40,9 +173,24 @@ struct Renderer {
   Shader* current_shader = nullptr;
 
   u32 ubo; // Uniform buffer
+  u32 indirect_buffer, draw_buffer; 
+  usizei commands_capacity = 0, draws_capacity = 0;
+
+  std::vector<RenderList> lists; // One per thread of the job system
+  std::vector<RenderPacket*> packets;
+
+  std::vector<DrawBucket> buckets;
+  std::vector<DrawCommand> commands;
+  std::vector<DrawData> draws;
   u32 instance_count = 0;
   glm::mat4* transforms = nullptr;
 
+  const Camera* camera = nullptr;
+  std::unordered_map<u64, LODEntry> lod_entries;
+  u32 frame = 0;
+
+  u32 target_fbo = 0, target_buffers[2]; // Only used by headless windows
+
   Mesh* cube_mesh = nullptr;
   Mesh* skybox_mesh = nullptr;
   Material* default_material = nullptr;
@@ -53,9 +201,31 @@ static Renderer renderer;
 
 // Private functions
 /////////////////////////////////////////////////////////////////////////////////
+static bool create_headless_target(const glm::vec2& size) {
+  glGenFramebuffers(1, &renderer.target_fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, renderer.target_fbo);
+
+  glGenRenderbuffers(2, renderer.target_buffers);
+  
+  glBindRenderbuffer(GL_RENDERBUFFER, renderer.target_buffers[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderer.target_buffers[0]);
+  
+  glBindRenderbuffer(GL_RENDERBUFFER, renderer.target_buffers[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderer.target_buffers[1]);
+
+  if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    printf("[ERROR]: The headless render target is incomplete\n");
+    return false;
+  }
+
+  return true;
+}
+
 bool gl_init() {
   // Loading GLAD
-  if(!gladLoadGL(glfwGetProcAddress)) {
+  if(!gladLoadGL(window_get_proc_address)) {
     printf("[ERROR]: Failed to initialize GLAD\n");
     return false;
   }
@@ -66,16 +236,24 @@ bool gl_init() {
   // Setting the GL viewport size
   glm::vec2 win_size = window_get_size();
   glViewport(0, 0, win_size.x, win_size.y);
+
+  // Without a display, everything gets drawn into an offscreen target that stays bound
+  if(window_is_headless() && !create_headless_target(win_size)) {
+    return false;
+  }
  
+  // Nothing is known about the state of the fresh context 
+  gl_state_reset();
+
   // Setting options
   glEnable(GL_STENCIL_TEST);
   glEnable(GL_MULTISAMPLE); 
   
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LEQUAL); // Need this to enable back to front rendering for 2D 
+  gl_state_set_depth_test(true);
+  gl_state_set_depth_func(GL_LEQUAL); // Need this to enable back to front rendering for 2D 
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  gl_state_set_blend(true);
+  gl_state_set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   return true;
 }
@@ -94,41 +272,130 @@ static void load_shaders() {
     "// Uniform block\n"
     "layout(std140, binding = 0) uniform matrices {\n"
     "  mat4 u_view_projection;\n"
+    "  mat4 u_view;\n"
+    "  uvec4 u_cluster_grid;   // The size of the grid and the number of lights\n"
+    "  vec4 u_cluster_params;  // Near, far, slice scale and slice bias\n"
+    "  vec4 u_viewport;\n"
+    "};\n"
+    "\n"
+    "// Per-draw data\n"
+    "struct DrawData {\n"
+    "  mat4 model;\n"
+    "  vec4 color;\n"
+    "  vec4 position_scale;\n"
+    "};\n"
+    "\n"
+    "layout(std430, binding = 0) readonly buffer draw_buffer {\n"
+    "  DrawData draws[];\n"
     "};\n"
     "\n"
     "// Outputs\n"
     "out VS_OUT {\n"
+    "  vec3 world_position;\n"
+    "  vec3 view_position;\n"
     "  vec3 normal;\n"
     "  vec2 texture_coords;\n"
+    "  vec4 color;\n"
     "} vs_out;\n"
     "\n"
-    "uniform mat4 u_model;\n"
-    "\n"
     "void main() {\n"
-    "  gl_Position = u_view_projection * u_model * vec4(aPos, 1.0f);\n"
-
-    "  vs_out.normal = aNormal;\n"
+    "  DrawData draw = draws[gl_BaseInstance + gl_InstanceID];\n"
+    "  vec4 world_pos = draw.model * vec4(aPos, 1.0f);\n"
+    "  gl_Position = u_view_projection * world_pos;\n"
+    "\n"
+    "  vs_out.world_position = world_pos.xyz;\n"
+    "  vs_out.view_position = (u_view * world_pos).xyz;\n"
+    "  vs_out.normal = transpose(inverse(mat3(draw.model))) * (aNormal * draw.position_scale.xyz);\n"
     "  vs_out.texture_coords = aTextureCoords;\n"
+    "  vs_out.color = draw.color;\n"
     "}\n"
     "\n"
     "@type fragment\n"
     "#version 460 core\n"
     "\n"
+    "#define AMBIENT 0.1f\n"
+    "\n"
     "// Inputs\n"
     "in VS_OUT {\n"
+    "  vec3 world_position;\n"
+    "  vec3 view_position;\n"
     "  vec3 normal;\n"
     "  vec2 texture_coords;\n"
+    "  vec4 color;\n"
     "} fs_in;\n"
     "\n"
     "// Outputs\n"
     "out vec4 frag_color;\n"
     "\n"
+    "// Uniform block\n"
+    "layout(std140, binding = 0) uniform matrices {\n"
+    "  mat4 u_view_projection;\n"
+    "  mat4 u_view;\n"
+    "  uvec4 u_cluster_grid;   // The size of the grid and the number of lights\n"
+    "  vec4 u_cluster_params;  // Near, far, slice scale and slice bias\n"
+    "  vec4 u_viewport;\n"
+    "};\n"
+    "\n"
+    "// Clustered lights\n"
+    "struct PointLight {\n"
+    "  vec4 position_radius;\n"
+    "  vec4 color_intensity;\n"
+    "};\n"
+    "\n"
+    "layout(std430, binding = 1) readonly buffer lights_buffer {\n"
+    "  PointLight lights[];\n"
+    "};\n"
+    "\n"
+    "layout(std430, binding = 2) readonly buffer clusters_buffer {\n"
+    "  uvec2 clusters[]; // Offset and count into the light indices\n"
+    "};\n"
+    "\n"
+    "layout(std430, binding = 3) readonly buffer light_indices_buffer {\n"
+    "  uint light_indices[];\n"
+    "};\n"
+    "\n"
     "// Uniforms\n"
-    "uniform vec4 u_color;\n"
     "uniform sampler2D u_diffuse, u_specular;\n"
     "\n"
+    "uint get_cluster() {\n"
+    "  float depth = -fs_in.view_position.z;\n"
+    "  uint slice = uint(max(log(depth) * u_cluster_params.z + u_cluster_params.w, 0.0f));\n"
+    "\n"
+    "  uvec2 tile = uvec2(((gl_FragCoord.xy - u_viewport.xy) / u_viewport.zw) * vec2(u_cluster_grid.xy));\n"
+    "  tile = min(tile, u_cluster_grid.xy - 1);\n"
+    "  slice = min(slice, u_cluster_grid.z - 1);\n"
+    "\n"
+    "  return (slice * u_cluster_grid.y + tile.y) * u_cluster_grid.x + tile.x;\n"
+    "}\n"
+    "\n"
     "void main() {\n"
-    "  frag_color = texture(u_diffuse, fs_in.texture_coords) * u_color;\n"
+    "  vec4 base_color = texture(u_diffuse, fs_in.texture_coords) * fs_in.color;\n"
+    "\n"
+    "  // Without any lights, everything is unlit\n"
+    "  if(u_cluster_grid.w == 0) {\n"
+    "    frag_color = base_color;\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  vec3 normal = normalize(fs_in.normal);\n"
+    "  vec3 light_color = vec3(AMBIENT);\n"
+    "\n"
+    "  uvec2 cluster = clusters[get_cluster()];\n"
+    "  for(uint i = 0; i < cluster.y; i++) {\n"
+    "    PointLight light = lights[light_indices[cluster.x + i]];\n"
+    "\n"
+    "    vec3 to_light = light.position_radius.xyz - fs_in.world_position;\n"
+    "    float dist = length(to_light);\n"
+    "\n"
+    "    // Falls off smoothly to zero at the radius of the light\n"
+    "    float window = clamp(1.0f - pow(dist / light.position_radius.w, 4.0f), 0.0f, 1.0f);\n"
+    "    float attenuation = (window * window) / (dist * dist + 1.0f);\n"
+    "    float diffuse = max(dot(normal, to_light / max(dist, 0.0001f)), 0.0f);\n"
+    "\n"
+    "    light_color += light.color_intensity.rgb * light.color_intensity.a * diffuse * attenuation;\n"
+    "  }\n"
+    "\n"
+    "  frag_color = vec4(base_color.rgb * light_color, base_color.a);\n"
     "}\n";
 
   std::string inst_code = 
@@ -193,11 +460,13 @@ static void load_shaders() {
     "  vec3 texture_coords;\n"
     "} vs_out;\n"
     "// Uniforms\n"
-    "uniform mat4 u_view, u_projection;"
+    "uniform mat4 u_view, u_projection;\n"
+    "uniform vec3 u_position_offset, u_position_scale; // For packed vertices\n"
     "\n"
     "void main() {\n"
-    " vs_out.texture_coords = aPos; // The local position of the cubemap is actually its texture coords\n"
-    " vec4 pos = u_projection * u_view * vec4(aPos, 1.0f);\n"
+    " vec3 local_pos = aPos * u_position_scale + u_position_offset;\n"
+    " vs_out.texture_coords = local_pos; // The local position of the cubemap is actually its texture coords\n"
+    " vec4 pos = u_projection * u_view * vec4(local_pos, 1.0f);\n"
     " gl_Position = pos.xyww;\n"
     "}\n"
     "\n"
@@ -271,29 +540,475 @@ static void build_skybox_mesh() {
 
   renderer.skybox_mesh = mesh_create(vertices, std::vector<u32>());
 }
+
+static u32 get_index_type(const bool short_indices) {
+  return short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+// The byte offset of the first index of the allocation within its index buffer
+static void* get_index_pointer(const GeometryAllocation& alloc) {
+  return (void*)((usizei)alloc.index_offset * (alloc.has_short_indices ? sizeof(u16) : sizeof(u32)));
+}
+
+static DrawBucket& get_bucket(Material* mat) {
+  for(auto& bucket : renderer.buckets) {
+    if(bucket.material == mat) {
+      return bucket;
+    }
+  }
+
+  renderer.buckets.push_back(DrawBucket{mat});
+  return renderer.buckets.back();
+}
+
+// NOTE: This only reads the level of the last frame, so it is safe to call from many threads. 
+// The new level gets stored under 'out_key' once the packet is played back.
+static u32 select_lod(const Transform& transform, Mesh* mesh, u64* out_key) {
+  if(mesh->lods_count == 1 || !renderer.camera) {
+    return 0;
+  }
+
+  // Bounding sphere of the AABB in world space
+  const glm::mat4& model = transform.transform;
+  f32 max_scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+  
+  glm::vec3 center = glm::vec3(model * glm::vec4((mesh->min + mesh->max) * 0.5f, 1.0f));
+  f32 radius       = glm::length(mesh->max - mesh->min) * 0.5f * max_scale;
+
+  // How much of the screen's height the sphere covers 
+  f32 distance    = glm::length(center - renderer.camera->position);
+  f32 screen_size = 1.0f;
+  if(distance > radius) {
+    screen_size = radius / (distance * glm::tan(glm::radians(renderer.camera->zoom) * 0.5f));
+  }
+
+  // Start from the level used last time and only move once the size is clearly past the threshold.
+  // Otherwise, a mesh that sits right at a threshold would keep popping between two levels.
+  // Every mesh has its own range of vertices in the pool, so the key never collides. 
+  // Transforms without an id do not get any of this.
+  u32 level = 0;
+  if(transform.id != 0) {
+    *out_key   = ((u64)transform.id << 32) | mesh->geometry.vertex_offset;
+    auto entry = renderer.lod_entries.find(*out_key);
+
+    if(entry != renderer.lod_entries.end()) {
+      level = glm::min(entry->second.level, mesh->lods_count - 1);
+    }
+  }
+
+  while(level + 1 < mesh->lods_count && screen_size < mesh->lods[level + 1].screen_size * (1.0f - LOD_HYSTERESIS)) {
+    level++;
+  }
+  while(level > 0 && screen_size > mesh->lods[level].screen_size * (1.0f + LOD_HYSTERESIS)) {
+    level--;
+  }
+
+  return level;
+}
+
+static RenderList& get_render_list() {
+  return renderer.lists[job_system_get_thread_index()];
+}
+
+static RenderPacket* alloc_packet(RenderList& list, const RenderPacket& packet) {
+  void* memory = linear_allocator_alloc(&list.allocator, sizeof(RenderPacket), alignof(RenderPacket));
+  
+  RenderPacket* result = new(memory) RenderPacket(packet);
+
+  Material* mat = packet.material;
+  if(mat) {
+    result->material_key = ((u64)(mat->shader ? mat->shader->id : 0) << 32) | (mat->diffuse_map ? mat->diffuse_map->id : 0);
+  }
+  
+  // Every mesh has its own range of vertices in the pool
+  result->mesh_key = ((u64)packet.mesh->geometry.vertex_offset << 32) | packet.lod;
+  list.packets.push_back(result);
+
+  return result;
+}
+
+static void record_meshlets(RenderList& list, RenderPacket* packet, const Transform& transform, const Frustum& frustum) {
+  Mesh* mesh = packet->mesh;
+
+  // The camera in the local space of the mesh
+  glm::vec3 camera_position = glm::vec3(glm::inverse(transform.transform) * glm::vec4(renderer.camera->position, 1.0f));
+
+  // A mirrored transform flips the winding, which would turn the cones inside out
+  bool is_mirrored = glm::determinant(glm::mat3(transform.transform)) < 0.0f;
+
+  // Enough room for the worst case, where every other meshlet gets culled
+  usizei max_runs = (mesh->meshlets.size() + 1) / 2;
+  packet->runs    = (MeshletRun*)linear_allocator_alloc(&list.allocator, sizeof(MeshletRun) * max_runs, alignof(MeshletRun));
+
+  bool is_run_open = false;
+  for(auto& meshlet : mesh->meshlets) {
+    bool is_visible = is_mirrored ? frustum_intersects_sphere(frustum, meshlet.center, meshlet.radius) 
+                                  : meshlet_is_visible(meshlet, frustum, camera_position);
+    if(!is_visible) {
+      is_run_open = false;
+      continue;
+    }
+
+    // Extend the current run if the meshlet comes right after it
+    if(is_run_open) {
+      packet->runs[packet->runs_count - 1].index_count += meshlet.index_count;
+      continue;
+    }
+
+    packet->runs[packet->runs_count++] = MeshletRun{mesh, meshlet.index_offset, meshlet.index_count, 0};
+    is_run_open = true;
+  }
+}
+
+static void record_draw(const Transform& transform, Mesh* mesh, Material* mat, const glm::vec4& color) {
+  if(mesh->geometry.index_count == 0) {
+    fprintf(stderr, "[WARNING]: Cannot render mesh. Can't find vertices or indices");
+    return;
+  }
+
+  // Cull the whole mesh first, in its local space
+  Frustum frustum;
+  if(renderer.camera) {
+    frustum_create(&frustum, renderer.camera->view_projection * transform.transform);
+    
+    glm::vec3 center = (mesh->min + mesh->max) * 0.5f;
+    if(!frustum_intersects_sphere(frustum, center, glm::length(mesh->max - mesh->min) * 0.5f)) {
+      return;
+    }
+
+    // Hidden behind the occluders of this frame
+    if(!occlusion_is_visible(mesh->min, mesh->max, transform.transform)) {
+      return;
+    }
+  }
+
+  RenderPacket packet = {};
+  packet.type         = RENDER_PACKET_MESH;
+  packet.mesh         = mesh;
+  packet.material     = mat;
+  packet.lod          = select_lod(transform, mesh, &packet.lod_key);
+
+  glm::mat4 model = geometry_pool_get_model(mesh->geometry, transform.transform);
+  packet.data     = DrawData{model, color, glm::vec4(mesh->geometry.position_scale, 0.0f)};
+
+  RenderList& list     = get_render_list();
+  RenderPacket* result = alloc_packet(list, packet);
+
+  // Up close, the full mesh gets culled meshlet by meshlet instead
+  if(packet.lod == 0 && mesh->meshlets.size() > 1 && renderer.camera) {
+    record_meshlets(list, result, transform, frustum);
+  }
+}
+
+static void flush_instances() {
+  if(renderer.instance_count == 0) {
+    return;
+  }
+
+  // Make sure the cube has enough room in the instance arena
+  Mesh* cube_mesh = renderer.cube_mesh;
+  if(!instance_arena_reserve(&cube_mesh->instances, renderer.instance_count)) {
+    renderer.instance_count = 0;
+    return;
+  }
+  
+  shader_bind(renderer.shaders[SHADER_INSTANCE]);
+
+  // Upload the transform matrices to the instance arena to be renderer 
+  instance_arena_upload(cube_mesh->instances, renderer.transforms, renderer.instance_count);
+
+  // Render all of the instances of the mesh
+  const GeometryAllocation& cube = cube_mesh->geometry;
+  gl_state_bind_vertex_array(geometry_pool_get_vao(cube.has_short_indices));
+  glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, 
+                                                cube.index_count, 
+                                                get_index_type(cube.has_short_indices), 
+                                                get_index_pointer(cube), 
+                                                renderer.instance_count, 
+                                                cube.vertex_offset, 
+                                                cube_mesh->instances.offset);
+  gl_state_count_draw();
+
+  // Clear the instances 
+  renderer.instance_count = 0; 
+}
+
+static void play_packet(const RenderPacket* packet) {
+  // Empty the instance buffer and refill it again once it is full
+  if(packet->type == RENDER_PACKET_CUBE) {
+    if(renderer.instance_count >= MAX_MESH_INSTANCES) {
+      flush_instances();
+    }
+
+    renderer.transforms[renderer.instance_count++] = packet->data.model;
+    return;
+  }
+
+  Mesh* mesh = packet->mesh;
+  if(packet->lod_key != 0) {
+    renderer.lod_entries[packet->lod_key] = LODEntry{packet->lod, renderer.frame};
+  }
+
+  DrawBucket& bucket = get_bucket(packet->material);
+
+  // Every run of the same draw points to the same data
+  if(packet->runs) {
+    if(packet->runs_count == 0) {
+      return;
+    }
+
+    u32 data_index = bucket.meshlet_data.size();
+    bucket.meshlet_data.push_back(packet->data);
+
+    for(u32 i = 0; i < packet->runs_count; i++) {
+      MeshletRun run = packet->runs[i];
+      run.data_index = data_index;
+
+      bucket.meshlet_runs.push_back(run);
+    }
+
+    return;
+  }
+
+  // Draws of the same mesh get grouped together so they can be instanced
+  auto batch = bucket.batches_lookup.find(&mesh->lods[packet->lod]);
+  if(batch == bucket.batches_lookup.end()) {
+    batch = bucket.batches_lookup.emplace(&mesh->lods[packet->lod], bucket.batches.size()).first;
+    bucket.batches.push_back(DrawBatch{mesh, packet->lod});
+  }
+
+  bucket.batches[batch->second].data.push_back(packet->data);
+}
+
+static void play_lists() {
+  // Merge the lists of every thread...
+  renderer.packets.clear();
+  for(auto& list : renderer.lists) {
+    renderer.packets.insert(renderer.packets.end(), list.packets.begin(), list.packets.end());
+  }
+
+  // ...and sort them so the draws of the same material and mesh end up next to each other. 
+  // The sort is stable, so the draws of one thread keep the order they were recorded in.
+  std::stable_sort(renderer.packets.begin(), renderer.packets.end(), [](const RenderPacket* a, const RenderPacket* b) {
+    if(a->material_key != b->material_key) {
+      return a->material_key < b->material_key;
+    }
+
+    return a->mesh_key < b->mesh_key;
+  });
+
+  for(auto& packet : renderer.packets) {
+    play_packet(packet);
+  }
+
+  for(auto& list : renderer.lists) {
+    list.packets.clear();
+    linear_allocator_reset(&list.allocator);
+  }
+}
+
+static void setup_render_lists() {
+  u32 threads_count = job_system_get_threads_count();
+  if(renderer.lists.size() >= threads_count) {
+    return;
+  }
+
+  u32 old_count = renderer.lists.size();
+  renderer.lists.resize(threads_count);
+
+  for(u32 i = old_count; i < threads_count; i++) {
+    linear_allocator_create(&renderer.lists[i].allocator, RENDER_LIST_BLOCK_SIZE);
+  }
+}
+
+static void flush_buckets() {
+  renderer.commands.clear();
+  renderer.draws.clear();
+
+  // Every batch turns into one instanced command. Its instances 
+  // find their data starting at the base instance. 
+  // NOTE: The commands of a bucket are split by index width (16-bit first, then 32-bit), 
+  // since every index width has its own index buffer and needs its own multi-draw call.
+  //
+  // The meshlet runs that survived culling come right after the batches. They are 
+  // not instanced, so every run of the same draw points to the same data.
+  for(auto& bucket : renderer.buckets) {
+    bucket.short_count    = 0;
+    bucket.commands_count = 0;
+
+    u32 meshlet_data_base = renderer.draws.size();
+    renderer.draws.insert(renderer.draws.end(), bucket.meshlet_data.begin(), bucket.meshlet_data.end());
+
+    for(u32 pass = 0; pass < 2; pass++) {
+      bool short_indices = (pass == 0);
+      u32 first_command  = renderer.commands.size();
+
+      for(auto& batch : bucket.batches) {
+        if(batch.mesh->geometry.has_short_indices != short_indices) {
+          continue;
+        }
+
+        const MeshLOD& lod = batch.mesh->lods[batch.lod];
+        renderer.commands.push_back(DrawCommand {
+          .count          = lod.index_count, 
+          .instance_count = (u32)batch.data.size(), 
+          .first_index    = lod.index_offset, 
+          .base_vertex    = (i32)batch.mesh->geometry.vertex_offset, 
+          .base_instance  = (u32)renderer.draws.size(),
+        });
+        renderer.draws.insert(renderer.draws.end(), batch.data.begin(), batch.data.end());
+      }
+
+      for(auto& run : bucket.meshlet_runs) {
+        if(run.mesh->geometry.has_short_indices != short_indices) {
+          continue;
+        }
+
+        renderer.commands.push_back(DrawCommand {
+          .count          = run.index_count, 
+          .instance_count = 1, 
+          .first_index    = run.mesh->lods[0].index_offset + run.index_offset, 
+          .base_vertex    = (i32)run.mesh->geometry.vertex_offset, 
+          .base_instance  = meshlet_data_base + run.data_index,
+        });
+      }
+
+      u32 count = renderer.commands.size() - first_command;
+      bucket.short_count    += short_indices ? count : 0;
+      bucket.commands_count += count;
+    }
+  }
+
+  if(renderer.commands.empty()) {
+    return;
+  }
+
+  // Grow the buffers if there are more commands or draws than they can hold 
+  usizei commands_count = renderer.commands.size();
+  if(commands_count > renderer.commands_capacity) {
+    renderer.commands_capacity = glm::max(commands_count, renderer.commands_capacity * 2);
+
+    gl_state_bind_buffer(GL_DRAW_INDIRECT_BUFFER, renderer.indirect_buffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawCommand) * renderer.commands_capacity, nullptr, GL_DYNAMIC_DRAW);
+  }
+    
+  usizei draws_count = renderer.draws.size();
+  if(draws_count > renderer.draws_capacity) {
+    renderer.draws_capacity = glm::max(draws_count, renderer.draws_capacity * 2);
+    
+    gl_state_bind_buffer(GL_SHADER_STORAGE_BUFFER, renderer.draw_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawData) * renderer.draws_capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, renderer.draw_buffer);
+  }
+
+  // Upload the commands and the per-draw data of every bucket at once
+  gl_state_bind_buffer(GL_DRAW_INDIRECT_BUFFER, renderer.indirect_buffer);
+  glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawCommand) * commands_count, renderer.commands.data());
+  
+  gl_state_bind_buffer(GL_SHADER_STORAGE_BUFFER, renderer.draw_buffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(DrawData) * draws_count, renderer.draws.data());
+
+  // One multi-draw call per material (and index width)
+  u32 offset = 0;
+  for(auto& bucket : renderer.buckets) {
+    if(bucket.commands_count == 0) {
+      continue;
+    }
+
+    material_use(bucket.material);
+
+    u32 counts[2] = {bucket.short_count, bucket.commands_count - bucket.short_count};
+    for(u32 pass = 0; pass < 2; pass++) {
+      if(counts[pass] == 0) {
+        continue;
+      }
+
+      bool short_indices = (pass == 0);
+      gl_state_bind_vertex_array(geometry_pool_get_vao(short_indices));
+      glMultiDrawElementsIndirect(GL_TRIANGLES, 
+                                  get_index_type(short_indices), 
+                                  (void*)(sizeof(DrawCommand) * offset), 
+                                  counts[pass], 
+                                  0);
+      gl_state_count_draw(counts[pass]);
+
+      offset += counts[pass];
+    }
+
+    bucket.batches.clear();
+    bucket.batches_lookup.clear();
+    bucket.meshlet_runs.clear();
+    bucket.meshlet_data.clear();
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+static void upload_lighting() {
+  lighting_update(renderer.camera);
+
+  // The fragments need the viewport to find their tile in the cluster grid
+  i32 viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+
+  glm::uvec4 grid     = glm::uvec4(CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, lighting_get_lights_count());
+  glm::vec4 params    = lighting_get_cluster_params();
+  glm::vec4 view_rect = glm::vec4(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  gl_state_bind_buffer(GL_UNIFORM_BUFFER, renderer.ubo);
+  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2, sizeof(glm::uvec4), glm::value_ptr(grid));
+  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2 + sizeof(glm::uvec4), sizeof(glm::vec4), glm::value_ptr(params));
+  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2 + sizeof(glm::vec4) * 2, sizeof(glm::vec4), glm::value_ptr(view_rect));
+}
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool renderer_create() {
+const bool renderer_create(const bool packed_vertices) {
   if(!gl_init()) {
     return false;
   }
 
   // Creating uniform buffer  
   glGenBuffers(1, &renderer.ubo);
-  glBindBuffer(GL_UNIFORM_BUFFER, renderer.ubo);
+  gl_state_bind_buffer(GL_UNIFORM_BUFFER, renderer.ubo);
   glBufferData(GL_UNIFORM_BUFFER, sizeof(f32) * 1024, nullptr, GL_DYNAMIC_DRAW);
   glBindBufferBase(GL_UNIFORM_BUFFER, 0, renderer.ubo);
 
+  // Creating the indirect and draw buffers. 
+  // They will get their storage once the first draws are flushed.
+  glGenBuffers(1, &renderer.indirect_buffer);
+  glGenBuffers(1, &renderer.draw_buffer);
+
+  // Every mesh will live in the geometry pool, so it has to be ready before any mesh is created
+  if(!geometry_pool_create(packed_vertices)) {
+    printf("[ERROR]: Failed to create the geometry pool\n");
+    return false;
+  }
+
+  if(!instance_arena_create()) {
+    printf("[ERROR]: Failed to create the instance arena\n");
+    return false;
+  }
+
+  if(!occlusion_create()) {
+    printf("[ERROR]: Failed to create the occlusion culler\n");
+    return false;
+  }
+
+  if(!lighting_create()) {
+    printf("[ERROR]: Failed to create the clustered lighting\n");
+    return false;
+  }
+
   // Load all the default shaders
   load_shaders();
 
   // Setting up the skybox mesh
   build_skybox_mesh();
 
-  // Creating the instance mesh
-  renderer.cube_mesh = mesh_create();
+  // Creating the shared primitives. The cube doubles as the instance mesh.
+  primitives_create();
+  renderer.cube_mesh = primitives_get(PRIMITIVE_CUBE);
 
   // Load the default material
   u32 pixels = 0xffffffff;
@@ -303,37 +1018,39 @@ const bool renderer_create() {
   // Allocate the transforms array
   renderer.transforms = new glm::mat4[MAX_MESH_INSTANCES];
 
+  // Every thread gets its own list to record into
+  setup_render_lists();
+
   // Cube Mesh model matrix layout 
-  glBindVertexArray(renderer.cube_mesh->vao); 
-  glBindBuffer(GL_ARRAY_BUFFER, renderer.cube_mesh->ibo);
-  
-  // 1st colomn
-  glEnableVertexAttribArray(3);
-  glVertexAttribPointer(3, 4, GL_FLOAT, false, sizeof(glm::mat4), 0);
-  glVertexAttribDivisor(3, 1); // Enabling instancing for the mesh
-  
-  // 2nd colomn
-  glEnableVertexAttribArray(4);
-  glVertexAttribPointer(4, 4, GL_FLOAT, false, sizeof(glm::mat4), (void*)(sizeof(f32) * 4));
-  glVertexAttribDivisor(4, 1);
-  
-  // 3rd colomn
-  glEnableVertexAttribArray(5);
-  glVertexAttribPointer(5, 4, GL_FLOAT, false, sizeof(glm::mat4), (void*)(sizeof(f32) * 8));
-  glVertexAttribDivisor(5, 1);
-  
-  // 4th colomn
-  glEnableVertexAttribArray(6);
-  glVertexAttribPointer(6, 4, GL_FLOAT, false, sizeof(glm::mat4), (void*)(sizeof(f32) * 12));
-  glVertexAttribDivisor(6, 1);
+  // NOTE: The cube lives in the geometry pool, so the instance attributes are part of the pool's vertex arrays.
+  instance_arena_setup_attributes(geometry_pool_get_vao(false), 3);
+  instance_arena_setup_attributes(geometry_pool_get_vao(true), 3);
 
   return true;
 }
 
 void renderer_destroy() {
   delete[] renderer.transforms;
+
+  for(auto& list : renderer.lists) {
+    linear_allocator_destroy(&list.allocator);
+  }
+  renderer.lists.clear();
  
-  mesh_destroy(renderer.cube_mesh);
+  primitives_destroy();
+  mesh_destroy(renderer.skybox_mesh);
+
+  glDeleteBuffers(1, &renderer.indirect_buffer);
+  glDeleteBuffers(1, &renderer.draw_buffer);
+
+  if(renderer.target_fbo != 0) {
+    glDeleteFramebuffers(1, &renderer.target_fbo);
+    glDeleteRenderbuffers(2, renderer.target_buffers);
+  }
+  occlusion_destroy();
+  lighting_destroy();
+  instance_arena_destroy();
+  geometry_pool_destroy();
 }
 
 void renderer_clear(const glm::vec4& color) {
@@ -343,67 +1060,93 @@ void renderer_clear(const glm::vec4& color) {
 
 void renderer_begin(const Camera* cam) {
   // Upload the view projection matrices through the uniform buffer 
-  glBindBuffer(GL_UNIFORM_BUFFER, renderer.ubo);
+  gl_state_bind_buffer(GL_UNIFORM_BUFFER, renderer.ubo);
   glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(cam->view_projection));
-}
+  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(cam->view));
 
-void renderer_end() {
-  shader_bind(renderer.shaders[SHADER_INSTANCE]);
+  // The camera is needed to pick the levels of detail
+  renderer.camera = cam;
+  renderer.frame++;
 
-  // Upload the transform matrices to the instance buffer to be renderer 
-  glBindBuffer(GL_ARRAY_BUFFER, renderer.cube_mesh->ibo); 
-  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::mat4) * renderer.instance_count, renderer.transforms);
+  occlusion_begin(cam->view_projection);
+  lighting_begin();
 
-  // Render all of the instances of the mesh
-  glBindVertexArray(renderer.cube_mesh->vao);
-  glDrawElementsInstanced(GL_TRIANGLES, renderer.cube_mesh->indices.size(), GL_UNSIGNED_INT, 0, renderer.instance_count);
+  // The job system might have gained threads since the last frame
+  setup_render_lists();
 
-  // Clear the instances 
-  renderer.instance_count = 0; 
+  // Forget about the transforms that are not drawn anymore
+  if((renderer.frame % LOD_PRUNE_FRAMES) == 0) {
+    std::erase_if(renderer.lod_entries, [](const auto& entry) {
+      return (renderer.frame - entry.second.last_frame) > LOD_PRUNE_FRAMES;
+    });
+  }
+}
+
+void renderer_end() {
+  // Assign the lights of the frame before anything gets drawn with them
+  if(renderer.camera) {
+    upload_lighting();
+  }
+
+  // Render all of the recorded draws
+  play_lists();
+  flush_buckets();
+  flush_instances();
 }
 
 void renderer_present() {
   window_swap_buffers();
+  gl_state_new_frame();
+}
+
+const u32 renderer_get_framebuffer() {
+  return renderer.target_fbo;
 }
 
 void render_mesh(const Transform& transform, Mesh* mesh, Material* mat) {
-  if(mat) {
-    material_use(mat); 
-    material_set_color(mat, mat->color);
-    material_set_model(mat, transform.transform);
+  if(!mat) {
+    mat = renderer.default_material;
   }
 
-  glBindVertexArray(mesh->vao);
-
-  if(mesh->indices.size() > 0) {
-    glDrawElements(GL_TRIANGLES, mesh->indices.size(), GL_UNSIGNED_INT, 0);
-  }
-  else if(mesh->vertices.size() > 0) {
-    glDrawArrays(GL_TRIANGLES, 0, mesh->vertices.size());
-  }
-  else {
-    fprintf(stderr, "[WARNING]: Cannot render mesh. Can't find vertices or indices");
-  }
+  record_draw(transform, mesh, mat, mat->color);
 }
 
 void render_mesh(const Transform& transform, Mesh* mesh, const glm::vec4& color) {
-  renderer.default_material->color = color;
-  render_mesh(transform, mesh, renderer.default_material);
+  record_draw(transform, mesh, renderer.default_material, color);
 }
 
-void render_cube(const glm::vec3& position, const glm::vec3& scale, const f32& rotation, const glm::vec4& color) {
-  // Empty the instance buffer and refill it again since we reached the max
-  if(renderer.instance_count >= MAX_MESH_INSTANCES) {
-    renderer_end();
-  }
+void render_occluder(const Transform& transform, Mesh* mesh) {
+  occlusion_add_occluder(transform.transform, mesh);
+}
+
+void renderer_rasterize_occluders() {
+  occlusion_rasterize();
+}
+
+void render_point_light(const PointLight& light) {
+  lighting_add_point_light(light);
+}
+
+void render_primitive(const Transform& transform, const PrimitiveType type, Material* mat) {
+  render_mesh(transform, primitives_get(type), mat);
+}
 
+void render_primitive(const Transform& transform, const PrimitiveType type, const glm::vec4& color) {
+  record_draw(transform, primitives_get(type), renderer.default_material, color);
+}
+
+void render_cube(const glm::vec3& position, const glm::vec3& scale, const f32& rotation, const glm::vec4& color) {
   glm::mat4 model(1.0f);
   model = glm::translate(model, position) * 
           glm::rotate(model, rotation, glm::vec3(1.0f)) *
           glm::scale(model, scale);
   
-  renderer.transforms[renderer.instance_count] = model;
-  renderer.instance_count++;
+  RenderPacket packet = {};
+  packet.type         = RENDER_PACKET_CUBE;
+  packet.mesh         = renderer.cube_mesh;
+  packet.data.model   = geometry_pool_get_model(renderer.cube_mesh->geometry, model);
+
+  alloc_packet(get_render_list(), packet);
 }
 
 void render_cube(const glm::vec3& position, const glm::vec3& scale, const glm::vec4& color) {
@@ -426,16 +1169,24 @@ void render_cubemap(CubeMap* cm, const Camera* cam) {
     return;
   }
 
-  glDepthMask(GL_FALSE);
+  gl_state_set_depth_mask(false);
 
   shader_bind(renderer.shaders[SHADER_CUBEMAP]);
   shader_upload_mat4(renderer.shaders[SHADER_CUBEMAP], "u_view", glm::mat4(glm::mat3(cam->view)));
   shader_upload_mat4(renderer.shaders[SHADER_CUBEMAP], "u_projection", cam->projection);
 
-  glBindVertexArray(renderer.skybox_mesh->vao); 
+  const GeometryAllocation& skybox = renderer.skybox_mesh->geometry;
+  shader_upload_vec3(renderer.shaders[SHADER_CUBEMAP], "u_position_offset", skybox.position_offset);
+  shader_upload_vec3(renderer.shaders[SHADER_CUBEMAP], "u_position_scale", skybox.position_scale);
+  gl_state_bind_vertex_array(geometry_pool_get_vao(skybox.has_short_indices)); 
   cubemap_use(cm);
-  glDrawArrays(GL_TRIANGLES, 0, renderer.skybox_mesh->vertices.size());
+  glDrawElementsBaseVertex(GL_TRIANGLES, 
+                           skybox.index_count, 
+                           get_index_type(skybox.has_short_indices), 
+                           get_index_pointer(skybox), 
+                           skybox.vertex_offset);
+  gl_state_count_draw();
 
-  glDepthMask(GL_TRUE);
+  gl_state_set_depth_mask(true);
 }
 /////////////////////////////////////////////////////////////////////////////////
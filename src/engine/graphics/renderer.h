@@ -1,18 +1,23 @@
 #pragma once
 
 #include "graphics/camera.h"
+#include "graphics/lighting.h"
 #include "resources/cubemap.h"
 #include "resources/material.h"
 #include "resources/mesh.h"
 #include "math/transform.h"
 #include "resources/model.h"
+#include "resources/primitives.h"
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool renderer_create();
+// NOTE: If 'packed_vertices' is set, every mesh is stored with the compressed 'Vertex3DPacked' layout.
+// NOTE: With a headless window, the renderer creates an offscreen framebuffer the size of the window 
+// and keeps it bound, so everything (2D included) gets drawn into it.
+const bool renderer_create(const bool packed_vertices = false);
 void renderer_destroy();
 
 void renderer_clear(const glm::vec4& color);
@@ -20,12 +25,50 @@ void renderer_begin(const Camera* cam);
 void renderer_end();
 void renderer_present();
 
+// The framebuffer everything ends up in. Either the window's own or the offscreen target of a headless window.
+const u32 renderer_get_framebuffer();
+
 // Render a mesh using the given material at the given transform
+// NOTE: Meshes are not drawn right away. They are bucketed by material and every bucket 
+// gets drawn with a single multi-draw call in 'renderer_end'. Draws of the same mesh within 
+// a bucket are instanced together. The shader of the material must read its model matrix 
+// and color from the per-draw buffer (at 'gl_BaseInstance + gl_InstanceID') like the default shader does.
+// NOTE: Meshes outside of the camera's frustum are skipped, and so are meshes hidden behind the 
+// occluders of the frame (see 'render_occluder'). Meshes with meshlets (see 'mesh_build_meshlets')
+// are culled meshlet by meshlet when drawn at full detail, and only the visible meshlets get drawn.
+// NOTE: 'render_mesh', 'render_primitive', 'render_cube', and 'render_model' never touch OpenGL. 
+// They record (and cull) their draws into a list of the calling thread, so they can be called 
+// from the jobs of the job system between 'renderer_begin' and 'renderer_end'. The lists of 
+// all threads are merged, sorted, and played back in 'renderer_end'.
 void render_mesh(const Transform& transform, Mesh* mesh, Material* mat);
 
 // Render the mesh using the default basic material
 void render_mesh(const Transform& transform, Mesh* mesh, const glm::vec4& color = glm::vec4(1.0f));
 
+// Use the mesh to hide anything behind it for the rest of the frame. This does NOT draw the mesh.
+// NOTE: Occluders should be big, simple meshes (walls, floors, big rocks) and have to be given 
+// before any of the meshes they are supposed to hide.
+// NOTE: Main thread only.
+void render_occluder(const Transform& transform, Mesh* mesh);
+
+// Rasterize the occluders given so far, so the draws after it can be tested against them. 
+// NOTE: Call this after the last 'render_occluder' and before dispatching any jobs that record draws. 
+// Otherwise, the first draw of the frame does it, and every other recording thread waits on it.
+// NOTE: Main thread only.
+void renderer_rasterize_occluders();
+
+// Light the meshes drawn with the default shader for this frame.
+// NOTE: The lights are gathered into clusters in 'renderer_end', so every fragment only goes 
+// through the lights near it. Without any lights, the default shader is unlit.
+// NOTE: Main thread only.
+void render_point_light(const PointLight& light);
+
+// Render one of the shared primitives using the given material at the given transform
+void render_primitive(const Transform& transform, const PrimitiveType type, Material* mat);
+
+// Render one of the shared primitives using the default basic material
+void render_primitive(const Transform& transform, const PrimitiveType type, const glm::vec4& color = glm::vec4(1.0f));
+
 // Render an instanced cube
 void render_cube(const glm::vec3& position, const glm::vec3& scale, const f32& rotation, const glm::vec4& color);
 void render_cube(const glm::vec3& position, const glm::vec3& scale, const glm::vec4& color);
@@ -35,5 +78,6 @@ void render_cube(const glm::vec3& position, const glm::vec3& scale, const glm::v
 void render_model(const Transform& transform, Model* model);
 
 // Render the given cubemap
+// NOTE: Unlike the other render functions, this draws right away. Main thread only.
 void render_cubemap(CubeMap* cm, const Camera* cam);
 /////////////////////////////////////////////////////////////////////////////////
@@ -1,18 +1,23 @@
 #include "renderer2d.h"
-#include "core/window.h"
+#include "core/render_thread.h"
 #include "defines.h"
 #include "math/vertex.h"
 #include "graphics/shader.h"
+#include "graphics/gl_state.h"
+#include "graphics/vertex_layout.h"
 
 #include "resources/texture.h"
 #include "resources/font.h"
+#include "utils/utils_utf8.h"
 
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glad/gl.h>
 
-#include <cstddef>
+#include <cstdio>
 #include <vector>
 #include <string>
 
@@ -22,6 +27,8 @@
 #define MAX_VERTICES  MAX_QUADS * 4
 #define MAX_INDICES   MAX_QUADS * 6
 #define MAX_TEXTURES  32 // @TODO: Probably should query the driver for the max textures instead of assuming
+#define MAX_SPRITES   16384 // Sprites per instanced draw
+#define SDF_EDGE      0.5f  // Where the edge of the glyphs is in the distance field of SDF fonts
 /////////////////////////////////////////////////////////////////////////////////
 
 // Renderer2d
@@ -30,13 +37,21 @@ struct Renderer2D {
   u32 vao, vbo, ebo;
 
   std::vector<Vertex2D> vertices;
+  std::vector<Vertex2DPacked> packed_vertices;
+  VertexFormat format;
   Texture* textures[MAX_TEXTURES];
   glm::vec4 quad_vertices[4];
 
+  u32 sprite_vao, sprite_vbo;
+  std::vector<SpriteInstance> sprites;
+
   Shader* batch_shader = nullptr;
+  Shader* sprite_shader = nullptr;
   Font* default_font = nullptr;
+  TextLayout text_layout; // For the text that is not drawn with its own layout
 
   usizei texture_index = 1;
+  usizei last_slot     = 0; // The slot of the last texture, since most draws in a row share the same one
   usizei indices_count = 0;
 
   glm::mat4 ortho;
@@ -48,6 +63,8 @@ static Renderer2D renderer;
 // Private functions
 /////////////////////////////////////////////////////////////////////////////////
 static void setup_buffers() {
+  const VertexLayout& layout = vertex_layout_get(renderer.format);
+
   // Gen buffers
   glGenVertexArrays(1, &renderer.vao);
   glGenBuffers(1, &renderer.vbo);
@@ -69,34 +86,36 @@ static void setup_buffers() {
   }
 
   // VAO
-  glBindVertexArray(renderer.vao);
+  gl_state_bind_vertex_array(renderer.vao);
 
   // VBO
-  glBindBuffer(GL_ARRAY_BUFFER, renderer.vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex2D) * MAX_VERTICES, nullptr, GL_DYNAMIC_DRAW);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, renderer.vbo);
+  glBufferData(GL_ARRAY_BUFFER, layout.stride * MAX_VERTICES, nullptr, GL_DYNAMIC_DRAW);
 
   // EBO 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer.ebo);
+  gl_state_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, renderer.ebo);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32) * MAX_INDICES, indices, GL_STATIC_DRAW);
 
   // Layout 
-  // Position 
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex2D), (void*)offsetof(Vertex2D, position));
-  
-  // Color 
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(Vertex2D), (void*)offsetof(Vertex2D, color));
-  
-  // Texture coords 
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex2D), (void*)offsetof(Vertex2D, texture_coords));
-  
-  // Texture index 
-  glEnableVertexAttribArray(3);
-  glVertexAttribPointer(3, 1, GL_FLOAT, false, sizeof(Vertex2D), (void*)offsetof(Vertex2D, texture_index));
+  vertex_layout_apply(layout);
+
+  gl_state_bind_vertex_array(0);
+}
+
+static void setup_sprite_buffers() {
+  const VertexLayout& layout = vertex_layout_get(VERTEX_FORMAT_SPRITE);
 
-  glBindVertexArray(0);
+  glGenVertexArrays(1, &renderer.sprite_vao);
+  glGenBuffers(1, &renderer.sprite_vbo);
+
+  gl_state_bind_vertex_array(renderer.sprite_vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, renderer.sprite_vbo);
+  glBufferData(GL_ARRAY_BUFFER, layout.stride * MAX_SPRITES, nullptr, GL_DYNAMIC_DRAW);
+
+  // Every attribute advances once per sprite. The corners come from 'gl_VertexID'.
+  vertex_layout_apply(layout);
+
+  gl_state_bind_vertex_array(0);
 }
 
 static void load_shaders() {
@@ -109,18 +128,21 @@ static void load_shaders() {
     "layout (location = 1) in vec4 aColor;\n"
     "layout (location = 2) in vec2 aTextureCoords;\n"
     "layout (location = 3) in float aTextureIndex;\n"
+    "layout (location = 4) in float aSDFEdge;\n"
     "\n"
     "// Outputs\n"
     "out VS_OUT {\n"
     "  vec4 out_color;\n"
     "  vec2 tex_coords;\n"
     "  float tex_index;\n"
+    "  float sdf_edge;\n"
     "} vs_out;\n"
     "\n"
     "void main() {\n"
     "  vs_out.out_color  = aColor;\n"
     "  vs_out.tex_coords = aTextureCoords;\n"
     "  vs_out.tex_index  = aTextureIndex;\n"
+    "  vs_out.sdf_edge   = aSDFEdge;\n"
     "\n"
     "  gl_Position = vec4(aPos, 1.0f);\n"
     "}\n"
@@ -136,6 +158,80 @@ static void load_shaders() {
     "  vec4 out_color;\n"
     "  vec2 tex_coords;\n"
     "  float tex_index;\n"
+    "  float sdf_edge;\n"
+    "} fs_in;\n"
+    "\n"
+    "// Uniforms\n"
+    "uniform sampler2D u_textures[32];\n"
+    "\n"
+    "void main() {\n"
+    "  int index   = int(fs_in.tex_index);\n"
+    "  vec4 texel  = texture(u_textures[index], fs_in.tex_coords);\n"
+    "  float width = fwidth(texel.a) * 0.5f; // About a pixel wide at any scale\n"
+    "\n"
+    "  // A distance field in the alpha, which gets turned into the coverage of the edge\n"
+    "  if(fs_in.sdf_edge > 0.0f) {\n"
+    "    texel.a = smoothstep(fs_in.sdf_edge - width, fs_in.sdf_edge + width, texel.a);\n"
+    "  }\n"
+    "\n"
+    "  frag_color = texel * fs_in.out_color;\n"
+    "}";
+
+  std::string sprite_code = 
+    "@type vertex\n"
+    "#version 460 core\n"
+    "\n"
+    "// Layouts\n"
+    "layout (location = 0) in vec2 aPosition;\n"
+    "layout (location = 1) in vec2 aSize;\n"
+    "layout (location = 2) in vec4 aUVRect;\n"
+    "layout (location = 3) in vec4 aColor;\n"
+    "layout (location = 4) in float aRotation;\n"
+    "layout (location = 5) in float aTextureIndex;\n"
+    "\n"
+    "// Outputs\n"
+    "out VS_OUT {\n"
+    "  vec4 out_color;\n"
+    "  vec2 tex_coords;\n"
+    "  float tex_index;\n"
+    "} vs_out;\n"
+    "\n"
+    "// Uniforms\n"
+    "uniform mat4 u_ortho;\n"
+    "\n"
+    "void main() {\n"
+    "  // The corners of a unit quad (drawn as a strip) around the center of the sprite\n"
+    "  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) - 0.5f;\n"
+    "\n"
+    "  vec2 local = corner * aSize;\n"
+    "\n"
+    "  // Most sprites are not rotated, so they can skip the trig\n"
+    "  if(aRotation > 0.0f) {\n"
+    "    float angle = aRotation * 6.28318530718f;\n"
+    "    float s     = sin(angle);\n"
+    "    float c     = cos(angle);\n"
+    "\n"
+    "    local = vec2((local.x * c) - (local.y * s), (local.x * s) + (local.y * c));\n"
+    "  }\n"
+    "\n"
+    "  vs_out.out_color  = aColor;\n"
+    "  vs_out.tex_coords = aUVRect.xy + (vec2(corner.x + 0.5f, 0.5f - corner.y) * aUVRect.zw);\n"
+    "  vs_out.tex_index  = aTextureIndex;\n"
+    "\n"
+    "  gl_Position = u_ortho * vec4(aPosition + local, 0.0f, 1.0f);\n"
+    "}\n"
+    "\n"
+    "@type fragment\n"
+    "#version 460 core\n"
+    "\n"
+    "// Outputs\n"
+    "out vec4 frag_color;\n"
+    "\n"
+    "// Inputs\n"
+    "in VS_OUT {\n"
+    "  vec4 out_color;\n"
+    "  vec2 tex_coords;\n"
+    "  float tex_index;\n"
     "} fs_in;\n"
     "\n"
     "// Uniforms\n"
@@ -147,7 +243,8 @@ static void load_shaders() {
     "}";
 
   // Shader init
-  renderer.batch_shader = shader_load("batch.glsl", batch_code);
+  renderer.batch_shader  = shader_load("batch.glsl", batch_code);
+  renderer.sprite_shader = shader_load("sprite.glsl", sprite_code);
 
   // Textures init
   u32 pixels = 0xffffffff;
@@ -158,13 +255,203 @@ static void load_shaders() {
   for(u32 i = 0; i < 32; i++)
     tex_slots[i] = i;
   shader_upload_int_arr(renderer.batch_shader, "u_textures", tex_slots, MAX_TEXTURES);
+
+  shader_bind(renderer.sprite_shader);
+  shader_upload_int_arr(renderer.sprite_shader, "u_textures", tex_slots, MAX_TEXTURES);
+}
+
+// Returns the slot of the texture for the next flush, adding it if it is not there yet
+static f32 get_texture_slot(Texture* texture) {
+  if(renderer.last_slot > 0 && renderer.last_slot < renderer.texture_index && texture->id == renderer.textures[renderer.last_slot]->id) {
+    return renderer.last_slot;
+  }
+
+  for(u32 i = 1; i < renderer.texture_index; i++) {
+    if(texture->id == renderer.textures[i]->id) {
+      renderer.last_slot = i;
+      return i;
+    }
+  }
+
+  renderer.textures[renderer.texture_index] = texture;
+  renderer.last_slot = renderer.texture_index;
+  return renderer.texture_index++;
+}
+
+static void make_quad(const Rect& dest, const glm::vec4& uv_rect, const glm::vec4& color, const f32 index, const f32 sdf_edge, Vertex2D* out_vertices) {
+  glm::mat4 model(1.0f);
+  model = glm::translate(model, glm::vec3(dest.x, dest.y, 0.0f));
+  model = glm::scale(model, glm::vec3(dest.width, dest.height, 0.0f));
+
+  // Top-left, top-right, bottom-right, bottom-left. The texture coords go from the bottom up.
+  glm::vec2 coords[4] = {
+    glm::vec2(uv_rect.x, uv_rect.y + uv_rect.w),
+    glm::vec2(uv_rect.x + uv_rect.z, uv_rect.y + uv_rect.w),
+    glm::vec2(uv_rect.x + uv_rect.z, uv_rect.y),
+    glm::vec2(uv_rect.x, uv_rect.y),
+  };
+
+  for(u32 i = 0; i < 4; i++) {
+    out_vertices[i].position       = renderer.ortho * model * renderer.quad_vertices[i];
+    out_vertices[i].color          = color;
+    out_vertices[i].texture_coords = coords[i];
+    out_vertices[i].texture_index  = index;
+    out_vertices[i].sdf_edge       = sdf_edge;
+  }
+}
+
+static void push_quad(const Rect& dest, const glm::vec4& uv_rect, const glm::vec4& color, const f32 index, const f32 sdf_edge = 0.0f) {
+  Vertex2D vertices[4];
+  make_quad(dest, uv_rect, color, index, sdf_edge, vertices);
+
+  renderer.vertices.insert(renderer.vertices.end(), vertices, vertices + 4);
+  renderer.indices_count += 6;
+}
+
+static void layout_text(TextLayout* layout) {
+  Font* font  = layout->font;
+  f32 off_x   = 0.0f;
+  f32 off_y   = 0.0f;
+  f32 scale   = layout->font_size / font->base_size;
+  f32 padding = font->glyph_padding * 2.0f;
+
+  layout->quads.clear();
+  layout->uv_rects.clear();
+  layout->glyphs.clear();
+
+  // Measured the same way as 'ui_text_measure_size' always did
+  glm::vec2 size(0.0f, font->base_size);
+  f32 line_width = 0.0f;
+
+  for(usizei i = 0; i < layout->text.size();) {
+    i32 ch = utf8_decode(layout->text, &i); 
+
+    if(ch == '\n') {
+      off_x = 0.0f;
+      off_y += font->ascent - font->descent + font->line_gap;
+
+      size.x     = glm::max(size.x, line_width);
+      size.y    += font->ascent - font->descent + font->line_gap;
+      line_width = 0.0f;
+      continue;
+    }
+
+    i32 index = font_get_glyph_index(font, ch);
+    const Glyph& glyph = font->glyphs[index];
+
+    line_width += glyph.advance_x != 0 ? glyph.advance_x : (glyph.width + glyph.x_offset);
+
+    // Nothing to draw (but it still takes up space)
+    if(ch == ' ' || ch == '\t' || !glyph.is_cached) {
+      off_x += glyph.advance_x + glyph.kern;
+      continue;
+    }
+
+    // Quads are placed by their center (see 'make_quad'), so the padding grows them evenly 
+    // on every side and the glyph itself stays where it was. No need to move them back by it.
+    glm::vec2 offset((off_x + glyph.x_offset) * scale, (off_y + glyph.y_offset) * scale);
+    layout->quads.push_back(Rect{offset.x, offset.y, (glyph.width + padding) * scale, (glyph.height + padding) * scale});
+    layout->uv_rects.push_back(glyph.region.uv_rect);
+    layout->glyphs.push_back(index);
+
+    off_x += glyph.advance_x + glyph.kern;
+  }
+
+  size.x       = glm::max(size.x, line_width);
+  layout->size = size * scale;
+
+  layout->has_vertices = false;
+}
+
+static void touch_glyphs(const TextLayout* layout) {
+  // Still in use, as far as the eviction of the glyphs goes
+  Font* font = layout->font;
+  font->use_count++;
+
+  for(auto& index : layout->glyphs) {
+    font->glyphs[index].last_use = font->use_count;
+  }
+}
+
+static void push_text(const TextLayout* layout, const glm::vec2& position, const glm::vec4& color, const f32 sdf_edge) {
+  if(layout->quads.empty()) {
+    return;
+  }
+
+  f32 edge = layout->font->is_sdf ? sdf_edge : 0.0f;
+
+  for(u32 i = 0; i < layout->quads.size(); i++) {
+    // Restart the renderer once the max quads is reached 
+    if(renderer.indices_count >= MAX_INDICES || renderer.texture_index >= MAX_TEXTURES) {
+      renderer2d_end();
+      renderer2d_begin();
+    }
+
+    Rect dest = layout->quads[i];
+    dest.x   += position.x;
+    dest.y   += position.y;
+
+    push_quad(dest, layout->uv_rects[i], color, get_texture_slot(layout->font->atlas->pages[0]), edge);
+  }
+}
+
+static void flush_batch() {
+  if(renderer.indices_count == 0) {
+    return;
+  }
+
+  shader_bind(renderer.batch_shader);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, renderer.vbo);
+
+  if(renderer.format == VERTEX_FORMAT_2D) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex2D) * renderer.vertices.size(), renderer.vertices.data());
+  }
+  else {
+    renderer.packed_vertices.resize(renderer.vertices.size());
+    for(u32 i = 0; i < renderer.vertices.size(); i++) {
+      renderer.packed_vertices[i] = vertex_pack(renderer.vertices[i]);
+    }
+
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex2DPacked) * renderer.packed_vertices.size(), renderer.packed_vertices.data());
+  }
+
+  renderer2d_flush();
+  renderer.vertices.clear();
+}
+
+static void flush_sprites() {
+  if(renderer.sprites.empty()) {
+    return;
+  }
+
+  shader_bind(renderer.sprite_shader);
+  shader_upload_mat4(renderer.sprite_shader, "u_ortho", renderer.ortho);
+
+  // Orphan the old storage so the driver does not have to wait for the last draw to finish with it
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, renderer.sprite_vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(SpriteInstance) * MAX_SPRITES, nullptr, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(SpriteInstance) * renderer.sprites.size(), renderer.sprites.data());
+
+  for(u32 i = 0; i < renderer.texture_index; i++) {
+    texture_use(renderer.textures[i], i);
+  }
+
+  gl_state_bind_vertex_array(renderer.sprite_vao);
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, renderer.sprites.size());
+  gl_state_count_draw();
+
+  renderer.texture_index = 1;
+  renderer.sprites.clear();
 }
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool renderer2d_create() {
+const bool renderer2d_create(const bool packed_vertices) {
+  renderer.format = packed_vertices ? VERTEX_FORMAT_2D_PACKED : VERTEX_FORMAT_2D;
   setup_buffers();
+  setup_sprite_buffers();
+  renderer.sprites.reserve(MAX_SPRITES);
 
   // Load the default batch shader
   load_shaders();
@@ -180,18 +467,26 @@ const bool renderer2d_create() {
 
 void renderer2d_destroy() {
   renderer.vertices.clear();
+  renderer.sprites.clear();
+
+  glDeleteVertexArrays(1, &renderer.sprite_vao);
+  glDeleteBuffers(1, &renderer.sprite_vbo);
+  gl_state_reset();
 
   shader_unload(renderer.batch_shader);
+  shader_unload(renderer.sprite_shader);
 }
 
 void renderer2d_flush() {
-  // Render all of the unique textures
+  // Render all of the unique textures. 
+  // Slots that still hold the same texture from the last flush will be skipped.
   for(u32 i = 0; i < renderer.texture_index; i++)
     texture_use(renderer.textures[i], i);
 
   // Initiate draw call!
-  glBindVertexArray(renderer.vao); 
+  gl_state_bind_vertex_array(renderer.vao); 
   glDrawElements(GL_TRIANGLES, renderer.indices_count, GL_UNSIGNED_INT, 0);
+  gl_state_count_draw();
 
   renderer.texture_index = 1;
   renderer.indices_count = 0;
@@ -201,15 +496,14 @@ void renderer2d_begin() {
   shader_bind(renderer.batch_shader);
   renderer.vertices.clear();
 
-  glm::vec2 window_size = window_get_size();
+  glm::vec2 window_size = render_thread_get_viewport_size();
   renderer.ortho = glm::ortho(0.0f, window_size.x, window_size.y, 0.0f);
 }
 
 void renderer2d_end() {
-  glBindBuffer(GL_ARRAY_BUFFER, renderer.vbo);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex2D) * renderer.vertices.size(), renderer.vertices.data());
-
-  renderer2d_flush();
+  // Only one of them can have anything in it at a time
+  flush_batch();
+  flush_sprites();
 }
 
 void renderer2d_set_default_font(Font* font) {
@@ -220,7 +514,27 @@ Font* renderer2d_get_default_font() {
   return renderer.default_font;
 }
 
+void renderer2d_set_clip(const glm::vec2& position, const glm::vec2& size) {
+  renderer2d_end();
+  renderer2d_begin();
+
+  // The scissor goes from the bottom up
+  glm::vec2 window_size = render_thread_get_viewport_size();
+  gl_state_set_scissor_test(true);
+  gl_state_set_scissor(position.x, window_size.y - (position.y + size.y), size.x, size.y);
+}
+
+void renderer2d_reset_clip() {
+  renderer2d_end();
+  renderer2d_begin();
+
+  gl_state_set_scissor_test(false);
+}
+
 void render_quad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color) {
+  // Any sprites before this quad have to be drawn first
+  flush_sprites();
+
   // Restart the renderer once the max quads is reached 
   if(renderer.indices_count >= MAX_INDICES) {
     renderer2d_end();
@@ -267,32 +581,17 @@ void render_quad(const glm::vec2& position, const glm::vec2& size, const glm::ve
 }
 
 void render_texture(Texture* texture, const Rect& src, const Rect& dest, const glm::vec4& tint, const bool flip) {
+  // Any sprites before this quad have to be drawn first
+  flush_sprites();
+
   // Restart the renderer once the max quads is reached 
   if(renderer.indices_count >= MAX_INDICES || renderer.texture_index >= MAX_TEXTURES) {
     renderer2d_end();
     renderer2d_begin();
   }
 
-  bool found = false;
-  f32 index = 1.0f;
-  
-  // Check to find if the texture already exists in the array
-  for(i32 i = 1; i < renderer.texture_index; i++) {
-    if(texture->id == renderer.textures[i]->id) {
-      found = true; 
-      index = i;
-
-      break;
-    }
-  }
-
   // Only add unique textures into the array
-  // If the texture is unique, add it to the array and 
-  // increament the amount of textures to render next flush
-  if(!found) {
-    renderer.textures[renderer.texture_index] = texture;
-    index = renderer.texture_index++;
-  }
+  f32 index = get_texture_slot(texture);
 
   glm::mat4 model(1.0f);
   model = glm::translate(model, glm::vec3(dest.x, dest.y, 0.0f));
@@ -346,40 +645,250 @@ void render_texture(Texture* texture, const glm::vec2& position, const glm::vec2
   render_texture(texture, src, dest, tint);
 }
 
-void render_text(const Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color) {
+void render_texture(const AtlasRegion& region, const Rect& dest, const glm::vec4& tint) {
+  // Any sprites before this quad have to be drawn first
+  flush_sprites();
+
+  // Restart the renderer once the max quads is reached 
+  if(renderer.indices_count >= MAX_INDICES || renderer.texture_index >= MAX_TEXTURES) {
+    renderer2d_end();
+    renderer2d_begin();
+  }
+
+  push_quad(dest, region.uv_rect, tint, get_texture_slot(region.page));
+}
+
+void render_sprite(Texture* texture, const glm::vec2& position, const glm::vec2& size, const f32 rotation, const glm::vec4& tint, const Rect& uv) {
+  // Any batched quads before this sprite have to be drawn first
+  flush_batch();
+
+  if(renderer.sprites.size() >= MAX_SPRITES || renderer.texture_index >= MAX_TEXTURES) {
+    flush_sprites();
+  }
+
+  SpriteInstance sprite;
+  sprite.position      = position;
+  sprite.size          = size;
+  sprite.uv_rect[0]    = (u16)(glm::clamp(uv.x, 0.0f, 1.0f) * 65535.0f);
+  sprite.uv_rect[1]    = (u16)(glm::clamp(uv.y, 0.0f, 1.0f) * 65535.0f);
+  sprite.uv_rect[2]    = (u16)(glm::clamp(uv.width, 0.0f, 1.0f) * 65535.0f);
+  sprite.uv_rect[3]    = (u16)(glm::clamp(uv.height, 0.0f, 1.0f) * 65535.0f);
+  sprite.color         = glm::packUnorm4x8(tint);
+  sprite.rotation      = 0;
+  sprite.texture_index = texture ? (u16)get_texture_slot(texture) : 0;
+
+  // Keep the rotation within a single turn before it gets quantized
+  if(rotation != 0.0f) {
+    f32 turns       = rotation / glm::two_pi<f32>();
+    sprite.rotation = (u16)((turns - glm::floor(turns)) * 65535.0f);
+  }
+
+  renderer.sprites.push_back(sprite);
+}
+
+void render_sprite(const AtlasRegion& region, const glm::vec2& position, const glm::vec2& size, const f32 rotation, const glm::vec4& tint) {
+  Rect uv = {region.uv_rect.x, region.uv_rect.y, region.uv_rect.z, region.uv_rect.w};
+  render_sprite(region.page, position, size, rotation, tint, uv);
+}
+
+void render_sprite(const glm::vec2& position, const glm::vec2& size, const f32 rotation, const glm::vec4& color) {
+  render_sprite(nullptr, position, size, rotation, color);
+}
+
+void render_text(Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color) {
+  render_text(font, size, text, position, color, TextStyle{});
+}
+
+void render_text(Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color, const TextStyle& style) {
   if(!font) {
     return; 
   }  
 
-  f32 off_x = 0.0f;
-  f32 off_y = 0.0f;
-  f32 scale = size / font->base_size;
+  TextLayout* layout = &renderer.text_layout;
+  text_layout_update(layout, font, size, text);
 
-  for(u32 i = 0; i < text.size(); i++) {
-    i8 ch = text[i]; 
-    i32 index = font_get_glyph_index(font, ch);
-    Glyph glyph = font->glyphs[index];
+  // Any sprites before this text have to be drawn first
+  flush_sprites();
 
-    if(ch == '\n') {
-      off_x = 0.0f;
-      off_y = font->ascent - font->descent + font->line_gap;
-      continue;
+  // The shadow and the outline go under the whole text, not just under their own glyph
+  if(style.shadow_offset != glm::vec2(0.0f)) {
+    push_text(layout, position + style.shadow_offset, style.shadow_color, SDF_EDGE);
+  }
+
+  if(style.outline_width > 0.0f && font->is_sdf) {
+    // The distance field changes by 0.5 over 'glyph_padding' pixels of the atlas
+    f32 scale = size / font->base_size;
+    f32 edge  = SDF_EDGE - ((style.outline_width / scale) * (SDF_EDGE / font->glyph_padding));
+
+    push_text(layout, position, style.outline_color, glm::max(edge, 1.0f / 255.0f));
+  }
+
+  push_text(layout, position, color, SDF_EDGE);
+}
+
+void render_text(TextLayout* layout, const glm::vec2& position, const glm::vec4& color) {
+  Font* font = layout->font;
+  if(!font) {
+    return;
+  }
+
+  // The glyphs got moved around in the atlas since
+  if(layout->atlas_generation != font->atlas_generation) {
+    text_layout_update(layout, font, layout->font_size, layout->text);
+  }
+
+  // Any sprites before this text have to be drawn first
+  flush_sprites();
+
+  if(layout->quads.empty()) {
+    return;
+  }
+
+  touch_glyphs(layout);
+
+  // Too big to ever go in one piece
+  usizei indices_count = layout->quads.size() * 6;
+  if(indices_count > MAX_INDICES) {
+    push_text(layout, position, color, SDF_EDGE);
+    return;
+  }
+
+  if((renderer.indices_count + indices_count) > MAX_INDICES || renderer.texture_index >= MAX_TEXTURES) {
+    renderer2d_end();
+    renderer2d_begin();
+  }
+
+  f32 index = get_texture_slot(font->atlas->pages[0]);
+
+  // Only make the vertices again if anything they depend on changed
+  glm::vec2 window_size = render_thread_get_viewport_size();
+  if(!layout->has_vertices || layout->position != position || layout->color != color || layout->window_size != window_size) {
+    f32 edge = font->is_sdf ? SDF_EDGE : 0.0f;
+
+    layout->vertices.resize(layout->quads.size() * 4);
+    for(u32 i = 0; i < layout->quads.size(); i++) {
+      Rect dest = layout->quads[i];
+      dest.x   += position.x;
+      dest.y   += position.y;
+
+      make_quad(dest, layout->uv_rects[i], color, index, edge, &layout->vertices[i * 4]);
     }
-    else if(ch == ' ' || ch == '\t') {
-      off_x += glyph.advance_x + glyph.kern;
-      continue;
+
+    layout->position      = position;
+    layout->color         = color;
+    layout->window_size   = window_size;
+    layout->texture_index = index;
+    layout->has_vertices  = true;
+  }
+  else if(layout->texture_index != index) {
+    for(auto& vertex : layout->vertices) {
+      vertex.texture_index = index;
     }
-   
-    glm::vec2 offset((off_x + glyph.x_offset) * scale, (off_y + glyph.y_offset) * scale);
-    Rect src = {0.0f, 0.0f, -(glyph.width * font->glyph_padding), -(glyph.height * font->glyph_padding)};
-    Rect dest = {position.x + offset.x, position.y + offset.y, glyph.width * scale, glyph.height * scale};
 
-    render_texture(glyph.texture, src, dest, color, true);
+    layout->texture_index = index;
+  }
 
-    off_x += glyph.advance_x + glyph.kern;
+  renderer.vertices.insert(renderer.vertices.end(), layout->vertices.begin(), layout->vertices.end());
+  renderer.indices_count += indices_count;
+}
+
+void quad_cache_push_quad(QuadCache* cache, const glm::vec2& position, const glm::vec2& size, const glm::vec4& color) {
+  usizei first = cache->vertices.size();
+  cache->vertices.resize(first + 4);
+
+  Rect dest = {position.x, position.y, size.x, size.y};
+  make_quad(dest, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), color, 0.0f, 0.0f, &cache->vertices[first]);
+}
+
+void quad_cache_push_text(QuadCache* cache, const TextLayout* layout, const glm::vec2& position, const glm::vec4& color) {
+  if(!layout->font || layout->quads.empty()) {
+    return;
+  }
+
+  Texture* page = layout->font->atlas->pages[0];
+  if(cache->texture && cache->texture != page) {
+    fprintf(stderr, "[ERROR]: Cannot add text with a different font to the same quad cache\n");
+    return;
+  }
+  cache->texture = page;
+
+  usizei first = cache->vertices.size();
+  cache->vertices.resize(first + (layout->quads.size() * 4));
+
+  f32 edge = layout->font->is_sdf ? SDF_EDGE : 0.0f;
+  for(u32 i = 0; i < layout->quads.size(); i++) {
+    Rect dest = layout->quads[i];
+    dest.x   += position.x;
+    dest.y   += position.y;
+
+    make_quad(dest, layout->uv_rects[i], color, cache->texture_index, edge, &cache->vertices[first + (i * 4)]);
   }
 }
 
+void render_quad_cache(QuadCache* cache) {
+  // Any sprites before the quads have to be drawn first
+  flush_sprites();
+
+  usizei quads_count = cache->vertices.size() / 4;
+  for(usizei first = 0; first < quads_count;) {
+    // Restart the renderer once the max quads is reached 
+    if(renderer.indices_count >= MAX_INDICES || renderer.texture_index >= MAX_TEXTURES) {
+      renderer2d_end();
+      renderer2d_begin();
+    }
+
+    // The texture could be in a different slot than the last time
+    if(cache->texture) {
+      f32 index = get_texture_slot(cache->texture);
+
+      if(index != cache->texture_index) {
+        for(auto& vertex : cache->vertices) {
+          vertex.texture_index = (vertex.texture_index == cache->texture_index) ? index : vertex.texture_index;
+        }
+
+        cache->texture_index = index;
+      }
+    }
+
+    usizei count = glm::min(quads_count - first, (MAX_INDICES - renderer.indices_count) / 6);
+    renderer.vertices.insert(renderer.vertices.end(), cache->vertices.begin() + (first * 4), cache->vertices.begin() + ((first + count) * 4));
+    renderer.indices_count += count * 6;
+
+    first += count;
+  }
+}
+
+void text_layout_update(TextLayout* layout, Font* font, const f32 size, const std::string& text) {
+  if(!font) {
+    return;
+  }
+
+  bool is_same = layout->font == font && 
+                 layout->font_size == size && 
+                 layout->text == text && 
+                 layout->atlas_generation == font->atlas_generation;
+  if(is_same) {
+    touch_glyphs(layout);
+    return;
+  }
+
+  // Glyphs that are drawn for the first time have to be added to the font's atlas, which
+  // might move the others around. Anything that was batched with the atlas goes out first.
+  if(!font_is_text_cached(font, text)) {
+    renderer2d_end();
+    renderer2d_begin();
+
+    font_cache_text(font, text);
+  }
+
+  layout->font             = font;
+  layout->font_size        = size;
+  layout->text             = text;
+  layout->atlas_generation = font->atlas_generation;
+
+  layout_text(layout);
+}
+
 void render_text(const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color) {
   render_text(renderer.default_font, size, text, position, color);
 }
@@ -3,12 +3,15 @@
 #include "defines.h"
 
 #include "resources/texture.h"
+#include "resources/texture_atlas.h"
 #include "resources/font.h"
+#include "math/vertex.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
 #include <string>
+#include <vector>
 
 // Rect
 /////////////////////////////////////////////////////////////////////////////////
@@ -17,9 +20,73 @@ struct Rect {
 };
 /////////////////////////////////////////////////////////////////////////////////
 
+// TextStyle
+/////////////////////////////////////////////////////////////////////////////////
+struct TextStyle {
+  // Only drawn with SDF fonts
+  glm::vec4 outline_color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  f32 outline_width       = 0.0f; // In pixels. No outline if 0.
+
+  glm::vec4 shadow_color  = glm::vec4(0.0f, 0.0f, 0.0f, 0.5f);
+  glm::vec2 shadow_offset = glm::vec2(0.0f); // In pixels. No shadow if 0.
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// TextLayout
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Text that was laid out once and kept around, so text that does not change does not have
+ * to look up its glyphs and work out where they go every frame. The vertices of the last
+ * position and color are kept as well, so drawing the same text in the same place again
+ * only copies them into the batch.
+ *
+ * NOTE: The layout is made again whenever the font, size, or text change, and when the 
+ * glyphs get moved around in the font's atlas.
+ */
+struct TextLayout {
+  // What the glyphs were laid out for
+  Font* font = nullptr;
+  f32 font_size;
+  std::string text;
+  u32 atlas_generation;
+
+  // Relative to the position of the text
+  std::vector<Rect> quads;
+  std::vector<glm::vec4> uv_rects;
+  std::vector<i32> glyphs;
+
+  glm::vec2 size; // The size of the text as 'ui_text_measure_size' measures it
+
+  // What the vertices were made for
+  glm::vec2 position, window_size;
+  glm::vec4 color;
+  f32 texture_index;
+
+  std::vector<Vertex2D> vertices;
+  bool has_vertices = false;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// QuadCache
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Quads that are made once and then copied into the batch as they are every frame, for
+ * geometry that rarely changes (like the UI). Every quad either samples nothing or 'texture'.
+ *
+ * NOTE: The quads are made for the current window size, so they have to be made again once it changes.
+ */
+struct QuadCache {
+  std::vector<Vertex2D> vertices;
+
+  Texture* texture   = nullptr;
+  f32 texture_index  = 1.0f; // The slot of 'texture' the vertices point to
+};
+/////////////////////////////////////////////////////////////////////////////////
+
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-const bool renderer2d_create();
+// NOTE: If 'packed_vertices' is set, the vertices are uploaded with the compressed 'Vertex2DPacked' layout.
+const bool renderer2d_create(const bool packed_vertices = false);
 void renderer2d_destroy();
 void renderer2d_flush();
 void renderer2d_begin();
@@ -32,15 +99,63 @@ void renderer2d_set_default_font(Font* font);
 // NOTE: Will return a 'nullptr' if the default font is not set.
 Font* renderer2d_get_default_font();
 
+// Only draw what comes after within the rectangle (in window coordinates) until the clip is reset.
+// NOTE: Both of these functions draw whatever was batched before them.
+void renderer2d_set_clip(const glm::vec2& position, const glm::vec2& size);
+void renderer2d_reset_clip();
+
 // Render geometry functions
 void render_quad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
 
 // Render texture functions
-void render_texture(Texture* texture, const Rect& src, const Rect& dest, const glm::vec4& tint = glm::vec4(1.0f));
+// NOTE: If 'flip' is set, the texture is flipped vertically (the glyphs of a font, for example).
+void render_texture(Texture* texture, const Rect& src, const Rect& dest, const glm::vec4& tint = glm::vec4(1.0f), const bool flip = false);
 void render_texture(Texture* texture, const glm::vec2& position, const glm::vec2& size, const glm::vec4& tint = glm::vec4(1.0f));
 
-// Renders the text with the given font.
-void render_text(const Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color);
+// Render a texture that was added to an atlas. Everything from the same atlas page shares a single slot, 
+// so any number of them can be drawn without breaking the batch.
+void render_texture(const AtlasRegion& region, const Rect& dest, const glm::vec4& tint = glm::vec4(1.0f));
+
+// Render sprite functions
+// Sprites go through an instanced path where every sprite is a single compact instance, and the 
+// corners are worked out on the GPU. Much cheaper than 'render_texture' when drawing lots of them.
+// NOTE: The position is the center of the sprite and the rotation (in radians) goes around it.
+// NOTE: The UV rect is the part of the texture to draw, in normalized coords within [0, 1].
+// NOTE: Sprites and the other render functions can be mixed freely. Switching between the two 
+// just ends the current draw, so long runs of either are best.
+void render_sprite(Texture* texture, const glm::vec2& position, const glm::vec2& size, const f32 rotation = 0.0f, 
+                   const glm::vec4& tint = glm::vec4(1.0f), const Rect& uv = Rect{0.0f, 0.0f, 1.0f, 1.0f});
+
+// Render a sprite from an atlas (see 'render_texture' above)
+void render_sprite(const AtlasRegion& region, const glm::vec2& position, const glm::vec2& size, const f32 rotation = 0.0f, 
+                   const glm::vec4& tint = glm::vec4(1.0f));
+
+// Render an untextured sprite
+void render_sprite(const glm::vec2& position, const glm::vec2& size, const f32 rotation, const glm::vec4& color);
+
+// Renders the UTF-8 text with the given font.
+// NOTE: Glyphs that were not drawn before get added to the font's atlas, which ends the current batch.
+void render_text(Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color);
+
+// Renders the text with an outline and/or a shadow under it. They go into the same batch as the text.
+void render_text(Font* font, const f32 size, const std::string& text, const glm::vec2& position, const glm::vec4& color, const TextStyle& style);
+
+// Renders the text of the layout (see 'text_layout_update').
+void render_text(TextLayout* layout, const glm::vec2& position, const glm::vec4& color);
+
+// Add a quad (the same as 'render_quad') to the cache instead of the batch.
+void quad_cache_push_quad(QuadCache* cache, const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+
+// Add the text of the layout to the cache instead of the batch.
+// NOTE: Every text in the same cache must use the same font.
+void quad_cache_push_text(QuadCache* cache, const TextLayout* layout, const glm::vec2& position, const glm::vec4& color);
+
+// Copy every quad of the cache into the batch.
+void render_quad_cache(QuadCache* cache);
+
+// Lay the text out again, but only if any of the font, size, or text changed since the last time.
+// NOTE: Glyphs that were not drawn before get added to the font's atlas, which ends the current batch.
+void text_layout_update(TextLayout* layout, Font* font, const f32 size, const std::string& text);
 
 // Renders the text with the default font. 
 // NOTE: The default font MUST be set with the 'renderer2d_set_default_font' function at the 
@@ -1,5 +1,6 @@
 #include "shader.h"
 #include "defines.h"
+#include "graphics/gl_state.h"
 #include "utils/utils_file.h"
 
 #include <cstring>
@@ -120,13 +121,15 @@ void shader_unload(Shader* shader) {
   }
 
   glDeleteProgram(shader->id);
+  gl_state_reset(); // The id might get reused by a new program
+
   delete shader;
 
   shader = nullptr;
 }
 
 void shader_bind(Shader* shader) {
-  glUseProgram(shader->id);
+  gl_state_use_program(shader->id);
 }
 
 void shader_upload_int(Shader* shader, const std::string& name, const i32 value) {
@@ -0,0 +1,107 @@
+#include "vertex_layout.h"
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <glad/gl.h>
+
+#include <cstddef>
+
+// Layouts
+/////////////////////////////////////////////////////////////////////////////////
+static const VertexAttribute VERTEX3D_ATTRIBUTES[] = {
+  {0, 3, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex3D, position)},
+  {1, 3, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex3D, normal)},
+  {2, 2, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex3D, texture_coords)},
+};
+
+static const VertexAttribute VERTEX3D_PACKED_ATTRIBUTES[] = {
+  {0, 3, VERTEX_ATTRIBUTE_UNORM16,          offsetof(Vertex3DPacked, position)},
+  {1, 4, VERTEX_ATTRIBUTE_SNORM_10_10_10_2, offsetof(Vertex3DPacked, normal)},
+  {2, 2, VERTEX_ATTRIBUTE_HALF_FLOAT,       offsetof(Vertex3DPacked, texture_coords)},
+};
+
+static const VertexAttribute VERTEX2D_ATTRIBUTES[] = {
+  {0, 3, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex2D, position)},
+  {1, 4, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex2D, color)},
+  {2, 2, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex2D, texture_coords)},
+  {3, 1, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex2D, texture_index)},
+  {4, 1, VERTEX_ATTRIBUTE_FLOAT, offsetof(Vertex2D, sdf_edge)},
+};
+
+static const VertexAttribute VERTEX2D_PACKED_ATTRIBUTES[] = {
+  {0, 2, VERTEX_ATTRIBUTE_FLOAT,   offsetof(Vertex2DPacked, position)},
+  {1, 4, VERTEX_ATTRIBUTE_UNORM8,  offsetof(Vertex2DPacked, color)},
+  {2, 2, VERTEX_ATTRIBUTE_UNORM16, offsetof(Vertex2DPacked, texture_coords)},
+  {3, 1, VERTEX_ATTRIBUTE_UBYTE,   offsetof(Vertex2DPacked, texture_index)},
+  {4, 1, VERTEX_ATTRIBUTE_UNORM8,  offsetof(Vertex2DPacked, sdf_edge)},
+};
+
+static const VertexAttribute SPRITE_ATTRIBUTES[] = {
+  {0, 2, VERTEX_ATTRIBUTE_FLOAT,   offsetof(SpriteInstance, position)},
+  {1, 2, VERTEX_ATTRIBUTE_FLOAT,   offsetof(SpriteInstance, size)},
+  {2, 4, VERTEX_ATTRIBUTE_UNORM16, offsetof(SpriteInstance, uv_rect)},
+  {3, 4, VERTEX_ATTRIBUTE_UNORM8,  offsetof(SpriteInstance, color)},
+  {4, 1, VERTEX_ATTRIBUTE_UNORM16, offsetof(SpriteInstance, rotation)},
+  {5, 1, VERTEX_ATTRIBUTE_USHORT,  offsetof(SpriteInstance, texture_index)},
+};
+
+#define ARRAY_COUNT(arr) (sizeof(arr) / sizeof(arr[0]))
+
+static const VertexLayout LAYOUTS[VERTEX_FORMATS_MAX] = {
+  {VERTEX3D_ATTRIBUTES,        ARRAY_COUNT(VERTEX3D_ATTRIBUTES),        sizeof(Vertex3D)}, 
+  {VERTEX3D_PACKED_ATTRIBUTES, ARRAY_COUNT(VERTEX3D_PACKED_ATTRIBUTES), sizeof(Vertex3DPacked)}, 
+  {VERTEX2D_ATTRIBUTES,        ARRAY_COUNT(VERTEX2D_ATTRIBUTES),        sizeof(Vertex2D)}, 
+  {VERTEX2D_PACKED_ATTRIBUTES, ARRAY_COUNT(VERTEX2D_PACKED_ATTRIBUTES), sizeof(Vertex2DPacked)}, 
+  {SPRITE_ATTRIBUTES,          ARRAY_COUNT(SPRITE_ATTRIBUTES),          sizeof(SpriteInstance), 1}, 
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static u32 get_gl_type(const VertexAttributeType type) {
+  switch(type) {
+    case VERTEX_ATTRIBUTE_FLOAT:
+      return GL_FLOAT;
+    case VERTEX_ATTRIBUTE_HALF_FLOAT:
+      return GL_HALF_FLOAT;
+    case VERTEX_ATTRIBUTE_UNORM8:
+    case VERTEX_ATTRIBUTE_UBYTE:
+      return GL_UNSIGNED_BYTE;
+    case VERTEX_ATTRIBUTE_UNORM16:
+    case VERTEX_ATTRIBUTE_USHORT:
+      return GL_UNSIGNED_SHORT;
+    case VERTEX_ATTRIBUTE_SNORM_10_10_10_2:
+      return GL_INT_2_10_10_10_REV;
+  }
+
+  return GL_FLOAT;
+}
+
+static bool is_normalized(const VertexAttributeType type) {
+  return type == VERTEX_ATTRIBUTE_UNORM8  || 
+         type == VERTEX_ATTRIBUTE_UNORM16 || 
+         type == VERTEX_ATTRIBUTE_SNORM_10_10_10_2;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const VertexLayout& vertex_layout_get(const VertexFormat format) {
+  return LAYOUTS[format];
+}
+
+void vertex_layout_apply(const VertexLayout& layout) {
+  for(u32 i = 0; i < layout.attributes_count; i++) {
+    const VertexAttribute& attr = layout.attributes[i];
+
+    glEnableVertexAttribArray(attr.location);
+    glVertexAttribPointer(attr.location, 
+                          attr.components, 
+                          get_gl_type(attr.type), 
+                          is_normalized(attr.type), 
+                          layout.stride, 
+                          (void*)(usizei)attr.offset);
+    glVertexAttribDivisor(attr.location, layout.divisor);
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "defines.h"
+
+// VertexFormat
+/////////////////////////////////////////////////////////////////////////////////
+enum VertexFormat {
+  VERTEX_FORMAT_3D, 
+  VERTEX_FORMAT_3D_PACKED, 
+  VERTEX_FORMAT_2D, 
+  VERTEX_FORMAT_2D_PACKED,
+  VERTEX_FORMAT_SPRITE,
+  VERTEX_FORMATS_MAX = 5,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// VertexAttributeType
+/////////////////////////////////////////////////////////////////////////////////
+enum VertexAttributeType {
+  VERTEX_ATTRIBUTE_FLOAT,
+  VERTEX_ATTRIBUTE_HALF_FLOAT,
+  VERTEX_ATTRIBUTE_UNORM8,      // [0, 255]   -> [0.0, 1.0]
+  VERTEX_ATTRIBUTE_UNORM16,     // [0, 65535] -> [0.0, 1.0]
+  VERTEX_ATTRIBUTE_SNORM_10_10_10_2, 
+  VERTEX_ATTRIBUTE_UBYTE,       // [0, 255]   -> [0.0, 255.0]
+  VERTEX_ATTRIBUTE_USHORT,      // [0, 65535] -> [0.0, 65535.0]
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// VertexAttribute
+/////////////////////////////////////////////////////////////////////////////////
+struct VertexAttribute {
+  u32 location;
+  u32 components;
+  VertexAttributeType type;
+  u32 offset;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// VertexLayout
+/////////////////////////////////////////////////////////////////////////////////
+// Describes how a vertex format is laid out in memory. 
+// NOTE: Every attribute reaches the shader as floats, no matter how it is stored.
+struct VertexLayout {
+  const VertexAttribute* attributes;
+  u32 attributes_count;
+  u32 stride;
+  u32 divisor; // Non-zero for formats that advance per instance instead of per vertex
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const VertexLayout& vertex_layout_get(const VertexFormat format);
+
+// Set up the attributes of the currently bound vertex array to read from 
+// the currently bound vertex buffer using the given layout.
+void vertex_layout_apply(const VertexLayout& layout);
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,37 @@
+#include "frustum.h"
+#include "defines.h"
+
+#include <glm/glm.hpp>
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void frustum_create(Frustum* frustum, const glm::mat4& view_projection) {
+  // The rows of the matrix. GLM stores the columns.
+  glm::vec4 rows[4];
+  for(u32 i = 0; i < 4; i++) {
+    rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+  }
+
+  frustum->planes[FRUSTUM_PLANE_LEFT]   = rows[3] + rows[0];
+  frustum->planes[FRUSTUM_PLANE_RIGHT]  = rows[3] - rows[0];
+  frustum->planes[FRUSTUM_PLANE_BOTTOM] = rows[3] + rows[1];
+  frustum->planes[FRUSTUM_PLANE_TOP]    = rows[3] - rows[1];
+  frustum->planes[FRUSTUM_PLANE_NEAR]   = rows[3] + rows[2];
+  frustum->planes[FRUSTUM_PLANE_FAR]    = rows[3] - rows[2];
+
+  // Normalize the planes so the distances are actual distances
+  for(auto& plane : frustum->planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+const bool frustum_intersects_sphere(const Frustum& frustum, const glm::vec3& center, const f32 radius) {
+  for(auto& plane : frustum.planes) {
+    if((glm::dot(glm::vec3(plane), center) + plane.w) < -radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/glm.hpp>
+
+// FrustumPlane
+/////////////////////////////////////////////////////////////////////////////////
+enum FrustumPlane {
+  FRUSTUM_PLANE_LEFT, 
+  FRUSTUM_PLANE_RIGHT, 
+  FRUSTUM_PLANE_BOTTOM, 
+  FRUSTUM_PLANE_TOP, 
+  FRUSTUM_PLANE_NEAR, 
+  FRUSTUM_PLANE_FAR, 
+  
+  FRUSTUM_PLANES_MAX = 6,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Frustum
+/////////////////////////////////////////////////////////////////////////////////
+// Every plane is (normal, distance) where the normal points into the frustum
+struct Frustum {
+  glm::vec4 planes[FRUSTUM_PLANES_MAX];
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Extract the planes out of the given matrix (Gribb & Hartmann). 
+// NOTE: Passing 'view_projection * model' gives back the frustum in the local space of the model.
+void frustum_create(Frustum* frustum, const glm::mat4& view_projection);
+
+const bool frustum_intersects_sphere(const Frustum& frustum, const glm::vec3& center, const f32 radius);
+/////////////////////////////////////////////////////////////////////////////////
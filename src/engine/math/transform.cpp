@@ -5,6 +5,13 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <atomic>
+
+// Globals
+/////////////////////////////////////////////////////////////////////////////////
+static std::atomic<u32> s_next_id = 1;
+/////////////////////////////////////////////////////////////////////////////////
+
 // Private functions
 /////////////////////////////////////////////////////////////////////////////////
 static void update_transform(Transform* transform) {
@@ -22,6 +29,7 @@ void transform_create(Transform* transform, const glm::vec3& pos, const glm::qua
   transform->position = pos; 
   transform->rotation = rot; 
   transform->scale    = scale;
+  transform->id       = s_next_id++;
 
   transform->transform = glm::mat4(1.0f);
   update_transform(transform);
@@ -11,6 +11,10 @@ struct Transform {
   glm::vec3 position, scale;
   glm::quat rotation;
   glm::mat4 transform;
+
+  // Handed out by 'transform_create' (0 for none). Anything that keeps state per object (like 
+  // the level of detail) goes by this rather than the address, so copies count as the same object.
+  u32 id;
 };
 /////////////////////////////////////////////////////////////////////////////////
 
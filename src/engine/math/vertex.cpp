@@ -0,0 +1,40 @@
+#include "vertex.h"
+#include "defines.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+Vertex3DPacked vertex_pack(const Vertex3D& vertex, const glm::vec3& min, const glm::vec3& extent) {
+  Vertex3DPacked packed = {};
+ 
+  glm::vec3 quantized = glm::clamp((vertex.position - min) / extent, 0.0f, 1.0f);
+  for(u32 i = 0; i < 3; i++) {
+    packed.position[i] = (u16)glm::round(quantized[i] * 65535.0f);
+  }
+
+  // Meshes without normals should stay without normals
+  glm::vec3 normal = vertex.normal;
+  if(glm::length(normal) > 0.0f) {
+    normal = glm::normalize(normal);
+  }
+
+  packed.normal         = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+  packed.texture_coords = glm::packHalf2x16(vertex.texture_coords);
+
+  return packed;
+}
+
+Vertex2DPacked vertex_pack(const Vertex2D& vertex) {
+  Vertex2DPacked packed = {};
+
+  packed.position       = glm::vec2(vertex.position);
+  packed.color          = glm::packUnorm4x8(vertex.color);
+  packed.texture_coords = glm::packUnorm2x16(vertex.texture_coords);
+  packed.texture_index  = (u8)vertex.texture_index;
+  packed.sdf_edge       = (u8)glm::round(glm::clamp(vertex.sdf_edge, 0.0f, 1.0f) * 255.0f);
+
+  return packed;
+}
+/////////////////////////////////////////////////////////////////////////////////
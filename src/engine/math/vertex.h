@@ -12,6 +12,7 @@ struct Vertex2D
   glm::vec4 color;
   glm::vec2 texture_coords;
   f32 texture_index;
+  f32 sdf_edge = 0.0f; // The distance of the edge if the texture is a distance field (see 'Font'), or 0 if it is not
 };
 /////////////////////////////////////////////////////////////////////////////////
 
@@ -24,3 +25,68 @@ struct Vertex3D
   glm::vec2 texture_coords;
 };
 /////////////////////////////////////////////////////////////////////////////////
+
+// Vertex3DPacked
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A compressed version of 'Vertex3D' at half the size. 
+ *
+ * The position is quantized to 16 bits per axis relative to the bounds of the mesh, so it 
+ * has to be scaled and offset back (usually by folding it into the model matrix). 
+ * The normal uses 10 bits per axis and the texture coords are half floats.
+ */
+struct Vertex3DPacked
+{
+  u16 position[4]; // The 4th component is just padding
+  u32 normal;
+  u32 texture_coords;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Vertex2DPacked
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A compressed version of 'Vertex2D' at half the size. 
+ *
+ * The position drops the (always zero) depth, the color is 8 bits per channel, 
+ * the texture coords are 16 bits each (so they have to be within [0, 1]), and the
+ * texture index and the SDF edge are a single byte each.
+ */
+struct Vertex2DPacked
+{
+  glm::vec2 position;
+  u32 color; 
+  u32 texture_coords;
+  u8 texture_index;
+  u8 sdf_edge;
+  u8 padding[2];
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// SpriteInstance
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * One sprite of the instanced 2D path. The corners of the sprite are made in the vertex shader 
+ * from a unit quad, so a whole sprite takes less room than a single 'Vertex2D'.
+ *
+ * The texture coords are 16 bits each (so they have to be within [0, 1]), the color is
+ * 8 bits per channel, and the rotation maps [0, 65535] to a full turn.
+ */
+struct SpriteInstance 
+{
+  glm::vec2 position; // The center of the sprite
+  glm::vec2 size;
+  u16 uv_rect[4];     // The offset and size of the sprite in the texture
+  u32 color;
+  u16 rotation;
+  u16 texture_index;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Pack the vertex where 'min' and 'extent' are the bounds that the position gets quantized into 
+Vertex3DPacked vertex_pack(const Vertex3D& vertex, const glm::vec3& min, const glm::vec3& extent);
+
+Vertex2DPacked vertex_pack(const Vertex2D& vertex);
+/////////////////////////////////////////////////////////////////////////////////
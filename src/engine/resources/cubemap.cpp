@@ -1,5 +1,6 @@
 #include "cubemap.h"
 #include "defines.h"
+#include "graphics/gl_state.h"
 
 #include <stb_image/stb_image.h>
 #include <glad/gl.h>
@@ -13,7 +14,7 @@ CubeMap* cubemap_load(const std::string& path) {
   CubeMap* cm = new CubeMap{};
 
   glGenTextures(1, &cm->id);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cm->id);
+  gl_state_bind_texture_for_edit(GL_TEXTURE_CUBE_MAP, cm->id);
 
   // @TODO: This is bad. Find a way for the user to write these instead of hard coding it
   std::string ext = ".png";
@@ -46,7 +47,7 @@ CubeMap* cubemap_load(const std::string& path) {
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-  glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+  gl_state_bind_texture(GL_TEXTURE_CUBE_MAP, 0, 0);
 
   return cm;
 }
@@ -64,6 +65,6 @@ void cubemap_use(CubeMap* cm) {
     return;
   }
 
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cm->id);
+  gl_state_bind_texture(GL_TEXTURE_CUBE_MAP, 0, cm->id);
 }
 /////////////////////////////////////////////////////////////////////////////////
@@ -1,7 +1,8 @@
 #include "font.h"
 #include "defines.h"
-#include "resources/texture.h"
+#include "resources/texture_atlas.h"
 #include "utils/utils_file.h"
+#include "utils/utils_utf8.h"
 
 #include <glad/gl.h>
 #include <stb_truetype/stb_truetype.h>
@@ -10,9 +11,10 @@
 #include <cstdio>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <fstream>
 
-// Public functions
+// Private functions
 /////////////////////////////////////////////////////////////////////////////////
 static u8* get_font_data(const std::string& path) {
   std::ifstream file(path, std::ifstream::binary);
@@ -22,135 +24,236 @@ static u8* get_font_data(const std::string& path) {
   }
 
   usizei size = file_get_size(file);
-  u8* data = new u8[size]; 
-  file_read_binary(file, data, size); 
+  u8* data = new u8[size];
+  file_read_binary(file, data, size);
 
-  return data; 
+  return data;
 }
 
-static void init_font_chars(Font* font, stbtt_fontinfo* info) {
+static i32 load_glyph(Font* font, const i32 codepoint, const i32 glyph_index) {
   /*
-   * NOTE: Bits and pieces of this code is borrowed from Raylib. Particularly, from 
-   * the "rtext.c" file. Check them out if you have not already. 
+   * NOTE: Bits and pieces of this code is borrowed from Raylib. Particularly, from
+   * the "rtext.c" file. Check them out if you have not already.
    */
 
-  // This will return a value that will get used constantly to put all the values 
-  // that come out of the stb in "scaled" coordinates.  
-  f32 scale_factor = stbtt_ScaleForPixelHeight(info, font->base_size);
+  Glyph glyph   = {};
+  glyph.unicode = codepoint;
+  glyph.index   = glyph_index;
 
-  // Get the ascent, descent, and line gap of the font and put them in 
-  // the scaled space 
-  i32 ascent, descent, line_gap;
-  stbtt_GetFontVMetrics(info, &ascent, &descent, &line_gap);
+  // Only the size of the bitmap for now. The pixels come later, when the glyph is first drawn.
+  stbtt_GetGlyphBitmapBox(font->info,
+                          glyph_index,
+                          font->scale_factor,
+                          font->scale_factor,
+                          &glyph.left,
+                          &glyph.top,
+                          &glyph.right,
+                          &glyph.bottom);
+
+  glyph.width      = glyph.right - glyph.left;
+  glyph.height     = glyph.bottom - glyph.top;
+  glyph.x_offset   = glyph.left;
+  glyph.y_offset   = glyph.top;
+  glyph.has_pixels = glyph.width > 0 && glyph.height > 0 && !stbtt_IsGlyphEmpty(font->info, glyph_index);
 
-  font->ascent = ascent * scale_factor;
-  font->descent = descent * scale_factor;
+  // Getting the advance and the left side bearing of the specific codepoint/glyph.
+  // The advance is the value required to "advance" to the next glyph
+  stbtt_GetGlyphHMetrics(font->info, glyph_index, &glyph.advance_x, &glyph.left_side_bearing);
+  glyph.advance_x *= font->scale_factor;
 
-  for(u32 i = 0; i < info->numGlyphs; i++) { 
-    Glyph glyph;
-    glyph.unicode = i + 32;
+  // Getting the kern of the glyph. The kern is used to make some specific glyphs look better
+  // when next to each other.
+  glyph.kern = stbtt_GetCodepointKernAdvance(font->info, glyph.unicode, glyph.unicode + 32);
+  glyph.kern *= font->scale_factor;
+
+  glyph.y_offset += font->ascent;
+  glyph.y_offset -= glyph.top / 2;
+  glyph.x_offset = glyph.right / 2;
+
+  font->glyphs.push_back(glyph);
+  return font->glyphs_count++;
+}
 
-    // This functions will return 0 if the given unicode is not in 
-    // the font. Thus, to speed up the loop, we just skip these unicodes.
-    i32 glyph_index = stbtt_FindGlyphIndex(info, glyph.unicode);
-    if(glyph_index == 0) {
-      continue;
+static bool rasterize_glyph(Font* font, Glyph& glyph) {
+  i32 width  = glyph.width;
+  i32 height = glyph.height;
+  u8* mono_bitmap;
+  std::vector<u8> coverage;
+
+  if(font->is_sdf) {
+    // Goes from 0 at 'glyph_padding' pixels outside of the edge to 255 at as far inside
+    i32 x_offset, y_offset;
+    mono_bitmap = stbtt_GetGlyphSDF(font->info, 
+                                    font->scale_factor, 
+                                    glyph.index, 
+                                    font->glyph_padding, 
+                                    128, 
+                                    128.0f / font->glyph_padding, 
+                                    &width, 
+                                    &height, 
+                                    &x_offset, 
+                                    &y_offset);
+  }
+  else {
+    coverage.resize(width * height);
+    mono_bitmap = coverage.data();
+    stbtt_MakeGlyphBitmap(font->info, mono_bitmap, width, height, width, font->scale_factor, font->scale_factor, glyph.index);
+  }
+
+  if(!mono_bitmap) {
+    return false;
+  }
+
+  // Converting the mono bitmap into an RGBA bitmap format to be used more
+  // efficiently with the batch renderer. The rows get flipped on the way,
+  // since the atlas wants them from the bottom up.
+  std::vector<u8> bitmap(width * height * 4);
+  for(i32 i = 0; i < height; i++) {
+    for(i32 j = 0; j < width; j++) {
+      u32 mono_index = (i * width) + j;
+      u32 rgba_index = (((height - i - 1) * width) + j) * 4;
+
+      bitmap[rgba_index] = 255; // Red
+      bitmap[rgba_index + 1] = 255; // Green
+      bitmap[rgba_index + 2] = 255; // Blue
+      bitmap[rgba_index + 3] = mono_bitmap[mono_index]; // Alpha
     }
+  }
+
+  if(font->is_sdf) {
+    stbtt_FreeSDF(mono_bitmap, nullptr);
+  }
 
-    // Pixels of the specific codepoint, offset, and size 
-    u8* mono_bitmap = stbtt_GetGlyphBitmap(info, 
-                                           0,
-                                           scale_factor, 
-                                           glyph_index, 
-                                           &glyph.width, 
-                                           &glyph.height, 
-                                           &glyph.x_offset, 
-                                           &glyph.y_offset);
-
-    stbtt_GetGlyphBitmapBox(info, 
-                            glyph_index, 
-                            scale_factor, 
-                            scale_factor, 
-                            &glyph.left, 
-                            &glyph.top, 
-                            &glyph.right, 
-                            &glyph.bottom);
-
-    // Only give OpenGL the pixels when it is valid 
-    if(mono_bitmap) {
-      // Converting the mono bitmap into an RGBA bitmap format to be used more 
-      // efficiently with the batch renderer.
-      usizei btmp_size = glyph.width * glyph.height * 4;
-      u8* bitmap = new u8[btmp_size];
-      for(u32 i = 0; i < glyph.height; i++) {
-        for(u32 j = 0; j < glyph.width; j++) {
-          u32 mono_index = (i * glyph.width) + j; 
-          u32 rgba_index = ((i * glyph.width) + j) * 4;
-
-          bitmap[rgba_index] = 255; // Red 
-          bitmap[rgba_index + 1] = 255; // Green 
-          bitmap[rgba_index + 2] = 255; // Blue 
-          bitmap[rgba_index + 3] = mono_bitmap[mono_index]; // Alpha 
-        }
-      }
-
-      glyph.texture = texture_load(glyph.width, glyph.height, TEXTURE_FORMAT_RGBA, bitmap);
-      delete[] bitmap;
-    }  
-    else { // Probably the space character (' ') so just allocate an empty buffer for it
-      u32 pixels = 0x00; 
-      glyph.texture = texture_load(1, 1, TEXTURE_FORMAT_RED, &pixels);
+  glyph.is_cached = texture_atlas_add(font->atlas, width, height, bitmap.data(), &glyph.region);
+  return glyph.is_cached;
+}
+
+static void grow_atlas(Font* font) {
+  f32 scale = font->atlas->page_size / (f32)(font->atlas->page_size * 2);
+  texture_atlas_grow(font->atlas, font->atlas->page_size * 2);
+  font->atlas_generation++;
+
+  // The glyphs stay where they were in pixels, which is a smaller part of the atlas now
+  for(auto& glyph : font->glyphs) {
+    if(glyph.is_cached) {
+      glyph.region.uv_rect *= scale;
     }
-    
-    // Getting the advance and the left side bearing of the specific codepoint/glyph.
-    // The advance is the value required to "advance" to the next glyph
-    stbtt_GetGlyphHMetrics(info, glyph_index, &glyph.advance_x, &glyph.left_side_bearing);
-    glyph.advance_x *= scale_factor;
-
-    // Getting the kern of the glyph. The kern is used to make some specific glyphs look better 
-    // when next to each other.
-    glyph.kern = stbtt_GetCodepointKernAdvance(info, glyph.unicode, glyph.unicode + 32); 
-    glyph.kern *= scale_factor;
-    
-    glyph.y_offset += font->ascent;
-    glyph.y_offset -= glyph.top / 2;
-    glyph.x_offset = glyph.right / 2;
+  }
+}
 
-    // Make sure the deallocate the bitmap data that was allocated by STB 
-    // NOTE: Potentially really slow to have an allocation and a deallocation in a loop 
-    stbtt_FreeBitmap(mono_bitmap, nullptr);
-  
-    // A valid glyph that was loaded 
-    font->glyphs_count++;
-    font->glyphs.push_back(glyph);
+static void evict_glyphs(Font* font) {
+  // Nothing was ever added, so there is nothing to throw out either
+  if(font->atlas->packers.empty()) {
+    return;
   }
 
-  // Resizing the vector down only for the loaded glyphs 
-  font->glyphs.resize(font->glyphs_count);
+  // Most recently used first
+  std::vector<u32> cached;
+  for(u32 i = 0; i < font->glyphs.size(); i++) {
+    if(font->glyphs[i].is_cached) {
+      cached.push_back(i);
+    }
+
+    font->glyphs[i].is_cached = false;
+  }
+
+  std::sort(cached.begin(), cached.end(), [font](const u32 a, const u32 b) {
+    return font->glyphs[a].last_use > font->glyphs[b].last_use;
+  });
+
+  // The pixels are not kept around anywhere else, so the glyphs that survive get rasterized again.
+  // The ones that are still in use always stay.
+  texture_atlas_clear(font->atlas);
+  font->evictions_count++;
+  font->atlas_generation++;
+
+  for(auto& index : cached) {
+    Glyph& glyph = font->glyphs[index];
+
+    bool is_in_use = glyph.last_use == font->use_count;
+    if(!is_in_use && atlas_packer_get_occupancy(&font->atlas->packers[0]) >= FONT_EVICT_KEEP) {
+      break;
+    }
+
+    rasterize_glyph(font, glyph);
+  }
+}
+
+static void cache_glyph(Font* font, Glyph& glyph) {
+  if(glyph.is_cached || !glyph.has_pixels) {
+    return;
+  }
+
+  if(rasterize_glyph(font, glyph)) {
+    return;
+  }
+
+  // Make room by growing the atlas first, and only then by throwing glyphs out
+  while(font->atlas->page_size < FONT_ATLAS_MAX_SIZE) {
+    grow_atlas(font);
+    if(rasterize_glyph(font, glyph)) {
+      return;
+    }
+  }
+
+  evict_glyphs(font);
+  if(!rasterize_glyph(font, glyph)) {
+    fprintf(stderr, "[ERROR]: No room for the glyph of codepoint \'%i\' in the font atlas\n", glyph.unicode);
+  }
 }
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-Font* font_load(const std::string& path, const f32 size) {
+Font* font_load(const std::string& path, const f32 size, const bool is_sdf) {
   Font* font = new Font{};
-  font->base_size = size; 
+  font->base_size = size;
+  font->is_sdf    = is_sdf;
+
+  // An empty glyph for every codepoint, in case the font cannot be loaded
+  font->glyphs.push_back(Glyph{});
+  font->glyphs_count = 1;
 
-  u8* data = get_font_data(path);
-  stbtt_fontinfo info;
-  if(stbtt_InitFont(&info, data, stbtt_GetFontOffsetForIndex(data, 0)) == 0) {
+  font->data = get_font_data(path);
+  if(!font->data) {
+    return font;
+  }
+
+  font->info = new stbtt_fontinfo{};
+  if(stbtt_InitFont(font->info, font->data, stbtt_GetFontOffsetForIndex(font->data, 0)) == 0) {
     fprintf(stderr, "[ERROR]: Failed to initialize stb for font \'%s\'\n", path.c_str());
+    
+    delete font->info;
+    font->info = nullptr;
     return font;
   }
 
-  font->glyphs.reserve(info.numGlyphs);
-  font->glyph_padding = 4.0f;
+  // This will return a value that will get used constantly to put all the values
+  // that come out of the stb in "scaled" coordinates.
+  font->scale_factor = stbtt_ScaleForPixelHeight(font->info, font->base_size);
 
-  // Load the textures and required values for every glyph in the font 
-  init_font_chars(font, &info);
-  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  // Get the ascent, descent, and line gap of the font and put them in
+  // the scaled space
+  i32 ascent, descent, line_gap;
+  stbtt_GetFontVMetrics(font->info, &ascent, &descent, &line_gap);
+
+  font->ascent   = ascent * font->scale_factor;
+  font->descent  = descent * font->scale_factor;
+  font->line_gap = line_gap * font->scale_factor;
+
+  // The distance field already leaves room around the glyphs, so they can go right next to each other
+  font->glyph_padding = is_sdf ? FONT_SDF_PADDING : 0.0f;
+  font->atlas = texture_atlas_create(FONT_ATLAS_MIN_SIZE, is_sdf ? 0 : 1, 1);
+
+  for(u32 i = 0; i < FONT_ASCII_COUNT; i++) {
+    font->ascii_lookup[i] = -1;
+  }
+
+  // The glyph of any codepoint the font does not have
+  font->glyphs.clear();
+  font->glyphs_count = 0;
+  load_glyph(font, -1, 0);
 
-  delete[] data;
   return font;
 }
 
@@ -159,23 +262,70 @@ void font_unload(Font* font) {
     return;
   }
 
-  for(u32 i = 0; i < font->glyphs.size(); i++) {
-    texture_unload(font->glyphs[i].texture);
-  }
-  
+  texture_atlas_destroy(font->atlas);
+
+  delete font->info;
+  delete[] font->data;
+
   font->glyphs.clear();
   delete font;
-  
+
   font = nullptr;
 }
 
-i32 font_get_glyph_index(const Font* font, i8 codepoint) {
-  for(u32 i = 0; i < font->glyphs.size(); i++) {
-    if(font->glyphs[i].unicode == codepoint) {
-      return i;
+i32 font_get_glyph_index(Font* font, const i32 codepoint) {
+  if(codepoint >= 0 && codepoint < FONT_ASCII_COUNT) {
+    if(font->ascii_lookup[codepoint] != -1) {
+      return font->ascii_lookup[codepoint];
+    }
+  }
+  else {
+    auto it = font->lookup.find(codepoint);
+    if(it != font->lookup.end()) {
+      return it->second;
+    }
+  }
+
+  // First time seeing this codepoint
+  i32 index = 0;
+  if(font->info) {
+    i32 glyph_index = stbtt_FindGlyphIndex(font->info, codepoint);
+    if(glyph_index != 0) {
+      index = load_glyph(font, codepoint, glyph_index);
     }
   }
 
-  return 0;
+  if(codepoint >= 0 && codepoint < FONT_ASCII_COUNT) {
+    font->ascii_lookup[codepoint] = index;
+  }
+  else {
+    font->lookup[codepoint] = index;
+  }
+
+  return index;
+}
+
+const bool font_is_text_cached(Font* font, const std::string& text) {
+  font->use_count++;
+  bool is_cached = true;
+
+  for(usizei offset = 0; offset < text.size();) {
+    Glyph& glyph   = font->glyphs[font_get_glyph_index(font, utf8_decode(text, &offset))];
+    glyph.last_use = font->use_count;
+
+    is_cached &= glyph.is_cached || !glyph.has_pixels;
+  }
+
+  return is_cached;
+}
+
+void font_cache_text(Font* font, const std::string& text) {
+  // Every glyph of the text has to be marked first, so none of them get evicted for the others
+  font_is_text_cached(font, text);
+
+  for(usizei offset = 0; offset < text.size();) {
+    i32 index = font_get_glyph_index(font, utf8_decode(text, &offset));
+    cache_glyph(font, font->glyphs[index]);
+  }
 }
 /////////////////////////////////////////////////////////////////////////////////
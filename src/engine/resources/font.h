@@ -1,20 +1,36 @@
-#pragma once 
+#pragma once
 
 #include "defines.h"
-#include "resources/texture.h"
+#include "resources/texture_atlas.h"
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define FONT_ASCII_COUNT    128  // Codepoints below this are looked up directly, and the rest through a hash map
+#define FONT_ATLAS_MIN_SIZE 512  // The atlas starts out this big and doubles when full...
+#define FONT_ATLAS_MAX_SIZE 4096 // ...up to this size. After that, the least recently used glyphs are evicted.
+#define FONT_EVICT_KEEP     0.5f // How much of the atlas the most recently used glyphs can take up again after an eviction
+#define FONT_SDF_BASE_SIZE  48.0f // The size SDF fonts are generated at. Any size can be drawn from it.
+#define FONT_SDF_PADDING    6     // How far (in pixels) the distance field reaches outside of the glyph
+/////////////////////////////////////////////////////////////////////////////////
 
 // Glyph
 /////////////////////////////////////////////////////////////////////////////////
 struct Glyph {
-  i8 unicode;
-  Texture* texture;
+  i32 unicode;
+  i32 index; // Into the font file. The glyph at 0 is the one used for missing codepoints.
+
+  // Only valid if 'is_cached'. Glyphs without any pixels (like ' ') are never cached.
+  AtlasRegion region;
+  bool has_pixels, is_cached;
+  u64 last_use;
 
   i32 width, height;
   i32 x_offset, y_offset;
-  
+
   i32 advance_x, kern, left_side_bearing;
   i32 left, right, top, bottom;
 };
@@ -22,19 +38,59 @@ struct Glyph {
 
 // Font
 /////////////////////////////////////////////////////////////////////////////////
+struct stbtt_fontinfo;
+
+/*
+ * Glyphs are loaded lazily. The metrics of a glyph are read the first time its codepoint
+ * is looked up, and its pixels are only rasterized into the atlas the first time it gets drawn
+ * (or when pre-warmed with 'font_cache_text').
+ *
+ * SDF fonts keep the signed distance to the edge of the glyph in the alpha of the atlas
+ * instead of the coverage, with 0.5 right on the edge. That stays sharp when scaled up, so 
+ * a single small atlas serves every size, and outlines and shadows only need a different edge.
+ */
 struct Font {
   f32 base_size;
   f32 ascent, descent, line_gap;
-  f32 glyph_padding;
+  f32 glyph_padding; // Around every glyph's pixels in the atlas. The reach of the distance field for SDF fonts.
+  bool is_sdf;
 
   std::vector<Glyph> glyphs;
   u32 glyphs_count;
+
+  // Every glyph of the font goes into the same atlas, so a whole string can be drawn in one batch
+  TextureAtlas* atlas;
+
+  // Codepoint to index into 'glyphs' (-1 if it was not looked up yet)
+  i32 ascii_lookup[FONT_ASCII_COUNT];
+  std::unordered_map<i32, i32> lookup;
+
+  // Kept around to rasterize the glyphs that are not loaded yet
+  u8* data;
+  stbtt_fontinfo* info;
+  f32 scale_factor;
+
+  u64 use_count;       // Goes up every time a piece of text uses the font, to tell the least recently used glyphs apart
+  u32 evictions_count;
+  u32 atlas_generation; // Goes up every time the glyphs that are in the atlas move (see 'TextLayout')
 };
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-Font* font_load(const std::string& path, const f32 size);
+Font* font_load(const std::string& path, const f32 size, const bool is_sdf = false);
 void font_unload(Font* font);
-i32 font_get_glyph_index(const Font* font, i8 codepoint);
+
+// Returns the index of the codepoint's glyph, or 0 if the font does not have it.
+// NOTE: This only loads the metrics of the glyph, not its pixels.
+i32 font_get_glyph_index(Font* font, const i32 codepoint);
+
+// Marks every glyph of the UTF-8 text as used, and returns 'true' if all of them are in the atlas.
+const bool font_is_text_cached(Font* font, const std::string& text);
+
+// Rasterize every glyph of the UTF-8 text that is not in the atlas yet.
+// Can be used to pre-warm the atlas with a character set at startup.
+// NOTE: This might move (or evict) the other glyphs in the atlas, so anything
+// that was batched with the atlas has to be drawn before.
+void font_cache_text(Font* font, const std::string& text);
 /////////////////////////////////////////////////////////////////////////////////
@@ -1,9 +1,13 @@
 #include "mesh.h"
 #include "defines.h"
+#include "graphics/geometry_pool.h"
+#include "graphics/instance_arena.h"
+#include "resources/mesh_simplify.h"
+#include "resources/mesh_optimize.h"
+#include "resources/meshlet.h"
 
 #include <cstddef>
 #include <glm/glm.hpp>
-#include <glad/gl.h>
 
 // Private functions
 /////////////////////////////////////////////////////////////////////////////////
@@ -73,37 +77,13 @@ static void setup_buffers(Mesh* mesh) {
 }
 
 void setup_gl_buffers(Mesh* mesh) {
-  // VAO
-  glGenVertexArrays(1, &mesh->vao);
-  glBindVertexArray(mesh->vao);
-
-  // EBO
-  glGenBuffers(1, &mesh->ebo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32) * mesh->indices.size(), &mesh->indices[0], GL_STATIC_DRAW);
-  
-  // IBO - Instance buffer
-  glGenBuffers(1, &mesh->ibo);
-  glBindBuffer(GL_ARRAY_BUFFER, mesh->ibo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * MAX_MESH_INSTANCES, nullptr, GL_DYNAMIC_DRAW);
-
-  // VBO
-  glGenBuffers(1, &mesh->vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex3D) * mesh->vertices.size(), &mesh->vertices[0], GL_STATIC_DRAW);
- 
-  // Attributes 
-  // Position 
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex3D), 0);
-  
-  // Normal 
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex3D), (void*)offsetof(Vertex3D, normal));
-  
-  // Texture coords 
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex3D), (void*)offsetof(Vertex3D, texture_coords));
+  // Vertices and indices
+  // NOTE: No instance storage is reserved here. That only happens once the mesh is drawn instanced.
+  mesh->geometry = geometry_pool_alloc(mesh->vertices, mesh->indices);
+
+  // The full mesh is the first level of detail
+  mesh->lods[0]    = MeshLOD{mesh->geometry.index_offset, mesh->geometry.index_count, 1.0f};
+  mesh->lods_count = 1;
 }
 /////////////////////////////////////////////////////////////////////////////////
 
@@ -146,9 +126,61 @@ Mesh* mesh_create(const std::vector<Vertex3D>& vertices, const std::vector<u32>&
 }
 
 void mesh_destroy(Mesh* mesh) {
+  geometry_pool_free(mesh->geometry);
+  for(u32 i = 1; i < mesh->lods_count; i++) {
+    geometry_pool_free_indices(mesh->lods[i].index_offset, mesh->lods[i].index_count, mesh->geometry.has_short_indices);
+  }
+  instance_arena_free(&mesh->instances);
+
   mesh->vertices.clear();
   mesh->indices.clear();
+  mesh->meshlets.clear();
 
   delete mesh;
 }
+
+void mesh_build_lods(Mesh* mesh, const std::vector<f32>& ratios) {
+  u32 full_count = mesh->geometry.index_count;
+  std::vector<u32> indices = mesh->indices;
+
+  for(auto& ratio : ratios) {
+    if(mesh->lods_count >= MESH_LODS_MAX) {
+      break;
+    }
+
+    // Every level is simplified from the one before it, which is a lot cheaper than starting over
+    u32 target = (u32)(full_count * ratio);
+    u32 prev_count = indices.empty() ? full_count : indices.size();
+    
+    indices = mesh_simplify(mesh->vertices, indices, target);
+    if(indices.empty() || indices.size() >= prev_count) {
+      break;
+    }
+
+    // The collapses leave the triangles scattered, so they need to be reordered for the vertex cache again
+    indices = mesh_optimize_triangles(mesh->vertices, indices);
+
+    MeshLOD lod = {.index_count = (u32)indices.size(), .screen_size = ratio};
+    if(!geometry_pool_alloc_indices(indices, mesh->geometry.has_short_indices, &lod.index_offset)) {
+      break;
+    }
+
+    mesh->lods[mesh->lods_count] = lod;
+    mesh->lods_count++;
+  }
+}
+
+void mesh_build_meshlets(Mesh* mesh) {
+  // Without any indices, the vertices are just a triangle list
+  if(mesh->indices.empty()) {
+    mesh->indices.resize(mesh->vertices.size());
+    for(u32 i = 0; i < mesh->indices.size(); i++) {
+      mesh->indices[i] = i;
+    }
+  }
+
+  // The meshlets reorder the triangles, so the full mesh has to be uploaded again
+  mesh->meshlets = meshlet_build(mesh->vertices, mesh->indices);
+  geometry_pool_update_indices(mesh->lods[0].index_offset, mesh->indices, mesh->geometry.has_short_indices);
+}
 /////////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,9 @@
 
 #include "defines.h"
 #include "math/vertex.h"
+#include "graphics/geometry_pool.h"
+#include "graphics/instance_arena.h"
+#include "resources/meshlet.h"
 
 #include <glm/vec3.hpp>
 
@@ -9,7 +12,20 @@
 
 // DEFS
 /////////////////////////////////////////////////////////////////////////////////
-#define MAX_MESH_INSTANCES 2048
+#define MAX_MESH_INSTANCES 2048 // The most instances a single instanced draw can have
+#define MESH_LODS_MAX      4
+/////////////////////////////////////////////////////////////////////////////////
+
+// MeshLOD
+/////////////////////////////////////////////////////////////////////////////////
+// A level of detail is just a different set of indices into the same vertices 
+struct MeshLOD {
+  u32 index_offset, index_count; // Where the indices live in the geometry pool
+
+  // The level is used once the mesh covers less than this 
+  // fraction of the screen's height.
+  f32 screen_size;
+};
 /////////////////////////////////////////////////////////////////////////////////
 
 // Mesh
@@ -18,8 +34,13 @@ struct Mesh {
   std::vector<Vertex3D> vertices; 
   std::vector<u32> indices;
 
-  u32 vao, vbo, ebo;
-  u32 ibo; // Instance buffer
+  GeometryAllocation geometry; // Where the mesh lives in the geometry pool
+  InstanceAllocation instances; // Only reserved once the mesh gets drawn instanced
+
+  MeshLOD lods[MESH_LODS_MAX]; // The first level is always the full mesh
+  u32 lods_count;
+
+  std::vector<Meshlet> meshlets; // Only split up for the full mesh (if at all)
 
   glm::vec3 min, max;
 };
@@ -30,4 +51,15 @@ struct Mesh {
 Mesh* mesh_create();
 Mesh* mesh_create(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices);
 void mesh_destroy(Mesh* mesh);
+
+// Build a chain of simplified levels of detail, where each ratio is the fraction of
+// triangles to keep (0.5 for half, for example). The ratios are expected to get smaller.
+// NOTE: The ratio of a level doubles as its screen size. A level that keeps a quarter of the
+// triangles will be used once the mesh covers less than a quarter of the screen's height.
+// NOTE: The chain stops early if a level could not get any simpler than the one before it.
+void mesh_build_lods(Mesh* mesh, const std::vector<f32>& ratios);
+
+// Split the full mesh into meshlets that the renderer culls one by one (see 'meshlet_build').
+// NOTE: This reorders the triangles of the full mesh.
+void mesh_build_meshlets(Mesh* mesh);
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,359 @@
+#include "mesh_optimize.h"
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define OVERDRAW_THRESHOLD   1.05f // How much worse (in ACMR) a cluster can get to be split off from the rest
+#define MIN_CLUSTER_TRIANGLES 8    // Anything smaller than this is too small to be worth sorting on its own
+/////////////////////////////////////////////////////////////////////////////////
+
+// Adjacency
+/////////////////////////////////////////////////////////////////////////////////
+// The triangles using each vertex, all packed into one array
+struct Adjacency {
+  std::vector<u32> offsets;
+  std::vector<u32> counts;
+  std::vector<u32> triangles;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// VertexCache
+/////////////////////////////////////////////////////////////////////////////////
+// A FIFO cache where a vertex is a hit if it was added less than 'size' misses ago
+struct VertexCache {
+  std::vector<u32> timestamps;
+  u32 time;
+  u32 size;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void build_adjacency(Adjacency& adj, const std::vector<u32>& indices, const u32 vertex_count) {
+  adj.offsets.assign(vertex_count, 0);
+  adj.counts.assign(vertex_count, 0);
+  adj.triangles.resize(indices.size());
+
+  for(auto& index : indices) {
+    adj.counts[index]++;
+  }
+
+  u32 offset = 0;
+  for(u32 i = 0; i < vertex_count; i++) {
+    adj.offsets[i] = offset;
+    offset        += adj.counts[i];
+  }
+
+  // Fill the triangles, using the offsets as cursors and then moving them back
+  for(u32 i = 0; i < indices.size(); i++) {
+    adj.triangles[adj.offsets[indices[i]]++] = i / 3;
+  }
+
+  for(u32 i = 0; i < vertex_count; i++) {
+    adj.offsets[i] -= adj.counts[i];
+  }
+}
+
+static void cache_reset(VertexCache& cache, const u32 vertex_count, const u32 size) {
+  // Starting the clock ahead of the cache size makes every vertex a miss at first
+  cache.timestamps.assign(vertex_count, 0);
+  cache.time = size + 1;
+  cache.size = size;
+}
+
+// Pushes every vertex out of the cache without having to touch the timestamps
+static void cache_flush(VertexCache& cache) {
+  cache.time += cache.size + 1;
+}
+
+// Returns 'true' if the vertex was a cache miss
+static bool cache_touch(VertexCache& cache, const u32 vertex) {
+  if((cache.time - cache.timestamps[vertex]) <= cache.size) {
+    return false;
+  }
+
+  cache.timestamps[vertex] = cache.time++;
+  return true;
+}
+
+static i32 skip_dead_end(const std::vector<u32>& live, std::vector<u32>& dead_ends, u32& cursor) {
+  // Recently used vertices are still likely to be in the cache
+  while(!dead_ends.empty()) {
+    u32 vertex = dead_ends.back();
+    dead_ends.pop_back();
+
+    if(live[vertex] > 0) {
+      return vertex;
+    }
+  }
+
+  // Otherwise, just take the next vertex in line that still has triangles left
+  while(cursor < live.size()) {
+    if(live[cursor] > 0) {
+      return cursor;
+    }
+
+    cursor++;
+  }
+
+  return -1;
+}
+
+static i32 get_next_vertex(const std::vector<u32>& candidates, const std::vector<u32>& live, const VertexCache& cache) {
+  i32 best          = -1;
+  i32 best_priority = 0; // Only candidates that will still be in the cache count. Otherwise, it is a dead end.
+
+  for(auto& vertex : candidates) {
+    if(live[vertex] == 0) {
+      continue;
+    }
+
+    // Prefer the oldest vertex that will still be in the cache after its remaining triangles are emitted
+    i32 priority = 0;
+    u32 age      = cache.time - cache.timestamps[vertex];
+    if(age + (2 * live[vertex]) <= cache.size) {
+      priority = age;
+    }
+
+    if(priority > best_priority) {
+      best          = vertex;
+      best_priority = priority;
+    }
+  }
+
+  return best;
+}
+
+static const std::vector<u32> tipsify(const std::vector<u32>& indices, const u32 vertex_count) {
+  Adjacency adj;
+  build_adjacency(adj, indices, vertex_count);
+
+  std::vector<u32> live = adj.counts;
+  std::vector<bool> is_emitted(indices.size() / 3, false);
+  std::vector<u32> dead_ends;
+  std::vector<u32> candidates;
+
+  VertexCache cache;
+  cache_reset(cache, vertex_count, MESH_CACHE_SIZE);
+
+  std::vector<u32> result;
+  result.reserve(indices.size());
+
+  u32 cursor = 0;
+  i32 fanning = skip_dead_end(live, dead_ends, cursor);
+
+  // Emit every triangle around the fanning vertex and then move on to a neighbour
+  while(fanning >= 0) {
+    candidates.clear();
+
+    for(u32 i = 0; i < adj.counts[fanning]; i++) {
+      u32 triangle = adj.triangles[adj.offsets[fanning] + i];
+      if(is_emitted[triangle]) {
+        continue;
+      }
+
+      for(u32 j = 0; j < 3; j++) {
+        u32 vertex = indices[triangle * 3 + j];
+        result.push_back(vertex);
+
+        dead_ends.push_back(vertex);
+        candidates.push_back(vertex);
+        live[vertex]--;
+
+        cache_touch(cache, vertex);
+      }
+
+      is_emitted[triangle] = true;
+    }
+
+    fanning = get_next_vertex(candidates, live, cache);
+    if(fanning < 0) {
+      fanning = skip_dead_end(live, dead_ends, cursor);
+    }
+  }
+
+  return result;
+}
+
+static const std::vector<u32> build_clusters(const std::vector<u32>& indices, const u32 vertex_count) {
+  u32 triangle_count = indices.size() / 3;
+
+  VertexCache cache;
+  cache_reset(cache, vertex_count, MESH_CACHE_SIZE);
+
+  // Hard boundaries are the triangles where the cache starts over (every vertex missed)
+  std::vector<u32> hard_clusters;
+  u32 total_misses = 0;
+
+  for(u32 i = 0; i < triangle_count; i++) {
+    u32 misses = 0;
+    for(u32 j = 0; j < 3; j++) {
+      misses += cache_touch(cache, indices[i * 3 + j]);
+    }
+
+    if(i == 0 || misses == 3) {
+      hard_clusters.push_back(i);
+    }
+    total_misses += misses;
+  }
+
+  // Split the hard clusters further, as long as the split pieces do not cost too much cache efficiency
+  f32 threshold = ((f32)total_misses / triangle_count) * OVERDRAW_THRESHOLD;
+  hard_clusters.push_back(triangle_count);
+
+  std::vector<u32> clusters;
+  for(u32 i = 0; i < hard_clusters.size() - 1; i++) {
+    u32 start = hard_clusters[i];
+    u32 end   = hard_clusters[i + 1];
+
+    clusters.push_back(start);
+
+    cache_flush(cache);
+    u32 misses = 0;
+
+    for(u32 tri = start; tri < end; tri++) {
+      for(u32 j = 0; j < 3; j++) {
+        misses += cache_touch(cache, indices[tri * 3 + j]);
+      }
+
+      u32 count = tri - start + 1;
+      if(count >= MIN_CLUSTER_TRIANGLES && (tri + 1) < end && ((f32)misses / count) <= threshold) {
+        clusters.push_back(tri + 1);
+
+        start  = tri + 1;
+        misses = 0;
+        cache_flush(cache);
+      }
+    }
+  }
+
+  clusters.push_back(triangle_count);
+  return clusters;
+}
+
+static const std::vector<u32> sort_clusters(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices, const std::vector<u32>& clusters) {
+  u32 clusters_count = clusters.size() - 1;
+
+  std::vector<glm::vec3> centers(clusters_count, glm::vec3(0.0f));
+  std::vector<glm::vec3> normals(clusters_count, glm::vec3(0.0f));
+  std::vector<f32> areas(clusters_count, 0.0f);
+
+  glm::vec3 mesh_center(0.0f);
+  f32 mesh_area = 0.0f;
+
+  // Area-weighted centers and normals of every cluster (and the whole mesh)
+  for(u32 i = 0; i < clusters_count; i++) {
+    for(u32 tri = clusters[i]; tri < clusters[i + 1]; tri++) {
+      const glm::vec3& p0 = vertices[indices[tri * 3 + 0]].position;
+      const glm::vec3& p1 = vertices[indices[tri * 3 + 1]].position;
+      const glm::vec3& p2 = vertices[indices[tri * 3 + 2]].position;
+
+      glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+      f32 area        = glm::length(cross);
+
+      centers[i] += ((p0 + p1 + p2) / 3.0f) * area;
+      normals[i] += cross;
+      areas[i]   += area;
+    }
+
+    mesh_center += centers[i];
+    mesh_area   += areas[i];
+  }
+
+  if(mesh_area > 0.0f) {
+    mesh_center /= mesh_area;
+  }
+
+  // Clusters that point away from the center are more likely to occlude the rest of the mesh
+  std::vector<f32> sort_keys(clusters_count, 0.0f);
+  for(u32 i = 0; i < clusters_count; i++) {
+    if(areas[i] <= 0.0f || glm::length(normals[i]) <= 0.0f) {
+      continue;
+    }
+
+    sort_keys[i] = glm::dot((centers[i] / areas[i]) - mesh_center, glm::normalize(normals[i]));
+  }
+
+  std::vector<u32> order(clusters_count);
+  for(u32 i = 0; i < clusters_count; i++) {
+    order[i] = i;
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](const u32 a, const u32 b) {
+    return sort_keys[a] > sort_keys[b];
+  });
+
+  std::vector<u32> result;
+  result.reserve(indices.size());
+
+  for(auto& cluster : order) {
+    result.insert(result.end(), indices.begin() + (clusters[cluster] * 3), indices.begin() + (clusters[cluster + 1] * 3));
+  }
+
+  return result;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const std::vector<u32> mesh_optimize_triangles(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices) {
+  if(indices.size() < 3) {
+    return indices;
+  }
+
+  std::vector<u32> result = tipsify(indices, vertices.size());
+  std::vector<u32> clusters = build_clusters(result, vertices.size());
+
+  return sort_clusters(vertices, result, clusters);
+}
+
+void mesh_optimize(std::vector<Vertex3D>& vertices, std::vector<u32>& indices) {
+  // Without any indices, the vertices are just a triangle list
+  if(indices.empty()) {
+    indices.resize(vertices.size());
+    for(u32 i = 0; i < vertices.size(); i++) {
+      indices[i] = i;
+    }
+  }
+
+  indices = mesh_optimize_triangles(vertices, indices);
+
+  // Give the vertices new indices in the order they are first used
+  std::vector<u32> remap(vertices.size(), UINT32_MAX);
+  std::vector<Vertex3D> new_vertices;
+  new_vertices.reserve(vertices.size());
+
+  for(auto& index : indices) {
+    if(remap[index] == UINT32_MAX) {
+      remap[index] = new_vertices.size();
+      new_vertices.push_back(vertices[index]);
+    }
+
+    index = remap[index];
+  }
+
+  vertices = new_vertices;
+}
+
+const f32 mesh_calc_acmr(const std::vector<u32>& indices, const u32 vertex_count, const u32 cache_size) {
+  if(indices.size() < 3) {
+    return 0.0f;
+  }
+
+  VertexCache cache;
+  cache_reset(cache, vertex_count, cache_size);
+
+  u32 misses = 0;
+  for(auto& index : indices) {
+    misses += cache_touch(cache, index);
+  }
+
+  return (f32)misses / (indices.size() / 3);
+}
+/////////////////////////////////////////////////////////////////////////////////
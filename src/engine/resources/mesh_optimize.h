@@ -0,0 +1,35 @@
+#pragma once
+
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define MESH_CACHE_SIZE 16 // The size of the post-transform vertex cache the meshes get optimized for
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Reorder the triangles to make good use of the post-transform vertex cache (Tipsify, by Sander et al.)
+ * and then sort the clusters of the new order so the triangles facing away from the center
+ * of the mesh get drawn first, which cuts down on overdraw.
+ *
+ * The vertices are left untouched, so the returned indices can be used with the same
+ * vertices (levels of detail, for example).
+ */
+const std::vector<u32> mesh_optimize_triangles(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices);
+
+/*
+ * Optimize the triangles with 'mesh_optimize_triangles' and then reorder the vertices
+ * in the order they are first used by the indices, so the vertex fetches are more
+ * or less linear. Any unused vertices are dropped.
+ */
+void mesh_optimize(std::vector<Vertex3D>& vertices, std::vector<u32>& indices);
+
+// The average cache miss ratio (transformed vertices per triangle) of a FIFO vertex cache with the given size.
+// Lower is better, where 0.5 is the ideal and 3 means that nothing hits the cache.
+const f32 mesh_calc_acmr(const std::vector<u32>& indices, const u32 vertex_count, const u32 cache_size = MESH_CACHE_SIZE);
+/////////////////////////////////////////////////////////////////////////////////
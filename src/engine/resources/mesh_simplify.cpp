@@ -0,0 +1,389 @@
+#include "mesh_simplify.h"
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define MAX_NORMAL_FLIP 0.2f // Any collapse that turns a triangle more than this (as a dot product) is rejected
+/////////////////////////////////////////////////////////////////////////////////
+
+// Quadric
+/////////////////////////////////////////////////////////////////////////////////
+// The upper half of a symmetric 4x4 matrix
+struct Quadric {
+  f64 a2, ab, ac, ad;
+  f64     b2, bc, bd;
+  f64         c2, cd;
+  f64             d2;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Collapse
+/////////////////////////////////////////////////////////////////////////////////
+// Removes 'from' by moving it onto 'to'
+struct Collapse {
+  f64 cost;
+  u32 from, to;
+  u32 from_version, to_version;
+
+  bool operator>(const Collapse& other) const {
+    return cost > other.cost;
+  }
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// SimplifyState
+/////////////////////////////////////////////////////////////////////////////////
+struct SimplifyState {
+  // Per welded vertex
+  std::vector<glm::vec3> positions;
+  std::vector<u32> original;   // The first of the original vertices with this position
+  std::vector<Quadric> quadrics;
+  std::vector<std::vector<u32>> triangles; // Triangles using this vertex
+  std::vector<u32> versions;
+  std::vector<bool> is_seam, is_border, is_removed;
+
+  // Per original vertex
+  std::vector<u32> next_original; // The next original vertex with the same position (-1 if none)
+
+  // Per triangle
+  std::vector<u32> corners;
+  std::vector<bool> is_alive;
+  u32 alive_count;
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static Quadric quadric_from_plane(const glm::dvec3& normal, const f64 d, const f64 weight) {
+  return Quadric {
+    normal.x * normal.x * weight, normal.x * normal.y * weight, normal.x * normal.z * weight, normal.x * d * weight,
+                                  normal.y * normal.y * weight, normal.y * normal.z * weight, normal.y * d * weight,
+                                                                normal.z * normal.z * weight, normal.z * d * weight,
+                                                                                              d * d * weight,
+  };
+}
+
+static void quadric_add(Quadric* q, const Quadric& other) {
+  q->a2 += other.a2; q->ab += other.ab; q->ac += other.ac; q->ad += other.ad;
+  q->b2 += other.b2; q->bc += other.bc; q->bd += other.bd;
+  q->c2 += other.c2; q->cd += other.cd;
+  q->d2 += other.d2;
+}
+
+static f64 quadric_error(const Quadric& q, const glm::vec3& pos) {
+  f64 x = pos.x, y = pos.y, z = pos.z;
+
+  return (q.a2 * x * x) + (2 * q.ab * x * y) + (2 * q.ac * x * z) + (2 * q.ad * x) +
+         (q.b2 * y * y) + (2 * q.bc * y * z) + (2 * q.bd * y) +
+         (q.c2 * z * z) + (2 * q.cd * z) +
+         q.d2;
+}
+
+static u64 edge_key(const u32 a, const u32 b) {
+  return ((u64)glm::min(a, b) << 32) | glm::max(a, b);
+}
+
+static void weld_vertices(SimplifyState& state, const std::vector<Vertex3D>& vertices, std::vector<u32>& remap) {
+  std::unordered_map<u64, u32> lookup;
+  std::vector<u32> last_original;
+  remap.resize(vertices.size());
+  state.next_original.assign(vertices.size(), (u32)-1);
+
+  for(u32 i = 0; i < vertices.size(); i++) {
+    const Vertex3D& vert = vertices[i];
+
+    // Hash the bits of the position. Only exact matches get welded.
+    u32 bits[3];
+    memcpy(bits, &vert.position, sizeof(bits));
+    u64 key = ((u64)bits[0] * 73856093) ^ ((u64)bits[1] * 19349663) ^ ((u64)bits[2] * 83492791);
+
+    // Walk through the collisions until the same position (or an empty slot) is found
+    auto it = lookup.find(key);
+    while(it != lookup.end() && state.positions[it->second] != vert.position) {
+      key++;
+      it = lookup.find(key);
+    }
+
+    if(it != lookup.end()) {
+      u32 welded = it->second;
+      remap[i]   = welded;
+
+      state.next_original[last_original[welded]] = i;
+      last_original[welded] = i;
+
+      // Same position, different attributes. Removing this vertex would tear the seam apart.
+      const Vertex3D& other = vertices[state.original[welded]];
+      if(other.normal != vert.normal || other.texture_coords != vert.texture_coords) {
+        state.is_seam[welded] = true;
+      }
+
+      continue;
+    }
+
+    remap[i]    = state.positions.size();
+    lookup[key] = remap[i];
+
+    state.positions.push_back(vert.position);
+    state.original.push_back(i);
+    last_original.push_back(i);
+    state.is_seam.push_back(false);
+  }
+
+  usizei count = state.positions.size();
+  state.quadrics.resize(count, Quadric{});
+  state.triangles.resize(count);
+  state.versions.resize(count, 0);
+  state.is_border.resize(count, false);
+  state.is_removed.resize(count, false);
+}
+
+static void gather_neighbours(const SimplifyState& state, const u32 vertex, std::vector<u32>& out) {
+  out.clear();
+
+  for(auto& tri : state.triangles[vertex]) {
+    if(!state.is_alive[tri]) {
+      continue;
+    }
+
+    for(u32 i = 0; i < 3; i++) {
+      u32 corner = state.corners[tri * 3 + i];
+      if(corner != vertex && std::find(out.begin(), out.end(), corner) == out.end()) {
+        out.push_back(corner);
+      }
+    }
+  }
+}
+
+static void push_collapse(SimplifyState& state, const u32 a, const u32 b) {
+  Quadric q = state.quadrics[a];
+  quadric_add(&q, state.quadrics[b]);
+
+  // Nothing can be moved onto a seam (the triangles would end up with the wrong attributes),
+  // and nothing on a seam or a border can be moved away.
+  bool a_to_b = !state.is_seam[a] && !state.is_border[a] && !state.is_seam[b];
+  bool b_to_a = !state.is_seam[b] && !state.is_border[b] && !state.is_seam[a];
+
+  f64 cost_a_to_b = a_to_b ? quadric_error(q, state.positions[b]) : -1.0;
+  f64 cost_b_to_a = b_to_a ? quadric_error(q, state.positions[a]) : -1.0;
+
+  if(a_to_b && (!b_to_a || cost_a_to_b <= cost_b_to_a)) {
+    state.collapses.push(Collapse{cost_a_to_b, a, b, state.versions[a], state.versions[b]});
+  }
+  else if(b_to_a) {
+    state.collapses.push(Collapse{cost_b_to_a, b, a, state.versions[b], state.versions[a]});
+  }
+}
+
+static bool is_collapse_valid(const SimplifyState& state, const u32 from, const u32 to, std::vector<u32>& from_ring, std::vector<u32>& to_ring) {
+  // The two vertices can only share the vertices opposite to the edge. 
+  // Sharing any more would create non-manifold geometry.
+  gather_neighbours(state, from, from_ring);
+  gather_neighbours(state, to, to_ring);
+
+  u32 shared = 0;
+  for(auto& vert : from_ring) {
+    if(std::find(to_ring.begin(), to_ring.end(), vert) != to_ring.end()) {
+      shared++;
+    }
+  }
+
+  if(shared > 2) {
+    return false;
+  }
+
+  // Make sure none of the remaining triangles get flipped or squashed
+  for(auto& tri : state.triangles[from]) {
+    if(!state.is_alive[tri]) {
+      continue;
+    }
+
+    const u32* corners = &state.corners[tri * 3];
+    if(corners[0] == to || corners[1] == to || corners[2] == to) {
+      continue; // This one will be removed anyway
+    }
+
+    glm::vec3 old_pos[3], new_pos[3];
+    for(u32 i = 0; i < 3; i++) {
+      old_pos[i] = state.positions[corners[i]];
+      new_pos[i] = (corners[i] == from) ? state.positions[to] : old_pos[i];
+    }
+
+    glm::vec3 old_normal = glm::cross(old_pos[1] - old_pos[0], old_pos[2] - old_pos[0]);
+    glm::vec3 new_normal = glm::cross(new_pos[1] - new_pos[0], new_pos[2] - new_pos[0]);
+
+    f32 old_len = glm::length(old_normal);
+    f32 new_len = glm::length(new_normal);
+    if(new_len <= 0.0f || old_len <= 0.0f) {
+      return false;
+    }
+
+    if(glm::dot(old_normal / old_len, new_normal / new_len) < MAX_NORMAL_FLIP) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static u32 get_matching_original(const SimplifyState& state, const std::vector<Vertex3D>& vertices, const u32 welded, const u32 corner_vertex) {
+  // Whichever vertex at the new position has the same attributes the corner had
+  const Vertex3D& vert = vertices[corner_vertex];
+  for(u32 i = state.original[welded]; i != (u32)-1; i = state.next_original[i]) {
+    if(vertices[i].normal == vert.normal && vertices[i].texture_coords == vert.texture_coords) {
+      return i;
+    }
+  }
+
+  return state.original[welded];
+}
+
+static void apply_collapse(SimplifyState& state, const u32 from, const u32 to) {
+  for(auto& tri : state.triangles[from]) {
+    if(!state.is_alive[tri]) {
+      continue;
+    }
+
+    u32* corners = &state.corners[tri * 3];
+
+    // The triangles on the collapsed edge disappear
+    if(corners[0] == to || corners[1] == to || corners[2] == to) {
+      state.is_alive[tri] = false;
+      state.alive_count--;
+
+      continue;
+    }
+
+    for(u32 i = 0; i < 3; i++) {
+      if(corners[i] == from) {
+        corners[i] = to;
+      }
+    }
+    state.triangles[to].push_back(tri);
+  }
+
+  quadric_add(&state.quadrics[to], state.quadrics[from]);
+
+  state.triangles[from].clear();
+  state.is_removed[from] = true;
+  state.versions[to]++;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const std::vector<u32> mesh_simplify(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices, const u32 target_index_count) {
+  SimplifyState state;
+
+  // Work on welded vertices so the triangles actually share their corners
+  std::vector<u32> remap;
+  weld_vertices(state, vertices, remap);
+
+  u32 indices_count = indices.empty() ? vertices.size() : indices.size();
+  state.corners.resize(indices_count);
+  for(u32 i = 0; i < indices_count; i++) {
+    state.corners[i] = remap[indices.empty() ? i : indices[i]];
+  }
+
+  u32 triangles_count = indices_count / 3;
+  state.is_alive.resize(triangles_count, true);
+  state.alive_count = triangles_count;
+
+  // Every vertex accumulates the planes of the triangles around it
+  std::unordered_map<u64, u32> edge_uses;
+  for(u32 tri = 0; tri < triangles_count; tri++) {
+    const u32* corners = &state.corners[tri * 3];
+
+    glm::dvec3 p0 = state.positions[corners[0]];
+    glm::dvec3 p1 = state.positions[corners[1]];
+    glm::dvec3 p2 = state.positions[corners[2]];
+
+    glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+    f64 area = glm::length(normal);
+    if(area > 0.0) {
+      normal /= area;
+    }
+
+    Quadric q = quadric_from_plane(normal, -glm::dot(normal, p0), area);
+    for(u32 i = 0; i < 3; i++) {
+      quadric_add(&state.quadrics[corners[i]], q);
+      state.triangles[corners[i]].push_back(tri);
+
+      edge_uses[edge_key(corners[i], corners[(i + 1) % 3])]++;
+    }
+  }
+
+  // Any edge that is not shared by exactly two triangles is a border
+  for(auto& [key, uses] : edge_uses) {
+    if(uses != 2) {
+      state.is_border[key >> 32]        = true;
+      state.is_border[key & 0xffffffff] = true;
+    }
+  }
+
+  // Queue up every edge
+  for(auto& [key, uses] : edge_uses) {
+    push_collapse(state, key >> 32, key & 0xffffffff);
+  }
+
+  // Collapse the cheapest edges first
+  std::vector<u32> from_ring, to_ring;
+  while((state.alive_count * 3) > target_index_count && !state.collapses.empty()) {
+    Collapse col = state.collapses.top();
+    state.collapses.pop();
+
+    // Outdated collapse
+    if(state.is_removed[col.from] || state.is_removed[col.to] ||
+       state.versions[col.from] != col.from_version || state.versions[col.to] != col.to_version) {
+      continue;
+    }
+
+    if(!is_collapse_valid(state, col.from, col.to, from_ring, to_ring)) {
+      continue;
+    }
+
+    apply_collapse(state, col.from, col.to);
+
+    // The edges around the new vertex have a new cost
+    gather_neighbours(state, col.to, to_ring);
+    for(auto& vert : to_ring) {
+      push_collapse(state, col.to, vert);
+    }
+  }
+
+  // Map the remaining corners back to the original vertices. The corners that were not moved 
+  // keep their own vertex, so the attribute seams survive on every level.
+  std::vector<u32> result;
+  result.reserve(state.alive_count * 3);
+
+  for(u32 tri = 0; tri < triangles_count; tri++) {
+    if(!state.is_alive[tri]) {
+      continue;
+    }
+
+    for(u32 i = 0; i < 3; i++) {
+      u32 index  = (tri * 3) + i;
+      u32 vertex = indices.empty() ? index : indices[index];
+
+      if(remap[vertex] == state.corners[index]) {
+        result.push_back(vertex);
+      }
+      else {
+        result.push_back(get_matching_original(state, vertices, state.corners[index], vertex));
+      }
+    }
+  }
+
+  return result;
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "defines.h"
+#include "math/vertex.h"
+
+#include <vector>
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Simplify the given triangles using quadric error metrics (Garland & Heckbert)
+ * until there are at most 'target_index_count' indices left or nothing else can be collapsed.
+ *
+ * Every collapse moves a vertex onto one of its neighbours, so the returned indices
+ * still index into 'vertices'. That means every level of detail can share the same vertices.
+ *
+ * NOTE: Vertices on a border or on an attribute seam (same position but a different
+ * normal or texture coords) are never removed, to keep holes and texture seams intact.
+ *
+ * NOTE: If 'indices' is empty, the vertices are treated as a triangle list.
+ */
+const std::vector<u32> mesh_simplify(const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices, const u32 target_index_count);
+/////////////////////////////////////////////////////////////////////////////////
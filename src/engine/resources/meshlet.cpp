@@ -0,0 +1,211 @@
+#include "meshlet.h"
+#include "defines.h"
+#include "math/vertex.h"
+#include "math/frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define MIN_CONE_SPREAD 0.1f // Any meshlet with normals spread wider than this (as a dot product) never gets cone culled
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void compute_bounds(Meshlet& meshlet, const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices) {
+  u32 first = meshlet.index_offset;
+  u32 last  = meshlet.index_offset + meshlet.index_count;
+
+  // The sphere around the box is not the tightest, but it is cheap and good enough
+  glm::vec3 min = vertices[indices[first]].position;
+  glm::vec3 max = min;
+  for(u32 i = first; i < last; i++) {
+    min = glm::min(min, vertices[indices[i]].position);
+    max = glm::max(max, vertices[indices[i]].position);
+  }
+
+  meshlet.center = (min + max) * 0.5f;
+  meshlet.radius = 0.0f;
+  for(u32 i = first; i < last; i++) {
+    meshlet.radius = glm::max(meshlet.radius, glm::length(vertices[indices[i]].position - meshlet.center));
+  }
+
+  // The average of the triangle normals is the axis of the cone
+  std::vector<glm::vec3> normals;
+  normals.reserve(meshlet.index_count / 3);
+
+  glm::vec3 axis(0.0f);
+  for(u32 i = first; i < last; i += 3) {
+    const glm::vec3& p0 = vertices[indices[i + 0]].position;
+    const glm::vec3& p1 = vertices[indices[i + 1]].position;
+    const glm::vec3& p2 = vertices[indices[i + 2]].position;
+
+    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+    if(glm::length(normal) <= 0.0f) {
+      continue;
+    }
+
+    normals.push_back(glm::normalize(normal));
+    axis += normals.back();
+  }
+
+  meshlet.cone_axis   = glm::vec3(0.0f, 0.0f, 1.0f);
+  meshlet.cone_cutoff = 1.0f;
+  if(normals.empty() || glm::length(axis) <= 0.0f) {
+    return;
+  }
+
+  meshlet.cone_axis = glm::normalize(axis);
+
+  // The widest angle between the axis and any of the normals
+  f32 min_dot = 1.0f;
+  for(auto& normal : normals) {
+    min_dot = glm::min(min_dot, glm::dot(normal, meshlet.cone_axis));
+  }
+
+  if(min_dot > MIN_CONE_SPREAD) {
+    meshlet.cone_cutoff = glm::sqrt(1.0f - (min_dot * min_dot));
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const std::vector<Meshlet> meshlet_build(const std::vector<Vertex3D>& vertices, std::vector<u32>& indices) {
+  std::vector<Meshlet> meshlets;
+  if(indices.size() < 3) {
+    return meshlets;
+  }
+
+  u32 triangle_count = indices.size() / 3;
+
+  // The triangles using each vertex
+  std::vector<u32> offsets(vertices.size() + 1, 0);
+  for(auto& index : indices) {
+    offsets[index + 1]++;
+  }
+  for(u32 i = 0; i < vertices.size(); i++) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  std::vector<u32> adjacency(indices.size());
+  std::vector<u32> cursors(offsets.begin(), offsets.end() - 1);
+  for(u32 i = 0; i < indices.size(); i++) {
+    adjacency[cursors[indices[i]]++] = i / 3;
+  }
+
+  std::vector<bool> is_used(triangle_count, false);
+  std::vector<u32> vertex_meshlets(vertices.size(), UINT32_MAX); // The meshlet each vertex was last added to
+  std::vector<u32> result;
+  result.reserve(indices.size());
+
+  std::vector<u32> meshlet_vertices;
+  u32 seed_cursor = 0;
+  i32 seed        = 0;
+
+  while(seed >= 0) {
+    u32 id = meshlets.size();
+
+    Meshlet meshlet      = {.index_offset = (u32)result.size()};
+    glm::vec3 center_sum = glm::vec3(0.0f);
+    meshlet_vertices.clear();
+
+    i32 next = seed;
+    while(next >= 0) {
+      // Add the triangle to the meshlet
+      for(u32 j = 0; j < 3; j++) {
+        u32 vertex = indices[next * 3 + j];
+        result.push_back(vertex);
+
+        if(vertex_meshlets[vertex] != id) {
+          vertex_meshlets[vertex] = id;
+          meshlet_vertices.push_back(vertex);
+          center_sum += vertices[vertex].position;
+        }
+      }
+
+      is_used[next]        = true;
+      meshlet.index_count += 3;
+
+      if((meshlet.index_count / 3) >= MESHLET_MAX_TRIANGLES) {
+        break;
+      }
+
+      // Grow into the neighbouring triangle that adds the fewest new vertices, 
+      // and out of those, the one closest to the center. That keeps the meshlets round.
+      glm::vec3 center = center_sum / (f32)meshlet_vertices.size();
+
+      next = -1;
+      u32 best_new_vertices = 3;
+      f32 best_distance     = 0.0f;
+
+      for(auto& vertex : meshlet_vertices) {
+        for(u32 k = offsets[vertex]; k < offsets[vertex + 1]; k++) {
+          u32 tri = adjacency[k];
+          if(is_used[tri]) {
+            continue;
+          }
+
+          u32 new_vertices = 0;
+          glm::vec3 tri_center(0.0f);
+          for(u32 j = 0; j < 3; j++) {
+            new_vertices += (vertex_meshlets[indices[tri * 3 + j]] != id);
+            tri_center   += vertices[indices[tri * 3 + j]].position;
+          }
+
+          if((meshlet_vertices.size() + new_vertices) > MESHLET_MAX_VERTICES) {
+            continue;
+          }
+
+          f32 distance = glm::length((tri_center / 3.0f) - center);
+          if(next < 0 || new_vertices < best_new_vertices || (new_vertices == best_new_vertices && distance < best_distance)) {
+            next              = tri;
+            best_new_vertices = new_vertices;
+            best_distance     = distance;
+          }
+        }
+      }
+    }
+
+    meshlets.push_back(meshlet);
+
+    // Start the next meshlet right next to this one, if possible
+    seed = -1;
+    for(u32 v = 0; v < meshlet_vertices.size() && seed < 0; v++) {
+      for(u32 k = offsets[meshlet_vertices[v]]; k < offsets[meshlet_vertices[v] + 1]; k++) {
+        if(!is_used[adjacency[k]]) {
+          seed = adjacency[k];
+          break;
+        }
+      }
+    }
+
+    while(seed < 0 && seed_cursor < triangle_count) {
+      if(!is_used[seed_cursor]) {
+        seed = seed_cursor;
+      }
+
+      seed_cursor++;
+    }
+  }
+
+  indices = result;
+  for(auto& meshlet : meshlets) {
+    compute_bounds(meshlet, vertices, indices);
+  }
+
+  return meshlets;
+}
+
+const bool meshlet_is_visible(const Meshlet& meshlet, const Frustum& frustum, const glm::vec3& camera_position) {
+  if(!frustum_intersects_sphere(frustum, meshlet.center, meshlet.radius)) {
+    return false;
+  }
+
+  // Back-facing if the camera is within the cone behind the meshlet
+  glm::vec3 to_center = meshlet.center - camera_position;
+  return glm::dot(to_center, meshlet.cone_axis) < (meshlet.cone_cutoff * glm::length(to_center)) + meshlet.radius;
+}
+/////////////////////////////////////////////////////////////////////////////////
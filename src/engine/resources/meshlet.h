@@ -0,0 +1,45 @@
+#pragma once
+
+#include "defines.h"
+#include "math/vertex.h"
+#include "math/frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define MESHLET_MAX_VERTICES  64
+#define MESHLET_MAX_TRIANGLES 124
+/////////////////////////////////////////////////////////////////////////////////
+
+// Meshlet
+/////////////////////////////////////////////////////////////////////////////////
+// A small cluster of neighbouring triangles that can be culled on its own
+struct Meshlet {
+  u32 index_offset, index_count; // Relative to the first index of the mesh
+
+  // Bounding sphere 
+  glm::vec3 center; 
+  f32 radius;
+
+  // Every triangle of the meshlet faces away from any point within the 
+  // cone around this axis. A cutoff of 1 means the cone is too wide to be of any use.
+  glm::vec3 cone_axis;
+  f32 cone_cutoff;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Split the triangles into meshlets of at most 'MESHLET_MAX_VERTICES' unique vertices and 
+// 'MESHLET_MAX_TRIANGLES' triangles. Every meshlet grows out over neighbouring triangles to keep it 
+// as small (and as flat) as possible. 
+// NOTE: The indices get reordered, so every meshlet ends up as one range of the indices.
+const std::vector<Meshlet> meshlet_build(const std::vector<Vertex3D>& vertices, std::vector<u32>& indices);
+
+// Returns 'false' if the meshlet is outside of the frustum or facing away from the camera. 
+// Both the frustum and the camera position should be in the local space of the mesh.
+const bool meshlet_is_visible(const Meshlet& meshlet, const Frustum& frustum, const glm::vec3& camera_position);
+/////////////////////////////////////////////////////////////////////////////////
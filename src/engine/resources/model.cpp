@@ -3,6 +3,7 @@
 #include "graphics/renderer.h"
 #include "math/vertex.h"
 #include "resources/mesh.h"
+#include "resources/mesh_optimize.h"
 #include "resources/material.h"
 #include "resources/resource_manager.h"
 #include "resources/texture.h"
@@ -11,8 +12,38 @@
 #include <glm/glm.hpp>
 
 #include <cstdio>
+#include <cstring>
 #include <vector>
 #include <string>
+#include <unordered_map>
+
+// VertexKey
+/////////////////////////////////////////////////////////////////////////////////
+// OBJ files index the positions, normals, and texture coords separately. Vertices 
+// that end up with the exact same attributes get merged into one.
+struct VertexKey {
+  Vertex3D vertex;
+
+  bool operator==(const VertexKey& other) const {
+    return memcmp(&vertex, &other.vertex, sizeof(Vertex3D)) == 0;
+  }
+};
+
+struct VertexKeyHash {
+  usizei operator()(const VertexKey& key) const {
+    // FNV-1a over the raw bytes of the vertex
+    const u8* bytes = (const u8*)&key.vertex;
+    u64 hash = 14695981039346656037ull;
+
+    for(u32 i = 0; i < sizeof(Vertex3D); i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+
+    return hash;
+  }
+};
+/////////////////////////////////////////////////////////////////////////////////
 
 // Private functions
 /////////////////////////////////////////////////////////////////////////////////
@@ -51,17 +82,19 @@ static const std::vector<Material*> load_materials(const std::vector<tinyobj::ma
   return mats;
 }
 
-static void load_model_data(Model* model, const tinyobj::ObjReader& reader, const tinyobj::ObjReaderConfig cfg) {
+static void load_model_data(Model* model, const tinyobj::ObjReader& reader, const tinyobj::ObjReaderConfig cfg, const std::vector<f32>& lod_ratios) {
   auto& shape = reader.GetShapes();
   auto& attrib = reader.GetAttrib();
   const auto& materials = reader.GetMaterials();
 
   model->materials = load_materials(materials, cfg); 
-  std::vector<Vertex3D> vertices;
-  std::vector<u32> indices;
 
   // Loop over the shapes
   for(u32 i = 0; i < shape.size(); i++) {
+    std::vector<Vertex3D> vertices;
+    std::vector<u32> indices;
+    std::unordered_map<VertexKey, u32, VertexKeyHash> unique_vertices;
+
     usizei index_offset = 0;
 
     // Loop over the faces
@@ -86,7 +119,7 @@ static void load_model_data(Model* model, const tinyobj::ObjReader& reader, cons
           tinyobj::real_t normal_x = attrib.normals[3 * usizei(index.normal_index) + 0];
           tinyobj::real_t normal_y = attrib.normals[3 * usizei(index.normal_index) + 1];
           tinyobj::real_t normal_z = attrib.normals[3 * usizei(index.normal_index) + 2];
-          vert.normal = glm::vec3(vert_x, vert_y, vert_z);
+          vert.normal = glm::vec3(normal_x, normal_y, normal_z);
         }
         else {
           vert.normal = glm::vec3(0.0f);
@@ -102,8 +135,13 @@ static void load_model_data(Model* model, const tinyobj::ObjReader& reader, cons
           vert.texture_coords = glm::vec2(0.0f);
         }
 
-        // New vertex
-        vertices.push_back(vert);
+        // New vertex (unless it was seen before)
+        auto [it, is_new] = unique_vertices.try_emplace(VertexKey{vert}, vertices.size());
+        if(is_new) {
+          vertices.push_back(vert);
+        }
+
+        indices.push_back(it->second);
       }
 
       // Advance to the next vertices
@@ -120,15 +158,22 @@ static void load_model_data(Model* model, const tinyobj::ObjReader& reader, cons
     */ 
     i32 id = shape[i].mesh.material_ids[i % shape[i].mesh.num_face_vertices.size()];
     
+    // Reorder the triangles and vertices for the vertex cache
+    model->acmrs_before.push_back(mesh_calc_acmr(indices, vertices.size()));
+    mesh_optimize(vertices, indices);
+    model->acmrs_after.push_back(mesh_calc_acmr(indices, vertices.size()));
+
     model->material_ids.push_back(id);
     model->meshes.push_back(mesh_create(vertices, indices));
+    mesh_build_lods(model->meshes.back(), lod_ratios);
+    mesh_build_meshlets(model->meshes.back());
   }
 }
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-Model* model_load(const std::string& path) {
+Model* model_load(const std::string& path, const std::vector<f32>& lod_ratios) {
   Model* model = new Model{};
 
   tinyobj::ObjReaderConfig reader_cfg;
@@ -145,7 +190,7 @@ Model* model_load(const std::string& path) {
     return model;
   }
 
-  load_model_data(model, reader, reader_cfg);
+  load_model_data(model, reader, reader_cfg, lod_ratios);
   return model;
 }
 
@@ -17,11 +17,18 @@ struct Model {
   std::vector<Mesh*> meshes;
   std::vector<Material*> materials;
   std::vector<u32> material_ids;
+
+  // The average cache miss ratio (see 'mesh_calc_acmr') of every mesh, before 
+  // and after it got optimized for the vertex cache. In the order of 'meshes'.
+  std::vector<f32> acmrs_before, acmrs_after;
 };
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-Model* model_load(const std::string& path);
+// Load the model at the given path and build a chain of levels of detail 
+// for each of its meshes using the given ratios (see 'mesh_build_lods').
+// NOTE: Pass an empty list to skip building the levels of detail.
+Model* model_load(const std::string& path, const std::vector<f32>& lod_ratios = {0.5f, 0.25f, 0.1f});
 void model_unload(Model* model);
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,223 @@
+#include "primitives.h"
+#include "defines.h"
+#include "math/vertex.h"
+#include "resources/mesh.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <vector>
+#include <unordered_map>
+
+// Primitives
+/////////////////////////////////////////////////////////////////////////////////
+struct Primitives {
+  Mesh* meshes[PRIMITIVES_MAX];
+};
+
+static Primitives s_primitives;
+/////////////////////////////////////////////////////////////////////////////////
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void push_triangle(const std::vector<Vertex3D>& vertices, std::vector<u32>& indices, const u32 a, const u32 b, const u32 c) {
+  // Rows that collapse into a pole produce triangles without any area. No need to draw those.
+  if(vertices[a].position == vertices[b].position || 
+     vertices[b].position == vertices[c].position || 
+     vertices[c].position == vertices[a].position) {
+    return;
+  }
+
+  indices.push_back(a);
+  indices.push_back(b);
+  indices.push_back(c);
+}
+
+// Connect a grid of (rows + 1) * (columns + 1) vertices with counter-clockwise triangles
+static void build_grid_indices(const std::vector<Vertex3D>& vertices, std::vector<u32>& indices, const u32 rows, const u32 columns) {
+  for(u32 r = 0; r < rows; r++) {
+    for(u32 c = 0; c < columns; c++) {
+      u32 top_left     = r * (columns + 1) + c;
+      u32 top_right    = top_left + 1;
+      u32 bottom_left  = top_left + (columns + 1);
+      u32 bottom_right = bottom_left + 1;
+
+      push_triangle(vertices, indices, top_left, bottom_left, top_right);
+      push_triangle(vertices, indices, top_right, bottom_left, bottom_right);
+    }
+  }
+}
+
+static glm::vec2 sphere_uv(const glm::vec3& normal) {
+  return glm::vec2(0.5f + glm::atan(normal.z, normal.x) / glm::two_pi<f32>(),
+                   0.5f + glm::asin(normal.y) / glm::pi<f32>());
+}
+
+static u32 icosphere_midpoint(std::vector<Vertex3D>& vertices, std::unordered_map<u64, u32>& cache, const u32 a, const u32 b) {
+  // The same edge is shared by two triangles, so the midpoint only gets created once
+  u64 key = ((u64)glm::min(a, b) << 32) | glm::max(a, b);
+
+  auto it = cache.find(key);
+  if(it != cache.end()) {
+    return it->second;
+  }
+
+  glm::vec3 normal = glm::normalize(vertices[a].normal + vertices[b].normal);
+  vertices.push_back(Vertex3D{normal * 0.5f, normal, sphere_uv(normal)});
+
+  cache[key] = vertices.size() - 1;
+  return vertices.size() - 1;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const bool primitives_create(const PrimitivesDesc& desc) {
+  s_primitives.meshes[PRIMITIVE_CUBE]      = mesh_create();
+  s_primitives.meshes[PRIMITIVE_UV_SPHERE] = primitive_create_uv_sphere(desc.sphere_segments, desc.sphere_rings);
+  s_primitives.meshes[PRIMITIVE_ICOSPHERE] = primitive_create_icosphere(desc.icosphere_subdivisions);
+  s_primitives.meshes[PRIMITIVE_PLANE]     = primitive_create_plane(desc.plane_subdivisions);
+  s_primitives.meshes[PRIMITIVE_CAPSULE]   = primitive_create_capsule(desc.capsule_segments, desc.capsule_rings);
+
+  return true;
+}
+
+void primitives_destroy() {
+  for(u32 i = 0; i < PRIMITIVES_MAX; i++) {
+    if(s_primitives.meshes[i]) {
+      mesh_destroy(s_primitives.meshes[i]);
+    }
+
+    s_primitives.meshes[i] = nullptr;
+  }
+}
+
+Mesh* primitives_get(const PrimitiveType type) {
+  return s_primitives.meshes[type];
+}
+
+Mesh* primitive_create_uv_sphere(const u32 segments, const u32 rings) {
+  u32 segs = glm::max(segments, 3u);
+  u32 rows = glm::max(rings, 2u);
+
+  std::vector<Vertex3D> vertices;
+  std::vector<u32> indices;
+
+  // NOTE: The first and last column share the same position but not the same
+  // texture coords. That is why there are (segs + 1) vertices per row.
+  for(u32 r = 0; r <= rows; r++) {
+    f32 phi = glm::pi<f32>() * ((f32)r / rows);
+
+    for(u32 s = 0; s <= segs; s++) {
+      f32 theta = glm::two_pi<f32>() * ((f32)s / segs);
+
+      glm::vec3 normal = glm::vec3(glm::sin(phi) * glm::cos(theta), glm::cos(phi), -glm::sin(phi) * glm::sin(theta));
+      vertices.push_back(Vertex3D{normal * 0.5f, normal, glm::vec2((f32)s / segs, 1.0f - (f32)r / rows)});
+    }
+  }
+
+  build_grid_indices(vertices, indices, rows, segs);
+  return mesh_create(vertices, indices);
+}
+
+Mesh* primitive_create_icosphere(const u32 subdivisions) {
+  std::vector<Vertex3D> vertices;
+  std::vector<u32> indices;
+
+  // The 12 corners of the icosahedron
+  const f32 t = (1.0f + glm::sqrt(5.0f)) / 2.0f;
+  const glm::vec3 corners[] = {
+    glm::vec3(-1.0f,  t, 0.0f), glm::vec3( 1.0f,  t, 0.0f), glm::vec3(-1.0f, -t, 0.0f), glm::vec3( 1.0f, -t, 0.0f),
+    glm::vec3(0.0f, -1.0f,  t), glm::vec3(0.0f,  1.0f,  t), glm::vec3(0.0f, -1.0f, -t), glm::vec3(0.0f,  1.0f, -t),
+    glm::vec3( t, 0.0f, -1.0f), glm::vec3( t, 0.0f,  1.0f), glm::vec3(-t, 0.0f, -1.0f), glm::vec3(-t, 0.0f,  1.0f),
+  };
+
+  for(auto& corner : corners) {
+    glm::vec3 normal = glm::normalize(corner);
+    vertices.push_back(Vertex3D{normal * 0.5f, normal, sphere_uv(normal)});
+  }
+
+  // The 20 faces of the icosahedron
+  indices = {
+    0, 11, 5,   0, 5, 1,   0, 1, 7,    0, 7, 10,  0, 10, 11,
+    1, 5, 9,    5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+    3, 9, 4,    3, 4, 2,   3, 2, 6,    3, 6, 8,   3, 8, 9,
+    4, 9, 5,    2, 4, 11,  6, 2, 10,   8, 6, 7,   9, 8, 1,
+  };
+
+  // Split every triangle into 4 smaller ones and push the new vertices out onto the sphere
+  for(u32 i = 0; i < subdivisions; i++) {
+    std::unordered_map<u64, u32> cache;
+    std::vector<u32> new_indices;
+    new_indices.reserve(indices.size() * 4);
+
+    for(u32 j = 0; j < indices.size(); j += 3) {
+      u32 a = indices[j + 0];
+      u32 b = indices[j + 1];
+      u32 c = indices[j + 2];
+
+      u32 ab = icosphere_midpoint(vertices, cache, a, b);
+      u32 bc = icosphere_midpoint(vertices, cache, b, c);
+      u32 ca = icosphere_midpoint(vertices, cache, c, a);
+
+      new_indices.insert(new_indices.end(), {a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca});
+    }
+
+    indices = new_indices;
+  }
+
+  return mesh_create(vertices, indices);
+}
+
+Mesh* primitive_create_plane(const u32 subdivisions) {
+  u32 cells = glm::max(subdivisions, 1u);
+
+  std::vector<Vertex3D> vertices;
+  std::vector<u32> indices;
+
+  // A flat plane on the XZ axis facing up
+  for(u32 z = 0; z <= cells; z++) {
+    for(u32 x = 0; x <= cells; x++) {
+      glm::vec2 uv = glm::vec2((f32)x / cells, (f32)z / cells);
+      vertices.push_back(Vertex3D{glm::vec3(uv.x - 0.5f, 0.0f, uv.y - 0.5f), glm::vec3(0.0f, 1.0f, 0.0f), uv});
+    }
+  }
+
+  build_grid_indices(vertices, indices, cells, cells);
+  return mesh_create(vertices, indices);
+}
+
+Mesh* primitive_create_capsule(const u32 segments, const u32 rings) {
+  u32 segs = glm::max(segments, 3u);
+  u32 rows = glm::max(rings, 1u);
+
+  // A radius of a quarter and a height of one keeps the capsule within the unit cube
+  const f32 radius      = 0.25f;
+  const f32 half_height = 0.5f - radius;
+
+  std::vector<Vertex3D> vertices;
+  std::vector<u32> indices;
+
+  // Two hemispheres, where the top one is pushed up and the bottom one is pushed down.
+  // The gap in between the two equators will be bridged by the grid, forming the cylinder.
+  for(u32 half = 0; half < 2; half++) {
+    f32 offset = (half == 0) ? half_height : -half_height;
+
+    for(u32 r = 0; r <= rows; r++) {
+      f32 phi = glm::half_pi<f32>() * (half + (f32)r / rows);
+
+      for(u32 s = 0; s <= segs; s++) {
+        f32 theta = glm::two_pi<f32>() * ((f32)s / segs);
+
+        glm::vec3 normal   = glm::vec3(glm::sin(phi) * glm::cos(theta), glm::cos(phi), -glm::sin(phi) * glm::sin(theta));
+        glm::vec3 position = normal * radius + glm::vec3(0.0f, offset, 0.0f);
+
+        vertices.push_back(Vertex3D{position, normal, glm::vec2((f32)s / segs, position.y + 0.5f)});
+      }
+    }
+  }
+
+  build_grid_indices(vertices, indices, (rows * 2) + 1, segs);
+  return mesh_create(vertices, indices);
+}
+/////////////////////////////////////////////////////////////////////////////////
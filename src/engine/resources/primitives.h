@@ -0,0 +1,57 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/mesh.h"
+
+// PrimitiveType
+/////////////////////////////////////////////////////////////////////////////////
+// A handle to one of the shared primitive meshes
+enum PrimitiveType {
+  PRIMITIVE_CUBE,
+  PRIMITIVE_UV_SPHERE,
+  PRIMITIVE_ICOSPHERE,
+  PRIMITIVE_PLANE,
+  PRIMITIVE_CAPSULE,
+  PRIMITIVES_MAX = 5,
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// PrimitivesDesc
+/////////////////////////////////////////////////////////////////////////////////
+// The tessellation levels of the shared primitives
+struct PrimitivesDesc {
+  u32 sphere_segments = 32; // Around the Y axis
+  u32 sphere_rings    = 16; // From pole to pole
+
+  u32 icosphere_subdivisions = 2;
+  u32 plane_subdivisions     = 1;
+
+  u32 capsule_segments = 24;
+  u32 capsule_rings    = 8; // Per hemisphere
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * The primitives are created once (by the renderer) and are shared by everyone
+ * who uses them. Since they are shared, any number of entities can reference the
+ * same primitive and all of their draws will get instanced together.
+ *
+ * NOTE: Every primitive fits inside of a unit cube centered at the origin.
+ * Just like the cube, they are meant to be scaled by the transform.
+ */
+const bool primitives_create(const PrimitivesDesc& desc = PrimitivesDesc{});
+void primitives_destroy();
+
+// Get the shared mesh of the given primitive.
+// NOTE: The returned mesh is owned by the primitives. Do NOT destroy it.
+Mesh* primitives_get(const PrimitiveType type);
+
+// Generate a new mesh with the given tessellation. These are used to create
+// the shared primitives, but can be used to create a standalone mesh as well.
+Mesh* primitive_create_uv_sphere(const u32 segments, const u32 rings);
+Mesh* primitive_create_icosphere(const u32 subdivisions);
+Mesh* primitive_create_plane(const u32 subdivisions);
+Mesh* primitive_create_capsule(const u32 segments, const u32 rings);
+/////////////////////////////////////////////////////////////////////////////////
@@ -146,10 +146,10 @@ Texture* resources_add_texture(const std::string& id, i32 width, i32 height, Tex
   return s_res_man.textures[id];
 }
 
-Font* resources_add_font(const std::string& path, const std::string& id) {
+Font* resources_add_font(const std::string& path, const std::string& id, const bool is_sdf) {
   std::string full_path = s_res_man.res_path + path; 
   
-  s_res_man.fonts[id] = font_load(full_path, 256.0f);
+  s_res_man.fonts[id] = font_load(full_path, is_sdf ? FONT_SDF_BASE_SIZE : 256.0f, is_sdf);
   return s_res_man.fonts[id];
 }
 
@@ -34,7 +34,8 @@ Shader* resources_add_shader(const std::string& id, const std::string& path);
 Shader* resources_add_shader(const std::string& id, const std::string& shader_name, const std::string& shader_code);
 Texture* resources_add_texture(const std::string& id, const std::string& path);
 Texture* resources_add_texture(const std::string& id, i32 width, i32 height, TextureFormat format, void* pixels);
-Font* resources_add_font(const std::string& path, const std::string& id);
+// NOTE: SDF fonts are generated at 'FONT_SDF_BASE_SIZE', and bitmap fonts at 256.
+Font* resources_add_font(const std::string& path, const std::string& id, const bool is_sdf = false);
 Mesh* resources_add_mesh(const std::string& id);
 Mesh* resources_add_mesh(const std::string& id, const std::vector<Vertex3D>& vertices, const std::vector<u32>& indices);
 Material* resources_add_material(const std::string& id, Texture* diffuse, Texture* specular, Shader* shader);
@@ -1,5 +1,6 @@
 #include "texture.h"
 #include "defines.h"
+#include "graphics/gl_state.h"
 
 #include <stb_image/stb_image.h>
 #include <glad/gl.h>
@@ -45,7 +46,7 @@ Texture* texture_load(const std::string& path) {
   texture->slot  = texture_slots++;
 
   glGenTextures(1, &texture->id);
-  glBindTexture(GL_TEXTURE_2D, texture->id);
+  gl_state_bind_texture_for_edit(GL_TEXTURE_2D, texture->id);
 
   stbi_set_flip_vertically_on_load(true);
   u8* data = stbi_load(path.c_str(), &texture->width, &texture->height, &texture->channels, 0);
@@ -84,7 +85,7 @@ Texture* texture_load(const std::string& path) {
   // Don't need the pixel data anymore, so free it. 
   stbi_image_free(data);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_state_bind_texture(GL_TEXTURE_2D, 0, 0);
   return texture;
 }
 
@@ -99,7 +100,7 @@ Texture* texture_load(i32 width, i32 height, TextureFormat format, void* pixels)
   texture->format   = format;
 
   glGenTextures(1, &texture->id);
-  glBindTexture(GL_TEXTURE_2D, texture->id);
+  gl_state_bind_texture_for_edit(GL_TEXTURE_2D, texture->id);
 
   if(pixels) {
     // Send the pixel data to the GPU and generate a mipmap
@@ -117,7 +118,7 @@ Texture* texture_load(i32 width, i32 height, TextureFormat format, void* pixels)
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
  
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_state_bind_texture(GL_TEXTURE_2D, 0, 0);
   return texture;
 }
 
@@ -127,6 +128,8 @@ void texture_unload(Texture* texture) {
   }
 
   glDeleteTextures(1, &texture->id);
+  gl_state_reset(); // The id might get reused by a new texture
+
   delete texture;
 
   texture = nullptr;
@@ -137,7 +140,6 @@ void texture_use(Texture* texture, i32 slot) {
     return;
   }
 
-  glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, texture->id);
+  gl_state_bind_texture(GL_TEXTURE_2D, slot, texture->id);
 }
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,171 @@
+#include "texture_atlas.h"
+#include "defines.h"
+#include "graphics/gl_state.h"
+#include "utils/atlas_packer.h"
+
+#include <stb_image/stb_image.h>
+#include <glad/gl.h>
+
+#include <cstdio>
+#include <string>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static u32 create_page_storage(const i32 size) {
+  u32 id;
+  glGenTextures(1, &id);
+  gl_state_bind_texture_for_edit(GL_TEXTURE_2D, id);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, size, size);
+
+  // Start out transparent, so the padding between the regions stays empty
+  u32 clear_color = 0;
+  glClearTexImage(id, 0, GL_RGBA, GL_UNSIGNED_BYTE, &clear_color);
+
+  // No mipmaps, since the smaller levels would mix the regions together
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  return id;
+}
+
+static Texture* create_page(const i32 size) {
+  Texture* page  = new Texture{};
+  page->id       = create_page_storage(size);
+  page->width    = size;
+  page->height   = size;
+  page->channels = 4;
+  page->format   = TEXTURE_FORMAT_RGBA;
+
+  return page;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+TextureAtlas* texture_atlas_create(const i32 page_size, const i32 padding, const u32 max_pages) {
+  TextureAtlas* atlas = new TextureAtlas{};
+  atlas->page_size    = page_size;
+  atlas->padding      = padding;
+  atlas->max_pages    = max_pages;
+
+  return atlas;
+}
+
+void texture_atlas_destroy(TextureAtlas* atlas) {
+  if(!atlas) {
+    return;
+  }
+
+  for(auto& page : atlas->pages) {
+    texture_unload(page);
+  }
+
+  delete atlas;
+}
+
+const bool texture_atlas_add(TextureAtlas* atlas, const i32 width, const i32 height, const void* pixels, AtlasRegion* out_region) {
+  // The padding goes on all sides of the region
+  i32 padded_width  = width + (atlas->padding * 2);
+  i32 padded_height = height + (atlas->padding * 2);
+
+  if(padded_width > atlas->page_size || padded_height > atlas->page_size) {
+    fprintf(stderr, "[ERROR]: A %ix%i texture does not fit in the atlas pages\n", width, height);
+    return false;
+  }
+
+  // Try the pages that are there first, and only then make a new one
+  glm::ivec2 position;
+  i32 page_index = -1;
+
+  for(u32 i = 0; i < atlas->packers.size(); i++) {
+    if(atlas_packer_pack(&atlas->packers[i], padded_width, padded_height, &position)) {
+      page_index = i;
+      break;
+    }
+  }
+
+  if(page_index == -1) {
+    if(atlas->max_pages != 0 && atlas->pages.size() >= atlas->max_pages) {
+      return false;
+    }
+
+    AtlasPacker packer;
+    atlas_packer_create(&packer, atlas->page_size, atlas->page_size);
+    atlas_packer_pack(&packer, padded_width, padded_height, &position);
+
+    atlas->packers.push_back(packer);
+    atlas->pages.push_back(create_page(atlas->page_size));
+
+    page_index = atlas->pages.size() - 1;
+  }
+
+  position += glm::ivec2(atlas->padding);
+
+  Texture* page = atlas->pages[page_index];
+  gl_state_bind_texture_for_edit(GL_TEXTURE_2D, page->id);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+  f32 size = (f32)atlas->page_size;
+
+  out_region->page    = page;
+  out_region->uv_rect = glm::vec4(position.x / size, position.y / size, width / size, height / size);
+  out_region->width   = width;
+  out_region->height  = height;
+
+  return true;
+}
+
+void texture_atlas_grow(TextureAtlas* atlas, const i32 page_size) {
+  if(page_size <= atlas->page_size) {
+    return;
+  }
+
+  for(u32 i = 0; i < atlas->pages.size(); i++) {
+    Texture* page = atlas->pages[i];
+
+    u32 id = create_page_storage(page_size);
+    glCopyImageSubData(page->id, GL_TEXTURE_2D, 0, 0, 0, 0, 
+                       id, GL_TEXTURE_2D, 0, 0, 0, 0, 
+                       page->width, page->height, 1);
+
+    glDeleteTextures(1, &page->id);
+    page->id     = id;
+    page->width  = page_size;
+    page->height = page_size;
+
+    atlas_packer_grow(&atlas->packers[i], page_size, page_size);
+  }
+
+  // The old ids might get reused by new textures
+  gl_state_reset();
+  atlas->page_size = page_size;
+}
+
+void texture_atlas_clear(TextureAtlas* atlas) {
+  u32 clear_color = 0;
+
+  for(u32 i = 0; i < atlas->pages.size(); i++) {
+    glClearTexImage(atlas->pages[i]->id, 0, GL_RGBA, GL_UNSIGNED_BYTE, &clear_color);
+    atlas_packer_reset(&atlas->packers[i]);
+  }
+}
+
+const bool texture_atlas_add(TextureAtlas* atlas, const std::string& path, AtlasRegion* out_region) {
+  i32 width, height, channels;
+
+  // Same orientation as 'texture_load'
+  stbi_set_flip_vertically_on_load(true);
+  u8* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+  if(!pixels) {
+    fprintf(stderr, "[ERROR]: Failed to load texture at \'%s\'\n", path.c_str());
+    return false;
+  }
+
+  bool result = texture_atlas_add(atlas, width, height, pixels, out_region);
+  stbi_image_free(pixels);
+
+  return result;
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/texture.h"
+#include "utils/atlas_packer.h"
+
+#include <glm/vec4.hpp>
+
+#include <string>
+#include <vector>
+
+// AtlasRegion
+/////////////////////////////////////////////////////////////////////////////////
+// Where a texture ended up in the atlas
+struct AtlasRegion {
+  Texture* page = nullptr;
+  glm::vec4 uv_rect; // The offset and size of the region within the page, in normalized coords
+  i32 width, height; // In pixels
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// TextureAtlas
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Packs many small textures into a few big pages at runtime, so anything drawn with 
+ * them can share the same few texture slots (and batches) in the 2D renderer.
+ *
+ * A texture gets registered once and is then referred to by its 'AtlasRegion' (the page
+ * and the UV rect inside of it). A new page is added whenever the current ones are full.
+ *
+ * NOTE: The pages are RGBA8 without any mipmaps. Regions are kept 'padding' pixels apart, 
+ * so the linear filtering of one region does not bleed into its neighbours.
+ */
+struct TextureAtlas {
+  std::vector<Texture*> pages;
+  std::vector<AtlasPacker> packers;
+
+  i32 page_size, padding;
+  u32 max_pages; // No limit if 0
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+TextureAtlas* texture_atlas_create(const i32 page_size = 2048, const i32 padding = 1, const u32 max_pages = 0);
+void texture_atlas_destroy(TextureAtlas* atlas);
+
+// Add the RGBA8 pixels to the atlas. Like 'texture_load', the rows go from the bottom to the top.
+// Returns 'false' if the texture is bigger than a page, or if every page is full and 'max_pages' is reached.
+const bool texture_atlas_add(TextureAtlas* atlas, const i32 width, const i32 height, const void* pixels, AtlasRegion* out_region);
+
+// Load the image at 'path' and add it to the atlas
+const bool texture_atlas_add(TextureAtlas* atlas, const std::string& path, AtlasRegion* out_region);
+
+// Make every page 'page_size' big, keeping what is already in them. The 'Texture' of every page 
+// stays the same, but it gets a new GL texture.
+// NOTE: Regions keep their place in pixels, so their UV rects have to be scaled by the old size over the new one.
+// NOTE: Anything that still has to draw with the old UV rects must be drawn before.
+void texture_atlas_grow(TextureAtlas* atlas, const i32 page_size);
+
+// Take everything out of the pages, but keep the pages around.
+// NOTE: Anything that still has to draw with the old regions must be drawn before.
+void texture_atlas_clear(TextureAtlas* atlas);
+/////////////////////////////////////////////////////////////////////////////////
@@ -29,6 +29,8 @@ void ui_button_create(UIButton* button,
   button->color = button_color;
   button->is_active = true;
   button->is_disabled = false;
+  button->is_hovered = false;
+  button->is_pressed = false;
 
   button->user_data = nullptr;
   button->callback = nullptr;
@@ -45,31 +47,48 @@ bool ui_button_pressed(UIButton* button) {
   return ui_button_hovered(button) && input_button_down(MOUSE_BUTTON_LEFT);
 }
 
-void ui_button_render(UIButton* button) {
+void ui_button_update(UIButton* button) {
   if(!button->is_active) {
     return;
   }
 
-  if(ui_button_pressed(button)) {
-    button->color.a = 0.25f;
+  button->is_pressed = ui_button_pressed(button);
+  button->is_hovered = button->is_pressed || ui_button_hovered(button);
+  ui_button_update_color(button);
 
+  if(button->is_pressed) {
     if(button->callback) {
       button->callback(button, BUTTON_STATE_PRESSED, button->user_data);
     }
   }
-  else if(ui_button_hovered(button)) {
-    button->color.a = 0.5f;
-    
+  else if(button->is_hovered) {
     if(button->callback) {
       button->callback(button, BUTTON_STATE_HOVERED, button->user_data);
     }
   }
+}
+
+void ui_button_update_color(UIButton* button) {
+  if(button->is_pressed) {
+    button->color.a = 0.25f;
+  }
+  else if(button->is_hovered) {
+    button->color.a = 0.5f;
+  }
   else if(button->is_disabled) {
     button->color.a = 0.1f;
   }
   else {
     button->color.a = 1.0f;
   }
+}
+
+void ui_button_render(UIButton* button) {
+  if(!button->is_active) {
+    return;
+  }
+
+  ui_button_update(button);
 
   render_quad(button->position + button->size / 2.0f, button->size, button->color);
   ui_text_render(&button->text);
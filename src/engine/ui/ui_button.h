@@ -34,6 +34,7 @@ struct UIButton {
   glm::vec4 color;
 
   bool is_active, is_disabled;
+  bool is_hovered, is_pressed; // As of the last update
 
   void* user_data; 
   UIButtonCallback callback;
@@ -52,5 +53,12 @@ void ui_button_create(UIButton* button,
                       const glm::vec2 offset = glm::vec2(0.0f));
 bool ui_button_hovered(UIButton* button);
 bool ui_button_pressed(UIButton* button);
+
+// Test the button against the mouse, call its callback, and set its color's alpha to match its state.
+// NOTE: 'ui_button_render' already calls this function.
+void ui_button_update(UIButton* button);
+
+// Set the alpha of the button's color to match its hovered, pressed, or disabled state.
+void ui_button_update_color(UIButton* button);
 void ui_button_render(UIButton* button);
 /////////////////////////////////////////////////////////////////////////////////
@@ -2,7 +2,14 @@
 #include "ui/ui_text.h"
 #include "ui/ui_button.h"
 #include "ui/ui_anchor.h"
+#include "ui/ui_hit_grid.h"
+#include "ui/ui_layout.h"
+#include "ui/ui_list.h"
 #include "resources/font.h"
+#include "graphics/renderer2d.h"
+#include "core/window.h"
+#include "core/render_thread.h"
+#include "core/input.h"
 #include "defines.h"
 
 #include <glm/vec2.hpp>
@@ -10,6 +17,256 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static u32 get_atlas_generation(UICanvas* canvas) {
+  // The elements fall back to the default font when the canvas has none
+  Font* font = canvas->font ? canvas->font : renderer2d_get_default_font();
+  return font ? font->atlas_generation : 0;
+}
+
+static bool is_text_changed(const UIText& text, const UIElementCache& cache) {
+  return text.is_dirty || 
+         text.is_active != cache.is_active || 
+         text.position != cache.position || 
+         text.color != cache.color;
+}
+
+static bool is_button_changed(const UIButton& button, const UIElementCache& cache) {
+  return button.text.is_dirty || 
+         button.is_active != cache.is_active || 
+         button.position != cache.position || 
+         button.size != cache.size || 
+         button.is_hovered != cache.is_hovered || 
+         button.is_pressed != cache.is_pressed || 
+         button.is_disabled != cache.is_disabled || 
+         button.color != cache.color || 
+         button.text.color != cache.text_color;
+}
+
+static void push_text(QuadCache* geometry, UIText& text, UIElementCache* cache) {
+  cache->first      = geometry->vertices.size();
+  cache->position   = text.position;
+  cache->color      = text.color;
+  cache->is_active  = text.is_active;
+
+  if(text.is_active) {
+    quad_cache_push_text(geometry, &text.layout, text.position, text.color);
+  }
+
+  cache->count  = geometry->vertices.size() - cache->first;
+  text.is_dirty = false;
+}
+
+static void push_button(QuadCache* geometry, UIButton& button, UIElementCache* cache) {
+  ui_button_update_color(&button);
+
+  cache->first      = geometry->vertices.size();
+  cache->position   = button.position;
+  cache->size       = button.size;
+  cache->color      = button.color;
+  cache->text_color = button.text.color;
+  cache->is_active   = button.is_active;
+  cache->is_hovered  = button.is_hovered;
+  cache->is_pressed  = button.is_pressed;
+  cache->is_disabled = button.is_disabled;
+
+  if(button.is_active) {
+    quad_cache_push_quad(geometry, button.position + button.size / 2.0f, button.size, button.color);
+    quad_cache_push_text(geometry, &button.text.layout, button.text.position, button.text.color);
+  }
+
+  cache->count         = geometry->vertices.size() - cache->first;
+  button.text.is_dirty = false;
+}
+
+static void update_layouts(UICanvas* canvas, const bool only_dirty) {
+  for(auto& button : canvas->buttons) {
+    if(!only_dirty || button.text.is_dirty) {
+      ui_text_measure_size(&button.text);
+    }
+  }
+
+  for(auto& text : canvas->texts) {
+    if(!only_dirty || text.is_dirty) {
+      ui_text_measure_size(&text);
+    }
+  }
+}
+
+static void rebuild_all(UICanvas* canvas) {
+  // Adding new glyphs to the atlas could move the ones that were laid out before them
+  u32 generation = get_atlas_generation(canvas);
+  update_layouts(canvas, false);
+  if(get_atlas_generation(canvas) != generation) {
+    update_layouts(canvas, false);
+  }
+
+  canvas->geometry.vertices.clear();
+  canvas->caches.resize(canvas->buttons.size() + canvas->texts.size());
+
+  for(u32 i = 0; i < canvas->buttons.size(); i++) {
+    push_button(&canvas->geometry, canvas->buttons[i], &canvas->caches[i]);
+  }
+
+  for(u32 i = 0; i < canvas->texts.size(); i++) {
+    push_text(&canvas->geometry, canvas->texts[i], &canvas->caches[canvas->buttons.size() + i]);
+  }
+
+  canvas->atlas_generation  = get_atlas_generation(canvas);
+  canvas->is_dirty          = false;
+  canvas->is_hit_grid_dirty = true;
+}
+
+static bool rebuild_changed(UICanvas* canvas) {
+  u32 generation = get_atlas_generation(canvas);
+  update_layouts(canvas, true);
+
+  // The glyphs of the elements that did not change moved too
+  if(get_atlas_generation(canvas) != generation) {
+    return false;
+  }
+
+  QuadCache scratch;
+  scratch.texture       = canvas->geometry.texture;
+  scratch.texture_index = canvas->geometry.texture_index;
+
+  // The elements that still take up the same number of quads are made again in place
+  for(u32 i = 0; i < canvas->caches.size(); i++) {
+    UIElementCache& cache = canvas->caches[i];
+    UIElementCache new_cache;
+    
+    scratch.vertices.clear();
+    if(i < canvas->buttons.size()) {
+      UIButton& button = canvas->buttons[i];
+      if(!is_button_changed(button, cache)) {
+        continue;
+      }
+
+      if(button.position != cache.position || button.size != cache.size || button.is_active != cache.is_active) {
+        canvas->is_hit_grid_dirty = true;
+      }
+
+      push_button(&scratch, button, &new_cache);
+    }
+    else {
+      UIText& text = canvas->texts[i - canvas->buttons.size()];
+      if(!is_text_changed(text, cache)) {
+        continue;
+      }
+
+      push_text(&scratch, text, &new_cache);
+    }
+
+    if(new_cache.count != cache.count) {
+      return false;
+    }
+
+    new_cache.first = cache.first;
+    cache           = new_cache;
+    std::copy(scratch.vertices.begin(), scratch.vertices.end(), canvas->geometry.vertices.begin() + cache.first);
+  }
+
+  return true;
+}
+
+static void move_changed_nodes(UICanvas* canvas) {
+  // Only the elements that actually moved
+  for(auto& index : canvas->layout.changed_nodes) {
+    const UILayoutNode& node = canvas->layout.nodes[index];
+    if(node.user_index == -1) {
+      continue;
+    }
+
+    u32 element = node.user_index >> 1;
+    if((node.user_index & 1) == 0) {
+      canvas->texts[element].position = node.position;
+      continue;
+    }
+
+    UIButton& button    = canvas->buttons[element];
+    button.position      = node.position;
+    button.size          = node.size;
+    button.text.position = node.position + (node.size - ui_text_measure_size(&button.text)) / 2.0f;
+
+    // The buttons are looked up by where they are
+    canvas->is_hit_grid_dirty = true;
+  }
+}
+
+static void update_layout(UICanvas* canvas) {
+  // Texts that changed might take up a different size now
+  for(auto& button : canvas->buttons) {
+    if(button.text.layout_node != -1 && button.text.is_dirty) {
+      ui_layout_set_content_size(&canvas->layout, button.text.layout_node, ui_text_measure_size(&button.text) + 10.0f);
+    }
+  }
+
+  for(auto& text : canvas->texts) {
+    if(text.layout_node != -1 && text.is_dirty) {
+      ui_layout_set_content_size(&canvas->layout, text.layout_node, ui_text_measure_size(&text));
+    }
+  }
+
+  if(ui_layout_solve(&canvas->layout)) {
+    move_changed_nodes(canvas);
+  }
+
+  // A new string has to be centered again, even if its button stayed the same size (and did not move)
+  for(auto& button : canvas->buttons) {
+    if(button.text.layout_node != -1 && button.text.is_dirty) {
+      button.text.position = button.position + (button.size - ui_text_measure_size(&button.text)) / 2.0f;
+    }
+  }
+}
+
+static void update_hovered_button(UICanvas* canvas, const bool is_grid_rebuilt) {
+  glm::vec2 mouse_pos = input_mouse_pos();
+
+  // The button under the mouse can only change when either of them moves
+  i32 hovered = canvas->hovered_button;
+  if(is_grid_rebuilt || mouse_pos != canvas->mouse_pos) {
+    hovered = ui_hit_grid_query(&canvas->hit_grid, canvas->buttons, mouse_pos);
+    canvas->mouse_pos = mouse_pos;
+  }
+
+  if(hovered != -1 && !canvas->buttons[hovered].is_active) {
+    hovered = -1;
+  }
+
+  if(hovered != canvas->hovered_button && canvas->hovered_button != -1) {
+    UIButton& last_button = canvas->buttons[canvas->hovered_button];
+    last_button.is_hovered = false;
+    last_button.is_pressed = false;
+  }
+
+  canvas->hovered_button = hovered;
+  if(hovered == -1) {
+    return;
+  }
+
+  UIButton* button = &canvas->buttons[hovered];
+  bool was_hovered = button->is_hovered;
+  bool was_pressed = button->is_pressed;
+
+  button->is_hovered = true;
+  button->is_pressed = input_button_down(MOUSE_BUTTON_LEFT);
+
+  if(!button->callback) {
+    return;
+  }
+
+  // NOTE: The callback might push more buttons, so 'button' cannot be used after it
+  if(button->is_pressed && !was_pressed) {
+    button->callback(button, BUTTON_STATE_PRESSED, button->user_data);
+  }
+  else if(!button->is_pressed && (!was_hovered || was_pressed)) {
+    button->callback(button, BUTTON_STATE_HOVERED, button->user_data);
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +277,11 @@ UICanvas* ui_canvas_create(Font* font, const bool active) {
   canvas->offset = glm::vec2(0.0f);
   canvas->current_offset = glm::vec2(0.0f);
   canvas->current_anchor = UI_ANCHOR_TOP_LEFT;
+  canvas->window_size = window_get_size();
+  canvas->is_dirty = true;
+  canvas->is_hit_grid_dirty = true;
+  canvas->hovered_button = -1;
+  ui_layout_create(&canvas->layout, canvas->window_size);
 
   return canvas;
 }
@@ -27,6 +289,9 @@ UICanvas* ui_canvas_create(Font* font, const bool active) {
 void ui_canvas_destroy(UICanvas* canvas) {
   canvas->texts.clear();
   canvas->buttons.clear();
+  canvas->lists.clear();
+  canvas->caches.clear();
+  canvas->hit_grid.indices.clear();
 
   delete canvas;
 }
@@ -60,8 +325,9 @@ UIText& ui_canvas_push_text(UICanvas* canvas,
 
   canvas->texts.push_back(txt);
   canvas->current_offset += offset; 
+  canvas->is_dirty = true;
 
-  return *canvas->texts.end();
+  return canvas->texts.back();
 }
 
 UIText& ui_canvas_push_text(UICanvas* canvas, 
@@ -94,8 +360,9 @@ UIButton& ui_canvas_push_button(UICanvas* canvas,
 
   canvas->buttons.push_back(button);
   canvas->current_offset += offset; 
+  canvas->is_dirty = true;
 
-  return *canvas->buttons.end();
+  return canvas->buttons.back();
 }
 
 UIButton& ui_canvas_push_button(UICanvas* canvas, 
@@ -116,17 +383,115 @@ UIButton& ui_canvas_push_button(UICanvas* canvas,
                                canvas->offset);
 }
 
+const i32 ui_canvas_push_layout(UICanvas* canvas, const i32 parent, const UILayoutStyle& style) {
+  return ui_layout_push_node(&canvas->layout, parent, style);
+}
+
+UIText& ui_canvas_push_layout_text(UICanvas* canvas, 
+                                   const std::string& text, 
+                                   const f32 font_size,
+                                   const glm::vec4& text_color, 
+                                   const i32 parent, 
+                                   const UILayoutStyle& style) {
+  UIText txt; 
+  ui_text_create(&txt, canvas->font, text, font_size, UI_ANCHOR_TOP_LEFT, text_color);
+
+  txt.layout_node = ui_layout_push_node(&canvas->layout, parent, style);
+  canvas->layout.nodes[txt.layout_node].user_index = canvas->texts.size() << 1;
+
+  canvas->texts.push_back(txt);
+  canvas->is_dirty = true;
+
+  return canvas->texts.back();
+}
+
+UIButton& ui_canvas_push_layout_button(UICanvas* canvas, 
+                                       const std::string& text, 
+                                       const f32 font_size,
+                                       const glm::vec4& button_color, 
+                                       const glm::vec4& text_color, 
+                                       void* user_data, 
+                                       UIButtonCallback callback,
+                                       const i32 parent, 
+                                       const UILayoutStyle& style) {
+  UIButton button; 
+  ui_button_create(&button, canvas->font, text, font_size, UI_ANCHOR_TOP_LEFT, button_color, text_color);
+  button.user_data = user_data;
+  button.callback = callback;
+
+  button.text.layout_node = ui_layout_push_node(&canvas->layout, parent, style);
+  canvas->layout.nodes[button.text.layout_node].user_index = (canvas->buttons.size() << 1) | 1;
+
+  canvas->buttons.push_back(button);
+  canvas->is_dirty = true;
+
+  return canvas->buttons.back();
+}
+
+UIList& ui_canvas_push_list(UICanvas* canvas, 
+                            const glm::vec2& position, 
+                            const glm::vec2& size, 
+                            const f32 row_height, 
+                            const f32 font_size, 
+                            const glm::vec4& text_color, 
+                            const u32 items_count, 
+                            UIListRowCallback callback, 
+                            void* user_data) {
+  UIList list;
+  ui_list_create(&list, canvas->font, position, size, row_height, font_size, text_color, items_count, callback, user_data);
+
+  canvas->lists.push_back(list);
+  return canvas->lists.back();
+}
+
 void ui_canvas_render(UICanvas* canvas) {
   if(!canvas->is_active) {
     return;
   }
 
-  for(auto& button : canvas->buttons) {
-    ui_button_render(&button);
+  // Everything is anchored to the window, so it all has to move with it
+  glm::vec2 window_size = render_thread_get_viewport_size();
+  if(canvas->window_size != window_size) {
+    for(auto& button : canvas->buttons) {
+      if(button.text.layout_node == -1) {
+        ui_text_set_position(&button.text, button.text.anchor);
+        button.position = button.text.position - 8.0f;
+      }
+    }
+
+    for(auto& text : canvas->texts) {
+      if(text.layout_node == -1) {
+        ui_text_set_position(&text, text.anchor);
+      }
+    }
+
+    ui_layout_set_size(&canvas->layout, window_size);
+    canvas->window_size = window_size;
+    canvas->is_dirty    = true;
+  }
+
+  if(canvas->atlas_generation != get_atlas_generation(canvas)) {
+    canvas->is_dirty = true;
   }
+
+  update_layout(canvas);
   
-  for(auto& text : canvas->texts) {
-    ui_text_render(&text);
+  bool is_grid_rebuilt = canvas->is_dirty || canvas->is_hit_grid_dirty;
+  if(is_grid_rebuilt) {
+    ui_hit_grid_build(&canvas->hit_grid, canvas->buttons, window_size);
+    canvas->is_hit_grid_dirty = false;
+  }
+
+  update_hovered_button(canvas, is_grid_rebuilt);
+
+  if(canvas->is_dirty || !rebuild_changed(canvas)) {
+    rebuild_all(canvas);
+  }
+
+  render_quad_cache(&canvas->geometry);
+
+  for(auto& list : canvas->lists) {
+    ui_list_render(&list);
   }
 }
 
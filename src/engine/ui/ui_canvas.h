@@ -3,7 +3,11 @@
 #include "ui/ui_text.h"
 #include "ui/ui_button.h"
 #include "ui/ui_anchor.h"
+#include "ui/ui_hit_grid.h"
+#include "ui/ui_layout.h"
+#include "ui/ui_list.h"
 #include "resources/font.h"
+#include "graphics/renderer2d.h"
 #include "defines.h"
 
 #include <glm/vec2.hpp>
@@ -12,8 +16,35 @@
 #include <vector>
 #include <string>
 
+// UIElementCache
+/////////////////////////////////////////////////////////////////////////////////
+// What an element of the canvas looked like the last time its quads were made
+struct UIElementCache {
+  u32 first, count; // Into the vertices of the canvas' geometry
+
+  glm::vec2 position, size;
+  glm::vec4 color, text_color;
+  bool is_active, is_hovered, is_pressed, is_disabled;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
 // UICanvas
 /////////////////////////////////////////////////////////////////////////////////
+/*
+ * The quads of every element are kept around between frames, and only the elements that changed 
+ * (through 'ui_text_set_string', their hover state, their color, or their position) are made again. 
+ * A new element, a new font atlas, or a resized window make the whole canvas again.
+ *
+ * The buttons are found under the mouse through a grid (see 'UIHitGrid'), so only the one button 
+ * under it is ever tested. Its callback is only called when its state changes (when it gets 
+ * hovered, pressed, or released), and not on every frame.
+ *
+ * Elements pushed with 'ui_canvas_push_layout_text' and 'ui_canvas_push_layout_button' are placed 
+ * by the canvas' layout instead of their anchor. The 'user_index' of their node is the index of the 
+ * element shifted left by one, with the lowest bit set for buttons.
+ *
+ * Lists are drawn after everything else, and only ever draw the rows in view (see 'UIList').
+ */
 struct UICanvas {
   Font* font;
   bool is_active;
@@ -23,6 +54,22 @@ struct UICanvas {
 
   std::vector<UIText> texts;
   std::vector<UIButton> buttons;
+  std::vector<UIList> lists;
+
+  QuadCache geometry;
+  std::vector<UIElementCache> caches; // The buttons first, then the texts
+  
+  glm::vec2 window_size;
+  u32 atlas_generation;
+  bool is_dirty; // Can be set to make the whole canvas again on the next render
+
+  UIHitGrid hit_grid;
+  bool is_hit_grid_dirty; // Set when any button moves or gets (de)activated
+  
+  i32 hovered_button; // -1 if none
+  glm::vec2 mouse_pos;
+
+  UILayout layout; // The root always covers the window
 };
 /////////////////////////////////////////////////////////////////////////////////
 
@@ -62,5 +109,40 @@ UIButton& ui_canvas_push_button(UICanvas* canvas,
                                 void* user_data, 
                                 UIButtonCallback callback);
 
+// Add a row or a column to the canvas' layout under the 'parent' node (0 being the root), and return its node.
+const i32 ui_canvas_push_layout(UICanvas* canvas, const i32 parent, const UILayoutStyle& style);
+
+// Add a text as a node under the 'parent' node of the canvas' layout. 
+// The text takes up its own size, unless the style says otherwise.
+UIText& ui_canvas_push_layout_text(UICanvas* canvas, 
+                                   const std::string& text, 
+                                   const f32 font_size,
+                                   const glm::vec4& text_color, 
+                                   const i32 parent, 
+                                   const UILayoutStyle& style = UILayoutStyle());
+
+// Add a button as a node under the 'parent' node of the canvas' layout. 
+// The text is kept in the middle of the button.
+UIButton& ui_canvas_push_layout_button(UICanvas* canvas, 
+                                       const std::string& text, 
+                                       const f32 font_size,
+                                       const glm::vec4& button_color, 
+                                       const glm::vec4& text_color, 
+                                       void* user_data, 
+                                       UIButtonCallback callback,
+                                       const i32 parent, 
+                                       const UILayoutStyle& style = UILayoutStyle());
+
+// Add a scrolling list of 'items_count' items, where 'callback' fills the rows that come into view.
+UIList& ui_canvas_push_list(UICanvas* canvas, 
+                            const glm::vec2& position, 
+                            const glm::vec2& size, 
+                            const f32 row_height, 
+                            const f32 font_size, 
+                            const glm::vec4& text_color, 
+                            const u32 items_count, 
+                            UIListRowCallback callback, 
+                            void* user_data = nullptr);
+
 void ui_canvas_render(UICanvas* canvas);
 /////////////////////////////////////////////////////////////////////////////////
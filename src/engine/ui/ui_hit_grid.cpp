@@ -0,0 +1,89 @@
+#include "ui_hit_grid.h"
+#include "defines.h"
+#include "ui/ui_button.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static bool get_cells(const UIHitGrid* grid, const UIButton& button, glm::ivec2* out_min, glm::ivec2* out_max) {
+  glm::ivec2 min = glm::ivec2(glm::floor(button.position / UI_HIT_GRID_CELL_SIZE));
+  glm::ivec2 max = glm::ivec2(glm::floor((button.position + button.size) / UI_HIT_GRID_CELL_SIZE));
+
+  // Completely outside of the window
+  if(max.x < 0 || max.y < 0 || min.x >= grid->cells_count.x || min.y >= grid->cells_count.y) {
+    return false;
+  }
+
+  *out_min = glm::max(min, glm::ivec2(0));
+  *out_max = glm::min(max, grid->cells_count - 1);
+  return true;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void ui_hit_grid_build(UIHitGrid* grid, const std::vector<UIButton>& buttons, const glm::vec2& window_size) {
+  grid->cells_count = glm::max(glm::ivec2(glm::ceil(window_size / UI_HIT_GRID_CELL_SIZE)), glm::ivec2(1));
+
+  u32 cells_count = grid->cells_count.x * grid->cells_count.y;
+  grid->cell_starts.assign(cells_count + 1, 0);
+
+  // Count the buttons of every cell first, so all of them can go in one array
+  for(auto& button : buttons) {
+    glm::ivec2 min, max;
+    if(!button.is_active || !get_cells(grid, button, &min, &max)) {
+      continue;
+    }
+
+    for(i32 y = min.y; y <= max.y; y++) {
+      for(i32 x = min.x; x <= max.x; x++) {
+        grid->cell_starts[(y * grid->cells_count.x) + x + 1]++;
+      }
+    }
+  }
+
+  for(u32 i = 0; i < cells_count; i++) {
+    grid->cell_starts[i + 1] += grid->cell_starts[i];
+  }
+
+  // Fill in the cells, keeping the buttons in order
+  grid->indices.resize(grid->cell_starts[cells_count]);
+  std::vector<u32> offsets(grid->cell_starts.begin(), grid->cell_starts.end() - 1);
+
+  for(u32 i = 0; i < buttons.size(); i++) {
+    glm::ivec2 min, max;
+    if(!buttons[i].is_active || !get_cells(grid, buttons[i], &min, &max)) {
+      continue;
+    }
+
+    for(i32 y = min.y; y <= max.y; y++) {
+      for(i32 x = min.x; x <= max.x; x++) {
+        grid->indices[offsets[(y * grid->cells_count.x) + x]++] = i;
+      }
+    }
+  }
+}
+
+const i32 ui_hit_grid_query(const UIHitGrid* grid, const std::vector<UIButton>& buttons, const glm::vec2& point) {
+  glm::ivec2 cell = glm::ivec2(glm::floor(point / UI_HIT_GRID_CELL_SIZE));
+  if(cell.x < 0 || cell.y < 0 || cell.x >= grid->cells_count.x || cell.y >= grid->cells_count.y) {
+    return -1;
+  }
+
+  u32 index = (cell.y * grid->cells_count.x) + cell.x;
+  for(u32 i = grid->cell_starts[index + 1]; i > grid->cell_starts[index]; i--) {
+    const UIButton& button = buttons[grid->indices[i - 1]];
+
+    bool is_inside = ((point.x >= button.position.x) && (point.x <= (button.position.x + button.size.x))) && 
+                     ((point.y >= button.position.y) && (point.y <= (button.position.y + button.size.y)));
+    if(is_inside) {
+      return grid->indices[i - 1];
+    }
+  }
+
+  return -1;
+}
+/////////////////////////////////////////////////////////////////////////////////
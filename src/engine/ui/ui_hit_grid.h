@@ -0,0 +1,41 @@
+#pragma once
+
+#include "defines.h"
+#include "ui/ui_button.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define UI_HIT_GRID_CELL_SIZE 64.0f // In pixels. About the size of a small button.
+/////////////////////////////////////////////////////////////////////////////////
+
+// UIHitGrid
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A uniform grid over the window, where every cell lists the buttons that overlap it.
+ * Finding the button under the mouse only has to test the few buttons of one cell.
+ *
+ * NOTE: The grid does not follow the buttons around, so it has to be built again
+ * whenever any of them moves, resizes, or gets (de)activated.
+ */
+struct UIHitGrid {
+  glm::ivec2 cells_count;
+
+  // The buttons of cell 'i' are 'indices[cell_starts[i]]' up to 'indices[cell_starts[i + 1]]'
+  std::vector<u32> cell_starts;
+  std::vector<u32> indices;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Put every active button in the cells of the grid it overlaps. 
+void ui_hit_grid_build(UIHitGrid* grid, const std::vector<UIButton>& buttons, const glm::vec2& window_size);
+
+// Returns the index of the button under the point, or -1 if there is none. 
+// If the buttons overlap, the last one (which is drawn on top) wins.
+const i32 ui_hit_grid_query(const UIHitGrid* grid, const std::vector<UIButton>& buttons, const glm::vec2& point);
+/////////////////////////////////////////////////////////////////////////////////
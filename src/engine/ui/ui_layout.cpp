@@ -0,0 +1,244 @@
+#include "ui_layout.h"
+#include "defines.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static void mark_dirty(UILayout* layout, i32 index) {
+  // The parents of a dirty node are already dirty
+  while(index != -1 && !layout->nodes[index].needs_measure) {
+    layout->nodes[index].needs_measure = true;
+    index = layout->nodes[index].parent;
+  }
+}
+
+static f32 resolve_size(const UISize& size, const f32 parent_size, const f32 measured_size) {
+  switch(size.type) {
+    case UI_SIZE_PIXELS:
+      return size.value;
+    case UI_SIZE_PERCENT:
+      return parent_size * size.value;
+    default:
+      return measured_size;
+  }
+}
+
+static void measure_node(UILayout* layout, const i32 index) {
+  UILayoutNode& node = layout->nodes[index];
+  if(!node.needs_measure) {
+    return;
+  }
+  layout->visits_count++;
+
+  u32 main  = node.style.direction == UI_LAYOUT_ROW ? 0 : 1;
+  u32 cross = 1 - main;
+
+  // Only the children with a size of their own count. The ones that go with the parent's size would go in circles.
+  glm::vec2 children_size(0.0f);
+  u32 children_count = 0;
+
+  for(i32 child = node.first_child; child != -1; child = layout->nodes[child].next_sibling) {
+    measure_node(layout, child);
+
+    glm::vec2 size = layout->nodes[child].measured_size;
+    children_size[main] += size[main];
+    children_size[cross] = glm::max(children_size[cross], size[cross]);
+    children_count++;
+  }
+
+  if(children_count > 1) {
+    children_size[main] += node.style.gap * (children_count - 1);
+  }
+
+  glm::vec2 padding   = glm::vec2(node.style.padding.x + node.style.padding.z, node.style.padding.y + node.style.padding.w);
+  glm::vec2 auto_size = glm::max(node.content_size, children_size) + padding;
+
+  node.measured_size.x = resolve_size(node.style.width, 0.0f, auto_size.x);
+  node.measured_size.y = resolve_size(node.style.height, 0.0f, auto_size.y);
+
+  node.needs_measure = false;
+  node.needs_arrange = true;
+}
+
+static void place_node(UILayout* layout, const i32 index, const glm::vec2& position, const glm::vec2& size);
+
+static glm::vec2 get_child_size(const UILayoutNode& parent, const UILayoutNode& child, const glm::vec2& inner_size) {
+  glm::vec2 size;
+  size.x = resolve_size(child.style.width, inner_size.x, child.measured_size.x);
+  size.y = resolve_size(child.style.height, inner_size.y, child.measured_size.y);
+
+  // Fill the parent across its direction
+  u32 cross = parent.style.direction == UI_LAYOUT_ROW ? 1 : 0;
+  UISizeType cross_type = cross == 0 ? child.style.width.type : child.style.height.type;
+
+  if(parent.style.cross_align == UI_LAYOUT_ALIGN_STRETCH && cross_type == UI_SIZE_AUTO) {
+    size[cross] = inner_size[cross];
+  }
+
+  return size;
+}
+
+static void arrange_children(UILayout* layout, const i32 index) {
+  const UILayoutNode& node = layout->nodes[index];
+  layout->visits_count++;
+
+  u32 main  = node.style.direction == UI_LAYOUT_ROW ? 0 : 1;
+  u32 cross = 1 - main;
+
+  glm::vec2 inner_position = node.position + glm::vec2(node.style.padding.x, node.style.padding.y);
+  glm::vec2 inner_size     = node.size - glm::vec2(node.style.padding.x + node.style.padding.z, node.style.padding.y + node.style.padding.w);
+  inner_size               = glm::max(inner_size, glm::vec2(0.0f));
+
+  // How much room is left along the direction for the children that grow or the alignment
+  f32 used_size = 0.0f, grow_total = 0.0f;
+  u32 children_count = 0;
+
+  for(i32 child = node.first_child; child != -1; child = layout->nodes[child].next_sibling) {
+    used_size  += get_child_size(node, layout->nodes[child], inner_size)[main];
+    grow_total += layout->nodes[child].style.grow;
+    children_count++;
+  }
+
+  if(children_count > 1) {
+    used_size += node.style.gap * (children_count - 1);
+  }
+
+  f32 free_size = inner_size[main] - used_size;
+  f32 cursor    = inner_position[main];
+  bool is_growing = grow_total > 0.0f && free_size > 0.0f;
+
+  if(!is_growing && node.style.main_align == UI_LAYOUT_ALIGN_CENTER) {
+    cursor += free_size / 2.0f;
+  }
+  else if(!is_growing && node.style.main_align == UI_LAYOUT_ALIGN_END) {
+    cursor += free_size;
+  }
+
+  for(i32 child = node.first_child; child != -1; child = layout->nodes[child].next_sibling) {
+    const UILayoutNode& child_node = layout->nodes[child];
+    glm::vec2 size = get_child_size(node, child_node, inner_size);
+
+    if(is_growing) {
+      size[main] += free_size * (child_node.style.grow / grow_total);
+    }
+
+    glm::vec2 position;
+    position[main]  = cursor;
+    position[cross] = inner_position[cross];
+
+    if(node.style.cross_align == UI_LAYOUT_ALIGN_CENTER) {
+      position[cross] += (inner_size[cross] - size[cross]) / 2.0f;
+    }
+    else if(node.style.cross_align == UI_LAYOUT_ALIGN_END) {
+      position[cross] += inner_size[cross] - size[cross];
+    }
+
+    cursor += size[main] + node.style.gap;
+    place_node(layout, child, position, size);
+  }
+
+  layout->nodes[index].needs_arrange = false;
+}
+
+static void place_node(UILayout* layout, const i32 index, const glm::vec2& position, const glm::vec2& size) {
+  UILayoutNode& node = layout->nodes[index];
+
+  if(node.position != position || node.size != size) {
+    node.position      = position;
+    node.size          = size;
+    node.needs_arrange = true;
+
+    layout->changed_nodes.push_back(index);
+  }
+
+  // Nothing under a node that did not move or change can move either
+  if(node.needs_arrange) {
+    arrange_children(layout, index);
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void ui_layout_create(UILayout* layout, const glm::vec2& size) {
+  layout->nodes.clear();
+  layout->changed_nodes.clear();
+  layout->visits_count = 0;
+
+  UILayoutStyle style;
+  style.width  = UISize{UI_SIZE_PIXELS, size.x};
+  style.height = UISize{UI_SIZE_PIXELS, size.y};
+
+  ui_layout_push_node(layout, -1, style);
+}
+
+const i32 ui_layout_push_node(UILayout* layout, const i32 parent, const UILayoutStyle& style) {
+  UILayoutNode node  = {};
+  node.style         = style;
+  node.parent        = parent;
+  node.first_child   = -1;
+  node.last_child    = -1;
+  node.next_sibling  = -1;
+  node.user_index    = -1;
+  node.needs_arrange = true;
+
+  i32 index = (i32)layout->nodes.size();
+  layout->nodes.push_back(node);
+
+  if(parent != -1) {
+    UILayoutNode& parent_node = layout->nodes[parent];
+
+    if(parent_node.last_child == -1) {
+      parent_node.first_child = index;
+    }
+    else {
+      layout->nodes[parent_node.last_child].next_sibling = index;
+    }
+
+    parent_node.last_child = index;
+  }
+
+  mark_dirty(layout, index);
+  return index;
+}
+
+void ui_layout_set_size(UILayout* layout, const glm::vec2& size) {
+  UILayoutStyle style = layout->nodes[0].style;
+  style.width.value   = size.x;
+  style.height.value  = size.y;
+
+  ui_layout_set_style(layout, 0, style);
+}
+
+void ui_layout_set_style(UILayout* layout, const i32 node, const UILayoutStyle& style) {
+  layout->nodes[node].style = style;
+  mark_dirty(layout, node);
+}
+
+void ui_layout_set_content_size(UILayout* layout, const i32 node, const glm::vec2& size) {
+  if(layout->nodes[node].content_size == size) {
+    return;
+  }
+
+  layout->nodes[node].content_size = size;
+  mark_dirty(layout, node);
+}
+
+const bool ui_layout_solve(UILayout* layout) {
+  layout->changed_nodes.clear();
+  layout->visits_count = 0;
+
+  if(layout->nodes.empty()) {
+    return false;
+  }
+
+  // Sizes go up the tree first, and then the positions go down
+  measure_node(layout, 0);
+  place_node(layout, 0, glm::vec2(0.0f), layout->nodes[0].measured_size);
+
+  return !layout->changed_nodes.empty();
+}
+/////////////////////////////////////////////////////////////////////////////////
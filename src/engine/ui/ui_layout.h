@@ -0,0 +1,108 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// UILayoutDirection
+/////////////////////////////////////////////////////////////////////////////////
+enum UILayoutDirection {
+  UI_LAYOUT_ROW,    // Children go from left to right
+  UI_LAYOUT_COLUMN, // Children go from top to bottom
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UILayoutAlign
+/////////////////////////////////////////////////////////////////////////////////
+enum UILayoutAlign {
+  UI_LAYOUT_ALIGN_START, 
+  UI_LAYOUT_ALIGN_CENTER, 
+  UI_LAYOUT_ALIGN_END, 
+  UI_LAYOUT_ALIGN_STRETCH, // Only across the direction. Along it, this is the same as 'UI_LAYOUT_ALIGN_START'.
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UISizeType
+/////////////////////////////////////////////////////////////////////////////////
+enum UISizeType {
+  UI_SIZE_AUTO,    // Big enough for the content and the children
+  UI_SIZE_PIXELS,  
+  UI_SIZE_PERCENT, // Of the parent's size without its padding (from 0 to 1)
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UISize
+/////////////////////////////////////////////////////////////////////////////////
+struct UISize {
+  UISizeType type = UI_SIZE_AUTO;
+  f32 value       = 0.0f;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UILayoutStyle
+/////////////////////////////////////////////////////////////////////////////////
+struct UILayoutStyle {
+  UILayoutDirection direction = UI_LAYOUT_COLUMN;
+  UILayoutAlign main_align    = UI_LAYOUT_ALIGN_START; // Of the children along the direction
+  UILayoutAlign cross_align   = UI_LAYOUT_ALIGN_START; // Of the children across the direction
+
+  UISize width, height;
+  glm::vec4 padding = glm::vec4(0.0f); // Left, top, right, bottom
+  f32 gap           = 0.0f;            // Between every two children
+
+  f32 grow = 0.0f; // How much of the space the parent has left along its direction this node takes
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UILayoutNode
+/////////////////////////////////////////////////////////////////////////////////
+struct UILayoutNode {
+  UILayoutStyle style;
+  glm::vec2 content_size; // Of whatever is in the node (like a text) 
+
+  i32 parent, first_child, last_child, next_sibling; // -1 if none
+  i32 user_index;                                    // Free for the owner of the layout (-1 by default)
+
+  glm::vec2 measured_size; // The size the node wants, before the parent had any say in it
+  glm::vec2 position, size;
+
+  bool needs_measure; // The content, the style, or any of the children changed
+  bool needs_arrange; // The children have to be placed again
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// UILayout
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A tree of rows and columns, somewhat like the flexbox of CSS. The node at 0 is the 
+ * root, which always takes up the whole of the given size.
+ *
+ * Solving is incremental. Changing a node only measures it and its parents again, and only the 
+ * nodes that end up with a different position or size are placed again. So a resize or a 
+ * changed text costs as much as the part of the tree it actually moves.
+ */
+struct UILayout {
+  std::vector<UILayoutNode> nodes;
+
+  std::vector<i32> changed_nodes; // The nodes that moved or resized in the last solve
+  u32 visits_count;               // How many nodes the last solve had to look at
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void ui_layout_create(UILayout* layout, const glm::vec2& size);
+
+// Add a node under the 'parent' node and return its index.
+const i32 ui_layout_push_node(UILayout* layout, const i32 parent, const UILayoutStyle& style);
+
+void ui_layout_set_size(UILayout* layout, const glm::vec2& size);
+void ui_layout_set_style(UILayout* layout, const i32 node, const UILayoutStyle& style);
+void ui_layout_set_content_size(UILayout* layout, const i32 node, const glm::vec2& size);
+
+// Lay out everything that changed since the last solve. 
+// Returns 'true' if any node moved or resized (see 'changed_nodes').
+const bool ui_layout_solve(UILayout* layout);
+/////////////////////////////////////////////////////////////////////////////////
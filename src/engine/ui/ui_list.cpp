@@ -0,0 +1,134 @@
+#include "ui_list.h"
+#include "defines.h"
+#include "ui/ui_text.h"
+#include "ui/ui_anchor.h"
+#include "resources/font.h"
+#include "graphics/renderer2d.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static f32 get_max_scroll(const UIList* list) {
+  return glm::max((list->items_count * list->row_height) - list->size.y, 0.0f);
+}
+
+static void get_visible_items(const UIList* list, u32* out_first, u32* out_last) {
+  i32 first = (i32)glm::floor(list->scroll / list->row_height) - (i32)list->overscan;
+  i32 last  = (i32)glm::ceil((list->scroll + list->size.y) / list->row_height) + (i32)list->overscan;
+
+  *out_first = (u32)glm::max(first, 0);
+  *out_last  = (u32)glm::clamp(last, 0, (i32)list->items_count);
+}
+
+static void fill_row(UIList* list, const u32 item) {
+  u32 slot = item % list->rows.size();
+  if(list->row_items[slot] == (i32)item) {
+    return;
+  }
+
+  list->row_items[slot] = item;
+  if(list->row_callback) {
+    list->row_callback(&list->rows[slot], item, list->user_data);
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void ui_list_create(UIList* list, 
+                    Font* font, 
+                    const glm::vec2& position, 
+                    const glm::vec2& size, 
+                    const f32 row_height, 
+                    const f32 font_size, 
+                    const glm::vec4& text_color, 
+                    const u32 items_count, 
+                    UIListRowCallback callback, 
+                    void* user_data) {
+  list->position    = position;
+  list->size        = size;
+  list->row_height  = glm::max(row_height, 1.0f);
+  list->items_count = items_count;
+  list->overscan    = UI_LIST_DEFAULT_OVERSCAN;
+  list->scroll      = 0.0f;
+
+  list->row_callback = callback;
+  list->user_data    = user_data;
+  list->is_active    = true;
+
+  // Enough rows for the most that can ever be in view at once (when the first one is only partly in view)
+  u32 rows_count = (u32)glm::ceil(size.y / list->row_height) + 1 + (list->overscan * 2);
+
+  list->rows.resize(rows_count);
+  list->row_items.assign(rows_count, -1);
+
+  for(auto& row : list->rows) {
+    ui_text_create(&row, font, "", font_size, UI_ANCHOR_TOP_LEFT, text_color);
+  }
+}
+
+void ui_list_set_items_count(UIList* list, const u32 items_count) {
+  list->items_count = items_count;
+  list->scroll      = glm::min(list->scroll, get_max_scroll(list));
+
+  list->row_items.assign(list->rows.size(), -1);
+}
+
+void ui_list_refresh_item(UIList* list, const u32 item) {
+  u32 slot = item % list->rows.size();
+  if(list->row_items[slot] == (i32)item) {
+    list->row_items[slot] = -1;
+  }
+}
+
+void ui_list_scroll(UIList* list, const f32 offset) {
+  list->scroll = glm::clamp(list->scroll + offset, 0.0f, get_max_scroll(list));
+}
+
+void ui_list_scroll_to(UIList* list, const u32 item) {
+  list->scroll = glm::clamp(item * list->row_height, 0.0f, get_max_scroll(list));
+}
+
+const i32 ui_list_get_item_at(UIList* list, const glm::vec2& point) {
+  glm::vec2 local = point - list->position;
+  if(local.x < 0.0f || local.y < 0.0f || local.x > list->size.x || local.y > list->size.y) {
+    return -1;
+  }
+
+  u32 item = (u32)((local.y + list->scroll) / list->row_height);
+  return item < list->items_count ? (i32)item : -1;
+}
+
+void ui_list_render(UIList* list) {
+  if(!list->is_active || list->rows.empty()) {
+    return;
+  }
+
+  u32 first, last;
+  get_visible_items(list, &first, &last);
+
+  // The rows of the overscan get filled (and laid out) too, so they are ready before they scroll into view
+  for(u32 item = first; item < last; item++) {
+    fill_row(list, item);
+  }
+
+  renderer2d_set_clip(list->position, list->size);
+
+  for(u32 item = first; item < last; item++) {
+    f32 y = list->position.y + (item * list->row_height) - list->scroll;
+    if((y + list->row_height) < list->position.y || y > (list->position.y + list->size.y)) {
+      continue;
+    }
+
+    UIText& row  = list->rows[item % list->rows.size()];
+    row.position = glm::vec2(list->position.x, y);
+
+    ui_text_render(&row);
+  }
+
+  renderer2d_reset_clip();
+}
+/////////////////////////////////////////////////////////////////////////////////
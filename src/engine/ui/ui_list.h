@@ -0,0 +1,77 @@
+#pragma once
+
+#include "defines.h"
+#include "ui/ui_text.h"
+#include "resources/font.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define UI_LIST_DEFAULT_OVERSCAN 2 // Rows kept ready above and below the visible ones, so scrolling does not fill them all at once
+/////////////////////////////////////////////////////////////////////////////////
+
+// Callbacks
+/////////////////////////////////////////////////////////////////////////////////
+// A callback that fills the given row with the item at 'item' (using 'ui_text_set_string' and the like). 
+// It is called whenever a row is given a different item, and never for the items that are not in view.
+typedef void(*UIListRowCallback)(UIText* row, const u32 item, void* user_data);
+/////////////////////////////////////////////////////////////////////////////////
+
+// UIList
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A scrolling list that only keeps the rows in view (and a few around them) no matter how 
+ * many items it has. The rows are recycled as the list scrolls, with every item going 
+ * into the row at 'item % rows.size()'.
+ */
+struct UIList {
+  glm::vec2 position, size; // Of the part in view, in window coordinates
+  f32 row_height;
+
+  u32 items_count;
+  u32 overscan;
+  f32 scroll; // How far down the list is, in pixels
+
+  std::vector<UIText> rows;
+  std::vector<i32> row_items; // The item in each row, or -1 if it needs to be filled
+
+  UIListRowCallback row_callback;
+  void* user_data;
+
+  bool is_active;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Create a list of 'items_count' items, where the rows use the 'font' (or the default font if 'nullptr').
+// The 'callback' is what turns an item into the string of a row.
+void ui_list_create(UIList* list, 
+                    Font* font, 
+                    const glm::vec2& position, 
+                    const glm::vec2& size, 
+                    const f32 row_height, 
+                    const f32 font_size, 
+                    const glm::vec4& text_color, 
+                    const u32 items_count, 
+                    UIListRowCallback callback, 
+                    void* user_data = nullptr);
+
+// Change the number of items. Every row gets filled again.
+void ui_list_set_items_count(UIList* list, const u32 items_count);
+
+// Fill the row of the item again if it is in view. Call this whenever an item changes.
+void ui_list_refresh_item(UIList* list, const u32 item);
+
+// Scroll by 'offset' pixels (down if positive). The list never scrolls past either end.
+void ui_list_scroll(UIList* list, const f32 offset);
+void ui_list_scroll_to(UIList* list, const u32 item);
+
+// Returns the item under the point, or -1 if there is none.
+const i32 ui_list_get_item_at(UIList* list, const glm::vec2& point);
+
+void ui_list_render(UIList* list);
+/////////////////////////////////////////////////////////////////////////////////
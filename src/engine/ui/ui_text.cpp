@@ -2,7 +2,7 @@
 #include "defines.h"
 #include "resources/font.h"
 #include "ui/ui_anchor.h"
-#include "core/window.h"
+#include "core/render_thread.h"
 #include "graphics/renderer2d.h"
 
 #include <glm/glm.hpp>
@@ -12,37 +12,13 @@
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
 glm::vec2 ui_text_measure_size(UIText* text) {
-  glm::vec2 result(0.0f);
-  f32 scale = text->font_size / text->font->base_size;
-  result.y = text->font->base_size;
-
-  for(u32 i = 0; i < text->str.size(); i++) {
-    usizei index = font_get_glyph_index(text->font, text->str[i]);
-    Glyph glyph = text->font->glyphs[index];
-
-    // Measure the height 
-    if(glyph.unicode == '\n') {
-      result.y += text->font->line_gap; 
-      // @TODO: This will not suffice. You'll need to reset the width of the 
-      // text as well since the next line could have more characters.
-      continue;
-    } 
-
-    // Measure the width 
-    if(glyph.advance_x != 0) {
-      result.x += glyph.advance_x;
-    } 
-    else {
-      result.x += glyph.width + glyph.x_offset;
-    }
-  } 
-
-  return result * scale;
+  text_layout_update(&text->layout, text->font, text->font_size, text->str);
+  return text->layout.size;
 }
 
 void ui_text_set_position(UIText* text, UIAnchor anc) {
   glm::vec2 text_size = ui_text_measure_size(text);
-  glm::vec2 window_size = window_get_size();
+  glm::vec2 window_size = render_thread_get_viewport_size();
   glm::vec2 window_center = window_size / 2.0f;
   glm::vec2 padding = glm::vec2(10.0f, 10.0f);
 
@@ -95,6 +71,8 @@ void ui_text_create(UIText* text, Font* font, const std::string& str, f32 font_s
   text->str = str; 
   
   text->is_active = true;
+  text->is_dirty = true;
+  text->layout_node = -1;
 
   text->font = font == nullptr ? renderer2d_get_default_font() : font;
 
@@ -103,7 +81,12 @@ void ui_text_create(UIText* text, Font* font, const std::string& str, f32 font_s
 
 void ui_text_set_string(UIText* text, const std::string& new_str) {
   text->str = new_str;
-  ui_text_set_position(text, text->anchor);
+  text->is_dirty = true;
+
+  // The layout will find a new place for the text by itself
+  if(text->layout_node == -1) {
+    ui_text_set_position(text, text->anchor);
+  }
 }
 
 void ui_text_render(UIText* text) {
@@ -111,6 +94,7 @@ void ui_text_render(UIText* text) {
     return;
   }
 
-  render_text(text->font, text->font_size, text->str, text->position, text->color);
+  text_layout_update(&text->layout, text->font, text->font_size, text->str);
+  render_text(&text->layout, text->position, text->color);
 }
 /////////////////////////////////////////////////////////////////////////////////
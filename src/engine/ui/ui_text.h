@@ -3,6 +3,7 @@
 #include "defines.h"
 #include "ui/ui_anchor.h"
 #include "resources/font.h"
+#include "graphics/renderer2d.h"
 
 #include <glm/glm.hpp>
 
@@ -20,16 +21,18 @@ struct UIText {
   std::string str;
 
   bool is_active;
+  bool is_dirty; // Set whenever the string changes, so a canvas knows to make the text again
+  i32 layout_node; // In the layout of the canvas, or -1 if the text is placed by its anchor
 
   Font* font;
+  TextLayout layout; // Only laid out again when the string, font, or font size change
 };
 /////////////////////////////////////////////////////////////////////////////////
 
 // Public functions
 /////////////////////////////////////////////////////////////////////////////////
-// Measure the width and height of each character of the string and return 
-// the accumlation of that. The height might be the same for each character 
-// depending on the font.
+// Measure the width and height of each character of the UTF-8 string and return 
+// the accumlation of that. The width is the one of the longest line.
 glm::vec2 ui_text_measure_size(UIText* text);
 
 // Set the position of the text based on the given anchor. 
@@ -0,0 +1,145 @@
+#include "atlas_packer.h"
+#include "defines.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+// Returns the height the rectangle would sit at if placed at the start of the node, or -1 if it does not fit there
+static i32 fit_at(const AtlasPacker* packer, const u32 index, const i32 width, const i32 height) {
+  i32 x = packer->skyline[index].x;
+  if((x + width) > packer->width) {
+    return -1;
+  }
+
+  // The rectangle rests on the highest node it spans
+  i32 y          = 0;
+  i32 width_left = width;
+
+  for(u32 i = index; width_left > 0; i++) {
+    y = glm::max(y, packer->skyline[i].y);
+    if((y + height) > packer->height) {
+      return -1;
+    }
+
+    width_left -= packer->skyline[i].width;
+  }
+
+  return y;
+}
+
+static void add_level(AtlasPacker* packer, const u32 index, const glm::ivec2& position, const i32 width, const i32 height) {
+  packer->skyline.insert(packer->skyline.begin() + index, AtlasSkylineNode{position.x, position.y + height, width});
+
+  // Cut away the parts of the nodes that are now under the new one
+  for(u32 i = index + 1; i < packer->skyline.size();) {
+    AtlasSkylineNode& prev = packer->skyline[i - 1];
+    AtlasSkylineNode& node = packer->skyline[i];
+
+    i32 overlap = (prev.x + prev.width) - node.x;
+    if(overlap <= 0) {
+      break;
+    }
+
+    node.x     += overlap;
+    node.width -= overlap;
+
+    if(node.width > 0) {
+      break;
+    }
+
+    packer->skyline.erase(packer->skyline.begin() + i);
+  }
+
+  // Merge the neighbours at the same height
+  for(u32 i = 0; i < (packer->skyline.size() - 1);) {
+    if(packer->skyline[i].y == packer->skyline[i + 1].y) {
+      packer->skyline[i].width += packer->skyline[i + 1].width;
+      packer->skyline.erase(packer->skyline.begin() + i + 1);
+
+      continue;
+    }
+
+    i++;
+  }
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void atlas_packer_create(AtlasPacker* packer, const i32 width, const i32 height) {
+  packer->width  = width;
+  packer->height = height;
+
+  atlas_packer_reset(packer);
+}
+
+const bool atlas_packer_pack(AtlasPacker* packer, const i32 width, const i32 height, glm::ivec2* out_position) {
+  if(width <= 0 || height <= 0) {
+    *out_position = glm::ivec2(0);
+    return true;
+  }
+
+  // Bottom-left: take the spot where the top of the rectangle ends up the lowest, 
+  // going for the narrowest node when there is a tie
+  i32 best_index  = -1;
+  i32 best_top    = INT32_MAX;
+  i32 best_width  = INT32_MAX;
+  glm::ivec2 best_position(0);
+
+  for(u32 i = 0; i < packer->skyline.size(); i++) {
+    i32 y = fit_at(packer, i, width, height);
+    if(y < 0) {
+      continue;
+    }
+
+    i32 top = y + height;
+    if(top < best_top || (top == best_top && packer->skyline[i].width < best_width)) {
+      best_index    = i;
+      best_top      = top;
+      best_width    = packer->skyline[i].width;
+      best_position = glm::ivec2(packer->skyline[i].x, y);
+    }
+  }
+
+  if(best_index == -1) {
+    return false;
+  }
+
+  add_level(packer, best_index, best_position, width, height);
+  packer->used_area += (u64)width * height;
+
+  *out_position = best_position;
+  return true;
+}
+
+void atlas_packer_reset(AtlasPacker* packer) {
+  packer->skyline.clear();
+  packer->skyline.push_back(AtlasSkylineNode{0, 0, packer->width});
+
+  packer->used_area = 0;
+}
+
+void atlas_packer_grow(AtlasPacker* packer, const i32 width, const i32 height) {
+  // The new space on the right starts out empty
+  if(width > packer->width) {
+    AtlasSkylineNode& last = packer->skyline.back();
+    if(last.y == 0) {
+      last.width += width - packer->width;
+    }
+    else {
+      packer->skyline.push_back(AtlasSkylineNode{packer->width, 0, width - packer->width});
+    }
+
+    packer->width = width;
+  }
+
+  packer->height = glm::max(packer->height, height);
+}
+
+const f32 atlas_packer_get_occupancy(const AtlasPacker* packer) {
+  return (f32)((f64)packer->used_area / ((f64)packer->width * packer->height));
+}
+/////////////////////////////////////////////////////////////////////////////////
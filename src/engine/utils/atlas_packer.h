@@ -0,0 +1,51 @@
+#pragma once
+
+#include "defines.h"
+
+#include <glm/vec2.hpp>
+
+#include <vector>
+
+// AtlasSkylineNode
+/////////////////////////////////////////////////////////////////////////////////
+// A horizontal segment of the skyline. Everything below 'y' is taken.
+struct AtlasSkylineNode {
+  i32 x, y, width;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// AtlasPacker
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * Packs rectangles into a fixed area using a skyline (bottom-left) packer. Only the top
+ * edge of everything packed so far is kept around, which makes it cheap enough to pack
+ * at runtime. Like the 'FreeList', it does not own any memory. It only hands out positions.
+ *
+ * NOTE: Packed rectangles cannot be given back one by one. The whole packer has to be reset.
+ */
+struct AtlasPacker {
+  std::vector<AtlasSkylineNode> skyline; // Always sorted by 'x' and covering the whole width
+  i32 width, height;
+
+  u64 used_area;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void atlas_packer_create(AtlasPacker* packer, const i32 width, const i32 height);
+
+// Find room for a 'width' by 'height' rectangle and write its bottom-left corner to 'out_position'.
+// Returns 'false' if the rectangle does not fit anymore.
+const bool atlas_packer_pack(AtlasPacker* packer, const i32 width, const i32 height, glm::ivec2* out_position);
+
+// Forget everything that was packed
+void atlas_packer_reset(AtlasPacker* packer);
+
+// Make the area bigger, keeping everything that was packed where it is.
+// NOTE: The area cannot shrink.
+void atlas_packer_grow(AtlasPacker* packer, const i32 width, const i32 height);
+
+// How much of the area is taken, within [0, 1]
+const f32 atlas_packer_get_occupancy(const AtlasPacker* packer);
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,90 @@
+#include "free_list.h"
+#include "defines.h"
+
+#include <vector>
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void free_list_create(FreeList* list, const u32 capacity) {
+  list->ranges.clear();
+  list->ranges.push_back(FreeListRange{0, capacity});
+
+  list->capacity = capacity;
+  list->used     = 0;
+}
+
+const bool free_list_alloc(FreeList* list, const u32 size, u32* out_offset) {
+  if(size == 0) {
+    *out_offset = 0;
+    return true;
+  }
+
+  for(u32 i = 0; i < list->ranges.size(); i++) {
+    FreeListRange& range = list->ranges[i];
+    if(range.size < size) {
+      continue;
+    }
+
+    *out_offset = range.offset;
+    list->used += size;
+
+    // Take the space from the front of the range and remove it once it's used up
+    range.offset += size;
+    range.size   -= size;
+    if(range.size == 0) {
+      list->ranges.erase(list->ranges.begin() + i);
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+void free_list_free(FreeList* list, const u32 offset, const u32 size) {
+  if(size == 0) {
+    return;
+  }
+
+  list->used -= size;
+
+  // Find where the range should be inserted to keep the list sorted
+  u32 index = 0;
+  while(index < list->ranges.size() && list->ranges[index].offset < offset) {
+    index++;
+  }
+  list->ranges.insert(list->ranges.begin() + index, FreeListRange{offset, size});
+
+  // Merge with the next range
+  if(index + 1 < list->ranges.size()) {
+    FreeListRange& next = list->ranges[index + 1];
+    if(offset + size == next.offset) {
+      list->ranges[index].size += next.size;
+      list->ranges.erase(list->ranges.begin() + index + 1);
+    }
+  }
+
+  // Merge with the previous range
+  if(index > 0) {
+    FreeListRange& prev = list->ranges[index - 1];
+    if(prev.offset + prev.size == offset) {
+      prev.size += list->ranges[index].size;
+      list->ranges.erase(list->ranges.begin() + index);
+    }
+  }
+}
+
+void free_list_grow(FreeList* list, const u32 new_capacity) {
+  if(new_capacity <= list->capacity) {
+    return;
+  }
+
+  u32 old_capacity = list->capacity;
+  list->capacity   = new_capacity;
+
+  // The new space is a free range at the end. Using 'free_list_free' here
+  // merges it with the last range if that one also reaches the end.
+  list->used += new_capacity - old_capacity;
+  free_list_free(list, old_capacity, new_capacity - old_capacity);
+}
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "defines.h"
+
+#include <vector>
+
+// FreeListRange
+/////////////////////////////////////////////////////////////////////////////////
+struct FreeListRange {
+  u32 offset, size;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// FreeList
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A generic sub-allocator that hands out ranges inside of something that has
+ * a fixed capacity (a GPU buffer, for example). It does not own any memory
+ * itself. It only keeps track of which ranges are free. The units of the offsets
+ * and sizes are up to the user (bytes, vertices, indices, etc...).
+ */
+struct FreeList {
+  std::vector<FreeListRange> ranges; // Always sorted by offset
+  u32 capacity, used;
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void free_list_create(FreeList* list, const u32 capacity);
+
+// Find the first free range that can fit 'size' and write its offset to 'out_offset'.
+// Returns 'false' if there is no free range big enough.
+const bool free_list_alloc(FreeList* list, const u32 size, u32* out_offset);
+
+// Give the range back to the list. The range will be merged with any neighbouring free ranges.
+void free_list_free(FreeList* list, const u32 offset, const u32 size);
+
+// Grow the capacity of the list. The new space at the end will be free.
+// NOTE: Does nothing if 'new_capacity' is smaller than the current capacity.
+void free_list_grow(FreeList* list, const u32 new_capacity);
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+#include "linear_allocator.h"
+#include "defines.h"
+
+#include <algorithm>
+#include <vector>
+
+// Private functions
+/////////////////////////////////////////////////////////////////////////////////
+static usizei align_up(const usizei value, const usizei alignment) {
+  return (value + (alignment - 1)) & ~(alignment - 1);
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void linear_allocator_create(LinearAllocator* allocator, const usizei block_size) {
+  allocator->blocks.clear();
+  allocator->block_size  = block_size;
+  allocator->block_index = 0;
+  allocator->offset      = 0;
+  allocator->used        = 0;
+
+  allocator->blocks.push_back(new u8[block_size]);
+}
+
+void linear_allocator_destroy(LinearAllocator* allocator) {
+  for(auto& block : allocator->blocks) {
+    delete[] block;
+  }
+
+  allocator->blocks.clear();
+  allocator->block_index = 0;
+  allocator->offset      = 0;
+  allocator->used        = 0;
+}
+
+void* linear_allocator_alloc(LinearAllocator* allocator, const usizei size, const usizei alignment) {
+  allocator->used += size + alignment;
+
+  // Oversized allocations get their own block, right behind the current one so it can still be used
+  if((size + alignment) > allocator->block_size) {
+    u8* block = new u8[size + alignment];
+    allocator->blocks.insert(allocator->blocks.begin() + allocator->block_index, block);
+    allocator->block_index++;
+
+    return (void*)align_up((usizei)block, alignment);
+  }
+
+  usizei address = align_up((usizei)allocator->blocks[allocator->block_index] + allocator->offset, alignment);
+  usizei end     = (usizei)allocator->blocks[allocator->block_index] + allocator->block_size;
+
+  // Move on to the next block (or a fresh one) if this one is full
+  if((address + size) > end) {
+    allocator->block_index++;
+    allocator->offset = 0;
+
+    if(allocator->block_index == allocator->blocks.size()) {
+      allocator->blocks.push_back(new u8[allocator->block_size]);
+    }
+
+    address = align_up((usizei)allocator->blocks[allocator->block_index], alignment);
+  }
+
+  allocator->offset = (address + size) - (usizei)allocator->blocks[allocator->block_index];
+  return (void*)address;
+}
+
+void linear_allocator_reset(LinearAllocator* allocator) {
+  // Everything did not fit in one block, so grow it to the high-water mark. 
+  // Otherwise, the oversized blocks would pile up with every reset.
+  if(allocator->blocks.size() > 1) {
+    for(auto& block : allocator->blocks) {
+      delete[] block;
+    }
+
+    allocator->block_size = std::max(allocator->block_size, allocator->used);
+    allocator->blocks.clear();
+    allocator->blocks.push_back(new u8[allocator->block_size]);
+  }
+
+  allocator->block_index = 0;
+  allocator->offset      = 0;
+  allocator->used        = 0;
+}
+/////////////////////////////////////////////////////////////////////////////////
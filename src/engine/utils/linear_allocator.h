@@ -0,0 +1,42 @@
+#pragma once
+
+#include "defines.h"
+
+#include <vector>
+
+// LinearAllocator
+/////////////////////////////////////////////////////////////////////////////////
+/*
+ * A bump allocator that hands out memory from big blocks and frees everything 
+ * at once on reset. Great for memory that only lives for one frame. 
+ *
+ * Running out of room in a block moves on to the next one (allocating a new one if 
+ * needed), so any pointers handed out stay valid until the next reset. If that happened, 
+ * the reset swaps all the blocks for a single one that fits everything that was allocated, 
+ * so a warmed up allocator never touches the heap again.
+ *
+ * NOTE: An allocator is not thread-safe. Every thread needs its own.
+ */
+struct LinearAllocator {
+  std::vector<u8*> blocks;
+  usizei block_size;
+
+  u32 block_index; // The block that is being allocated from
+  usizei offset;   // Into the current block
+
+  usizei used; // Since the last reset, counting the worst case alignment of every allocation
+};
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+void linear_allocator_create(LinearAllocator* allocator, const usizei block_size);
+void linear_allocator_destroy(LinearAllocator* allocator);
+
+// Returns 'size' bytes aligned to 'alignment' (which has to be a power of 2).
+// NOTE: Anything bigger than the block size gets a block of its own.
+void* linear_allocator_alloc(LinearAllocator* allocator, const usizei size, const usizei alignment = 16);
+
+// Free everything that was allocated, but keep the memory around for later.
+void linear_allocator_reset(LinearAllocator* allocator);
+/////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,63 @@
+#include "utils_utf8.h"
+#include "defines.h"
+
+#include <string>
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+const i32 utf8_decode(const std::string& str, usizei* offset) {
+  u8 lead = (u8)str[*offset];
+  
+  // ASCII, which is most of the text
+  if(lead < 0x80) {
+    *offset += 1;
+    return lead;
+  }
+
+  // The lead byte says how many continuation bytes follow
+  i32 codepoint, length, min_codepoint;
+  if((lead & 0xE0) == 0xC0) {
+    codepoint     = lead & 0x1F;
+    length        = 2;
+    min_codepoint = 0x80;
+  }
+  else if((lead & 0xF0) == 0xE0) {
+    codepoint     = lead & 0x0F;
+    length        = 3;
+    min_codepoint = 0x800;
+  }
+  else if((lead & 0xF8) == 0xF0) {
+    codepoint     = lead & 0x07;
+    length        = 4;
+    min_codepoint = 0x10000;
+  }
+  else {
+    *offset += 1;
+    return UTF8_REPLACEMENT_CHAR;
+  }
+
+  if(*offset + length > str.size()) {
+    *offset += 1;
+    return UTF8_REPLACEMENT_CHAR;
+  }
+
+  for(i32 i = 1; i < length; i++) {
+    u8 next = (u8)str[*offset + i];
+    if((next & 0xC0) != 0x80) {
+      *offset += 1;
+      return UTF8_REPLACEMENT_CHAR;
+    }
+
+    codepoint = (codepoint << 6) | (next & 0x3F);
+  }
+
+  // Overlong encodings, surrogates, and anything past the last codepoint are not valid
+  if(codepoint < min_codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+    *offset += 1;
+    return UTF8_REPLACEMENT_CHAR;
+  }
+
+  *offset += length;
+  return codepoint;
+}
+/////////////////////////////////////////////////////////////////////////////////
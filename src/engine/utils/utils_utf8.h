@@ -0,0 +1,19 @@
+#pragma once
+
+#include "defines.h"
+
+#include <string>
+
+// DEFS
+/////////////////////////////////////////////////////////////////////////////////
+#define UTF8_REPLACEMENT_CHAR 0xFFFD // What invalid bytes decode to
+/////////////////////////////////////////////////////////////////////////////////
+
+// Public functions
+/////////////////////////////////////////////////////////////////////////////////
+// Decode the codepoint that starts at 'offset' in the UTF-8 string, and move 'offset' past it.
+// NOTE: Invalid or cut off sequences decode to 'UTF8_REPLACEMENT_CHAR' and only take up a single byte, 
+// so the rest of the string still decodes fine.
+// NOTE: 'offset' must be within the string.
+const i32 utf8_decode(const std::string& str, usizei* offset);
+/////////////////////////////////////////////////////////////////////////////////